@@ -21,6 +21,11 @@
 #ifdef __VXWORKS__
 #include "../src/vxworks/bench_porting_layer_vxworks.h"
 #endif
+#ifdef POSIX
+#include "../src/posix/bench_porting_layer_posix.h"
+#endif /* POSIX */
+
+#include <stdbool.h>
 
 typedef void (*bench_isr_handler_t)(void *arg);
 
@@ -42,6 +47,16 @@ void bench_test_init(void (*test_init_function)(void *));
  */
 void bench_thread_set_priority(int priority);
 
+/*
+ * Most threads used by the tests (thread IDs 0 to BENCH_THREAD_MAX_NUM - 1).
+ * Ports that allocate threads statically must provide this many. Hosted
+ * ports raise the default in their header.
+ */
+
+#ifndef BENCH_THREAD_MAX_NUM
+#define BENCH_THREAD_MAX_NUM  20
+#endif
+
 /**
  * @brief Create a thread and set its name
  *
@@ -124,6 +139,49 @@ void bench_thread_exit(void);
  */
 void bench_yield(void);
 
+/**
+ * @brief Get the number of CPUs
+ *
+ * This routine returns the number of CPUs that benchmark threads can be
+ * pinned to with \ref bench_thread_cpu_set.
+ *
+ * @return Number of CPUs (1 on uniprocessor systems)
+ */
+int bench_cpu_count(void);
+
+/**
+ * @brief Pin a thread to a CPU
+ *
+ * This routine selects the CPU on which the thread runs. It must be called
+ * before the thread is created, and applies only to the next
+ * \ref bench_thread_create or \ref bench_thread_spawn of @a thread_id.
+ * Threads that are not pinned run wherever the RTOS schedules them.
+ *
+ * @param thread_id Handle of thread
+ * @param cpu       CPU index, from 0 to bench_cpu_count() - 1
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_thread_cpu_set(int thread_id, int cpu);
+
+/* Threads of bench_thread_runtime_get() that have no thread ID */
+
+#define BENCH_THREAD_SELF  (-1)  /* The calling thread */
+#define BENCH_THREAD_IDLE  (-2)  /* The idle thread(s) */
+
+/**
+ * @brief Get the time that a thread has run
+ *
+ * The run time of a thread ID adds up that of all the threads created with
+ * it, including those that have exited. Interrupts may be charged to the
+ * thread that they interrupted.
+ *
+ * @param thread_id ID of thread, BENCH_THREAD_SELF or BENCH_THREAD_IDLE
+ * @param ns        Where to store the run time in nanoseconds
+ * @return BENCH_SUCCESS on success, or BENCH_ERROR if the thread was never
+ *         created or the port does not account its run time
+ */
+int bench_thread_runtime_get(int thread_id, uint64_t *ns);
+
 /**
  * @brief Initialize timing
  *
@@ -138,6 +196,17 @@ void bench_timing_init(void);
  */
 void bench_sync_ticks(void);
 
+/**
+ * @brief Get the number of system ticks
+ *
+ * The count advances each time the system tick is processed. It is used to
+ * detect samples that were interrupted by the tick. It may be called from
+ * an interrupt handler.
+ *
+ * @return Number of ticks since an arbitrary point in the past
+ */
+uint64_t bench_tick_count_get(void);
+
 /**
  * @brief Start timing
  *
@@ -249,6 +318,125 @@ int bench_mutex_lock(int mutex_id);
  */
 int bench_mutex_unlock(int mutex_id);
 
+/**
+ * @brief Create a condition variable
+ *
+ * @param condvar_id ID of condition variable (to be used with other routines)
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_create(int condvar_id);
+
+/**
+ * @brief Wait on a condition variable
+ *
+ * This routine unlocks the mutex and waits forever until the condition
+ * variable is signaled, then locks the mutex again. The caller must have
+ * locked the mutex exactly once.
+ *
+ * @param condvar_id ID of condition variable
+ * @param mutex_id   ID of mutex protecting the condition
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_wait(int condvar_id, int mutex_id);
+
+/**
+ * @brief Wake one thread waiting on a condition variable
+ *
+ * The caller must hold the mutex that the waiters passed to
+ * bench_condvar_wait().
+ *
+ * @param condvar_id ID of condition variable
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_signal(int condvar_id);
+
+/**
+ * @brief Wake all threads waiting on a condition variable
+ *
+ * The caller must hold the mutex that the waiters passed to
+ * bench_condvar_wait().
+ *
+ * @param condvar_id ID of condition variable
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_broadcast(int condvar_id);
+
+/**
+ * @brief Delete a condition variable
+ *
+ * No thread may be waiting on the condition variable.
+ *
+ * @param condvar_id ID of condition variable
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_condvar_delete(int condvar_id);
+
+/**
+ * @brief Create an event object
+ *
+ * This routine creates an event object with all its flags clear. Only the
+ * low 24 bits of the flags are used, as not all RTOSes support more.
+ *
+ * @param event_id ID of event object (to be used with other routines)
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_event_create(int event_id);
+
+/**
+ * @brief Post events
+ *
+ * This routine sets @a flags in the event object and wakes every thread
+ * whose wait is satisfied. The flags stay set until they are cleared.
+ *
+ * @param event_id ID of event object
+ * @param flags    Flags to set
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_event_post(int event_id, uint32_t flags);
+
+/**
+ * @brief Wait for any of a set of events
+ *
+ * This routine waits forever until at least one of @a flags is set. It
+ * does not clear the flags.
+ *
+ * @param event_id ID of event object
+ * @param flags    Flags to wait for
+ * @return The flags of @a flags that were set, or 0 on failure
+ */
+uint32_t bench_event_wait_any(int event_id, uint32_t flags);
+
+/**
+ * @brief Wait for all of a set of events
+ *
+ * This routine waits forever until all of @a flags are set. It does not
+ * clear the flags.
+ *
+ * @param event_id ID of event object
+ * @param flags    Flags to wait for
+ * @return @a flags, or 0 on failure
+ */
+uint32_t bench_event_wait_all(int event_id, uint32_t flags);
+
+/**
+ * @brief Clear events
+ *
+ * @param event_id ID of event object
+ * @param flags    Flags to clear
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_event_clear(int event_id, uint32_t flags);
+
+/**
+ * @brief Delete an event object
+ *
+ * No thread may be waiting on the event object.
+ *
+ * @param event_id ID of event object
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_event_delete(int event_id);
+
 /**
  * @brief Allocate memory from the heap.
  *
@@ -264,6 +452,79 @@ void *bench_malloc(size_t size);
  */
 void bench_free(void *ptr);
 
+/**
+ * @brief Get the number of bytes in use in the heap
+ *
+ * The count includes the bookkeeping overhead of the heap where the RTOS
+ * reports it.
+ *
+ * @param used Where to store the number of bytes in use
+ * @return BENCH_SUCCESS on success or BENCH_ERROR if not supported
+ */
+int bench_heap_usage_get(size_t *used);
+
+/*
+ * Largest fixed-block pool used by the tests. Ports that allocate pool
+ * storage statically must provide BENCH_POOL_MAX_SIZE bytes per pool, after
+ * rounding each block up to a multiple of the pointer size.
+ */
+
+#define BENCH_POOL_MAX_SIZE  1024
+
+/**
+ * @brief Create a fixed-block memory pool
+ *
+ * @param pool_id     ID of pool (to be used with other routines)
+ * @param block_num   Number of blocks in the pool
+ * @param block_size  Size of each block (in bytes)
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size);
+
+/**
+ * @brief Allocate a block from a pool
+ *
+ * If all blocks are in use, the routine waits until one is freed.
+ *
+ * @param pool_id ID of pool
+ * @return Pointer to the block or NULL on failure
+ */
+void *bench_pool_alloc(int pool_id);
+
+/**
+ * @brief Return a block to its pool
+ *
+ * @param pool_id ID of pool
+ * @param block   Block allocated with bench_pool_alloc()
+ */
+void bench_pool_free(int pool_id, void *block);
+
+/**
+ * @brief Delete a pool
+ *
+ * All blocks must have been returned to the pool.
+ *
+ * @param pool_id ID of pool
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_pool_delete(int pool_id);
+
+/*
+ * Largest message queue used by the tests. A queue holds at most
+ * BENCH_MQ_MAX_MSG_NUM messages of at most BENCH_MQ_MAX_MSG_LEN bytes, and
+ * at most BENCH_MQ_MAX_SIZE bytes in total. Ports that allocate message
+ * queue storage statically must provide BENCH_MQ_MAX_SIZE bytes per queue.
+ * Tests report larger queues as n/a. Hosted ports raise the default in their
+ * header.
+ */
+
+#define BENCH_MQ_MAX_MSG_NUM  64
+#define BENCH_MQ_MAX_MSG_LEN  4096
+
+#ifndef BENCH_MQ_MAX_SIZE
+#define BENCH_MQ_MAX_SIZE     4096
+#endif
+
 /**
  * @brief Create a message queue
  *
@@ -317,6 +578,183 @@ int bench_message_queue_receive(int mq_id, char *msg_ptr, size_t msg_len);
  */
 int bench_message_queue_delete(int mq_id, const char *mq_name);
 
+/*
+ * Largest zero-copy channel used by the tests. Ports that allocate channel
+ * buffers statically must provide BENCH_CHANNEL_MAX_BUF_NUM buffers of
+ * BENCH_CHANNEL_MAX_BUF_SIZE bytes per channel. Tests report larger buffers
+ * as n/a. Hosted ports raise the default in their header.
+ */
+
+#define BENCH_CHANNEL_MAX_BUF_NUM   4
+
+#ifndef BENCH_CHANNEL_MAX_BUF_SIZE
+#define BENCH_CHANNEL_MAX_BUF_SIZE  1024
+#endif
+
+/**
+ * @brief Create a zero-copy channel
+ *
+ * This routine initializes a channel that passes pointers to buffers, rather
+ * than copies of their contents, between threads. The buffers are drawn from
+ * a fixed pool owned by the channel.
+ *
+ * @param ch_id     ID of channel (to be used with other routines)
+ * @param buf_num   Number of buffers in the pool
+ * @param buf_size  Size of each buffer (in bytes)
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_channel_create(int ch_id, size_t buf_num, size_t buf_size);
+
+/**
+ * @brief Allocate a buffer from the pool of a channel
+ *
+ * If all buffers are in use, the routine waits until one is released.
+ *
+ * @param ch_id ID of channel
+ * @return Pointer to the buffer or NULL on failure
+ */
+void *bench_channel_alloc(int ch_id);
+
+/**
+ * @brief Send a buffer through a channel
+ *
+ * Ownership of the buffer passes to the receiver.
+ *
+ * @param ch_id ID of channel
+ * @param buf   Buffer obtained with \ref bench_channel_alloc
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_channel_send(int ch_id, void *buf);
+
+/**
+ * @brief Receive a buffer from a channel
+ *
+ * If no buffer has been sent, the routine waits forever for one.
+ *
+ * @param ch_id ID of channel
+ * @return Pointer to the buffer or NULL on failure
+ */
+void *bench_channel_receive(int ch_id);
+
+/**
+ * @brief Release a buffer to the pool of a channel
+ *
+ * @param ch_id ID of channel
+ * @param buf   Buffer obtained with \ref bench_channel_alloc or
+ *              \ref bench_channel_receive
+ */
+void bench_channel_release(int ch_id, void *buf);
+
+/**
+ * @brief Delete a channel
+ *
+ * This routine deletes a channel, and cleans up any resources.
+ *
+ * @param ch_id ID of channel
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_channel_delete(int ch_id);
+
+/*
+ * Most software timers used by the tests. Ports that allocate timers
+ * statically must provide BENCH_SOFT_TIMER_MAX_NUM of them. The default suits
+ * small MCUs, and hosted ports raise it in their header; tests that need
+ * more timers report n/a.
+ */
+
+#ifndef BENCH_SOFT_TIMER_MAX_NUM
+#define BENCH_SOFT_TIMER_MAX_NUM  16
+#endif
+
+typedef void (*bench_soft_timer_handler_t)(void *arg);
+
+/**
+ * @brief Create a software timer
+ *
+ * The handler runs in whatever context the RTOS runs timer callbacks in:
+ * an ISR, a timer service thread or a signal handler. It may only call
+ * routines that are safe in an ISR.
+ *
+ * @param timer_id ID of timer (to be used with other routines)
+ * @param handler  Routine to call when the timer expires
+ * @param arg      Argument to pass to @a handler
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg);
+
+/**
+ * @brief Start a software timer
+ *
+ * This routine (re)starts the timer to expire @a usec microseconds from
+ * now, rounded up to whole ticks of the RTOS. A periodic timer then expires
+ * every @a usec microseconds until it is stopped.
+ *
+ * @param timer_id ID of timer
+ * @param usec     Time until expiry in microseconds (not 0)
+ * @param periodic Whether the timer restarts itself when it expires
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic);
+
+/**
+ * @brief Stop a software timer
+ *
+ * @param timer_id ID of timer
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_soft_timer_stop(int timer_id);
+
+/**
+ * @brief Delete a software timer
+ *
+ * @param timer_id ID of timer
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_soft_timer_delete(int timer_id);
+
+/*
+ * ID of the work queue that the RTOS itself provides for deferred work.
+ * Ports whose RTOS has none fail to submit to it.
+ */
+
+#define BENCH_WORK_SYSTEM_QUEUE  (-1)
+
+typedef void (*bench_work_handler_t)(bench_work *work);
+
+/**
+ * @brief Create a work queue
+ *
+ * This routine starts a thread that runs the handlers of the work items
+ * submitted to the queue, one after another in the order they were
+ * submitted. Work queues run until the program ends.
+ *
+ * @param queue_id ID of work queue (to be used with bench_work_submit())
+ * @param priority Priority of the thread of the work queue
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_work_queue_create(int queue_id, int priority);
+
+/**
+ * @brief Initialize a work item
+ *
+ * @param work    Work item
+ * @param handler Routine to call from the work queue thread
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_work_init(bench_work *work, bench_work_handler_t handler);
+
+/**
+ * @brief Submit a work item to a work queue
+ *
+ * A work item must not be submitted again before its handler has started.
+ *
+ * @param queue_id ID of work queue, or BENCH_WORK_SYSTEM_QUEUE
+ * @param work     Work item
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+int bench_work_submit(int queue_id, bench_work *work);
+
 /**
  * @brief Get a pointer to the system tick handler
  *
@@ -355,6 +793,33 @@ void bench_timer_isr_restore(bench_isr_handler_t handler);
  */
 bench_time_t bench_timer_isr_expiry_set(uint32_t usec);
 
+/**
+ * @brief Trigger the timer ISR every @a usec microseconds
+ *
+ * This routine programs the timer to fire one period from now and then
+ * once per period until \ref bench_timer_isr_restore is called. Expiries
+ * are spaced by the period of the timer itself, not by the time at which
+ * the handler runs, so handler latency does not accumulate.
+ *
+ * The timer ISR must call \ref bench_timer_isr_periodic_ack each time it
+ * runs.
+ *
+ * @param usec Period in microseconds
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR if not supported
+ */
+int bench_timer_isr_periodic_set(uint32_t usec);
+
+/**
+ * @brief Re-arm a periodic timer from the timer ISR
+ *
+ * Timers without a reload register program the next expiry one period
+ * after the previous one. Expiries that have already passed are skipped.
+ * This routine must be called after the previous timer ISR (if chained)
+ * has run. It does nothing on timers that reload by themselves.
+ */
+void bench_timer_isr_periodic_ack(void);
+
 /**
  * @brief Calculate the number of cycles between the trigger and sampling points
  *
@@ -388,6 +853,59 @@ uint32_t bench_timer_cycles_per_second(void);
  */
 uint32_t bench_timer_cycles_per_tick(void);
 
+/*
+ * Software-triggered interrupts. The handler of BENCH_SOFT_IRQ_HIGH preempts
+ * that of BENCH_SOFT_IRQ_LOW. BENCH_SOFT_IRQ_LOW triggered while either
+ * handler runs is taken once that handler returns.
+ */
+
+#define BENCH_SOFT_IRQ_HIGH  0
+#define BENCH_SOFT_IRQ_LOW   1
+#define BENCH_SOFT_IRQ_NUM   2
+
+/**
+ * @brief Connect a handler to a software-triggered interrupt
+ *
+ * @param irq_id  BENCH_SOFT_IRQ_HIGH or BENCH_SOFT_IRQ_LOW
+ * @param handler Interrupt handler, called with a NULL argument
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR if not supported
+ */
+int bench_soft_irq_connect(int irq_id, bench_isr_handler_t handler);
+
+/**
+ * @brief Trigger a software interrupt
+ *
+ * This routine may be called from a thread or from a software interrupt
+ * handler. The interrupt may be taken shortly after this routine returns
+ * rather than before it, so callers must not assume the handler has run.
+ *
+ * @param irq_id BENCH_SOFT_IRQ_HIGH or BENCH_SOFT_IRQ_LOW
+ */
+void bench_soft_irq_trigger(int irq_id);
+
+/**
+ * @brief Disconnect the handler of a software-triggered interrupt
+ *
+ * @param irq_id BENCH_SOFT_IRQ_HIGH or BENCH_SOFT_IRQ_LOW
+ */
+void bench_soft_irq_disconnect(int irq_id);
+
+/**
+ * @brief Run a routine in interrupt context
+ *
+ * This routine raises a software interrupt (or trap) whose handler calls
+ * @a handler, and returns once the interrupt has been serviced. It needs
+ * no timer or interrupt controller support from the port, so it is
+ * available on boards where the timer ISR cannot be replaced.
+ *
+ * @param handler Routine to run in interrupt context
+ * @param arg     Argument passed to @a handler
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR if not supported
+ */
+int bench_irq_offload(bench_isr_handler_t handler, void *arg);
+
 
 /**
  * @brief Provides an opportunity to collect resources.
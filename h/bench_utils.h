@@ -5,12 +5,6 @@
 
 #include <stdio.h>
 
-#ifdef CSV_FORMAT_OUTPUT
-#define FORMAT "%-50s,%8u,%8u\n"
-#else
-#define FORMAT "%-50s:%8u cycles , %8u ns\n"
-#endif
-
 #ifdef ZEPHYR
 #include "../src/zephyr/bench_porting_layer_zephyr.h"
 #endif /* ZEPHYR */
@@ -26,21 +20,309 @@
 #ifdef __VXWORKS__
 #include "../src/vxworks/bench_porting_layer_vxworks.h"
 #endif
+#ifdef POSIX
+#include "../src/posix/bench_porting_layer_posix.h"
+#endif /* POSIX */
+
+#include "bench_api.h"
+
+#ifndef CALIBRATION_LOOPS
+#define CALIBRATION_LOOPS 10000
+#endif
+
+/*
+ * Each set of statistics carries a log-linear (HDR-style) histogram of the
+ * samples. Values below 2^BENCH_HIST_SUB_BITS are counted exactly. Above
+ * that, each power of two is split into 2^BENCH_HIST_SUB_BITS linear
+ * buckets, bounding the relative error of a reported percentile to
+ * 2^-BENCH_HIST_SUB_BITS. Values of 2^BENCH_HIST_MAX_BITS cycles or more
+ * are counted in the last bucket.
+ *
+ * The histogram takes (BENCH_HIST_MAX_BITS - BENCH_HIST_SUB_BITS + 1) *
+ * 2^BENCH_HIST_SUB_BITS * 4 bytes in every struct bench_stats (368 bytes
+ * by default), so the defaults are sized for microcontroller RAM. Raise
+ * them for finer percentiles on targets with memory to spare.
+ */
+
+#ifndef BENCH_HIST_SUB_BITS
+#define BENCH_HIST_SUB_BITS  2
+#endif
+
+#ifndef BENCH_HIST_MAX_BITS
+#define BENCH_HIST_MAX_BITS  24
+#endif
+
+/*
+ * When TRACE_SAMPLES is non-zero, every sample passed to bench_stats_update()
+ * is also recorded in a ring buffer of TRACE_SAMPLES entries. The samples of
+ * a metric are dumped (base64 encoded) after its result line and can be
+ * decoded with scripts/trace_decode.py. Stats whose trace_id is 0, such as
+ * the timing overhead calibration, are not traced.
+ */
+
+#ifndef TRACE_SAMPLES
+#define TRACE_SAMPLES  0
+#endif
+
+/*
+ * When TICK_FILTER is non-zero, each timestamp taken with bench_stamp_get()
+ * also holds the system tick count, and bench_stats_update() checks whether
+ * the tick count advanced between the two timestamps of the sample. Such
+ * tick-affected samples are left out of the statistics and are only counted,
+ * along with their maximum, in the ticked fields. Samples added with
+ * bench_stats_update_raw() are never filtered: they time the timer interrupt
+ * that drives the tick, or are woken by it.
+ *
+ * When TICK_REALIGN is non-zero, bench_iteration_start() busy waits for the
+ * next tick on every iteration that is a multiple of TICK_REALIGN.
+ *
+ * Both only make sense with a tick that lands within a run. The Zephyr board
+ * confs run the tick at 1 Hz, so with either option the Zephyr build adds
+ * src/zephyr/tick_filter.conf, which raises it to 1000 Hz.
+ */
+
+#ifndef TICK_FILTER
+#define TICK_FILTER  0
+#endif
+
+#ifndef TICK_REALIGN
+#define TICK_REALIGN  0
+#endif
+
+#define BENCH_HIST_SUB_COUNT  (1U << BENCH_HIST_SUB_BITS)
+#define BENCH_HIST_BUCKETS    \
+	((BENCH_HIST_MAX_BITS - BENCH_HIST_SUB_BITS + 1) * BENCH_HIST_SUB_COUNT)
 
 struct bench_stats {
 	bench_time_t avg;
 	bench_time_t min;
 	bench_time_t max;
 	bench_time_t total;
+	uint64_t sumsq_lo;      /* Sum of the squared samples, low 64 bits */
+	uint64_t sumsq_hi;      /* ... and high 64 bits */
+	uint32_t count;
+	uint32_t ticked;
+	bench_time_t ticked_max;
+	uint16_t trace_id;      /* 0 if the samples are not traced */
+	uint32_t hist[BENCH_HIST_BUCKETS];
 };
 
+/*
+ * Timestamp of one end of a sample. With TICK_FILTER, the tick count is read
+ * just before the timing counter, so that the calibrated overhead of a pair
+ * of timestamps includes one tick count read.
+ */
+struct bench_stamp {
+	bench_time_t cycles;
+#if TICK_FILTER
+	uint64_t tick;
+#endif
+};
+
+/**
+ * @brief Take a timestamp
+ */
+static inline struct bench_stamp bench_stamp_get(void)
+{
+	struct bench_stamp stamp;
+
+#if TICK_FILTER
+	stamp.tick = bench_tick_count_get();
+#endif
+	stamp.cycles = bench_timing_counter_get();
+
+	return stamp;
+}
+
+/**
+ * @brief Get the cycles from timestamp @a start to timestamp @a end
+ */
+static inline bench_time_t bench_stamp_cycles(const struct bench_stamp *start,
+					      const struct bench_stamp *end)
+{
+	bench_time_t from = start->cycles;
+	bench_time_t to = end->cycles;
+
+	return bench_timing_cycles_get(&from, &to);
+}
+
+/**
+ * @brief Check whether a tick occurred between two timestamps
+ *
+ * @return true with TICK_FILTER if the tick count advanced, false otherwise
+ */
+static inline bool bench_stamp_ticked(const struct bench_stamp *start,
+				      const struct bench_stamp *end)
+{
+#if TICK_FILTER
+	return start->tick != end->tick;
+#else
+	ARG_UNUSED(start);
+	ARG_UNUSED(end);
+
+	return false;
+#endif
+}
+
 void bench_stats_reset(struct bench_stats *stats);
 
-void bench_stats_update(struct bench_stats *stats, bench_time_t value,
-			uint32_t iteration);
+/**
+ * @brief Add a sample measured between two timestamps
+ *
+ * The timer overhead determined by bench_timing_overhead_calibrate() is
+ * subtracted from the interval before it is recorded. With TICK_FILTER the
+ * sample is only counted as tick-affected if a tick occurred within it.
+ */
+void bench_stats_update(struct bench_stats *stats,
+			const struct bench_stamp *start,
+			const struct bench_stamp *end, uint32_t iteration);
+
+/**
+ * @brief Add a sample derived from timestamps, such as a sum of intervals
+ *
+ * Like bench_stats_update(), but for a @a value in cycles that already
+ * includes one timer overhead, and that the caller found to be
+ * tick-affected (@a ticked) or not.
+ */
+void bench_stats_update_cycles(struct bench_stats *stats, bench_time_t value,
+			       uint32_t iteration, bool ticked);
+
+/**
+ * @brief Add a sample without correcting it for the timer overhead
+ *
+ * This is intended for samples that are not derived from a pair of
+ * bench_timing_counter_get() reads.
+ */
+void bench_stats_update_raw(struct bench_stats *stats, bench_time_t value,
+			    uint32_t iteration);
+
+/**
+ * @brief Busy wait until the system tick count next advances
+ *
+ * Unlike bench_sync_ticks(), this does not block, so other threads do not
+ * run while the current thread waits.
+ */
+void bench_tick_align(void);
+
+/**
+ * @brief Measure the system tick period
+ *
+ * This busy waits for two tick boundaries, so it takes up to two ticks.
+ *
+ * @return Tick period, rounded to the nearest microsecond
+ */
+uint32_t bench_tick_period_us(void);
+
+/**
+ * @brief Mark the start of an iteration of a test
+ *
+ * This is called by the test thread before the samples of each iteration
+ * are taken. It realigns to a tick boundary with TICK_REALIGN. Otherwise it
+ * does nothing.
+ *
+ * @param iteration Iteration number
+ */
+void bench_iteration_start(uint32_t iteration);
+
+/**
+ * @brief Dump the traced samples of a metric
+ *
+ * This routine is a no-op unless TRACE_SAMPLES is non-zero.
+ *
+ * @param test Title of the test
+ * @param summary Name of the metric
+ * @param stats Statistics of the metric
+ */
+void bench_trace_dump(const char *test, const char *summary,
+		      const struct bench_stats *stats);
+
+/**
+ * @brief Measure and report the cost of reading the timing counter
+ *
+ * This routine measures CALIBRATION_LOOPS back-to-back pairs of
+ * bench_stamp_get() calls. The minimum is subsequently subtracted from every
+ * sample passed to bench_stats_update().
+ *
+ * Every port calls this from bench_test_init(), in the thread that runs the
+ * test, so that single tests and the whole suite are corrected alike.
+ */
+void bench_timing_overhead_calibrate(void);
+
+/**
+ * @brief Get the timer overhead subtracted by bench_stats_update()
+ *
+ * @return Timer overhead in cycles (0 if not calibrated)
+ */
+bench_time_t bench_timing_overhead_get(void);
+
+/**
+ * @brief Get a percentile of the recorded samples
+ *
+ * @param stats Statistics to examine
+ * @param ppm Percentile in parts per million (e.g. 990000 for p99)
+ *
+ * @return Percentile value in cycles, or 0 if there are no samples
+ */
+bench_time_t bench_stats_percentile(const struct bench_stats *stats,
+				    uint32_t ppm);
+
+/**
+ * @brief Get the standard deviation of the recorded samples
+ *
+ * The deviation is exact, derived from the sum and the sum of squares of the
+ * samples in integer arithmetic. Samples above UINT32_MAX cycles are squared
+ * as UINT32_MAX.
+ *
+ * @return Standard deviation in cycles
+ */
+bench_time_t bench_stats_stddev(const struct bench_stats *stats);
+
+/**
+ * @brief Busy wait for at least @a ns nanoseconds
+ *
+ * The wait spins on the timing counter without blocking, so it also works
+ * with interrupts locked and keeps the current CPU busy.
+ */
+void bench_busy_wait_ns(uint32_t ns);
+
+/**
+ * @brief Result reporter
+ *
+ * A reporter formats the results of the tests. The title of the most recent
+ * call to bench_stats_report_title() identifies the test to which each
+ * subsequent result line belongs.
+ */
+struct bench_reporter {
+	/** Describe the run (RTOS, board and build configuration) */
+	void (*header)(void);
+	/** Start the results of a new test */
+	void (*title)(const char *title);
+	/** Report one metric of @a test */
+	void (*line)(const char *test, const char *summary,
+		     const struct bench_stats *stats);
+	/** Report a metric of @a test that is not supported */
+	void (*na)(const char *test, const char *summary);
+	/** Report a metric of @a test that is a single value */
+	void (*value)(const char *test, const char *summary, uint64_t value,
+		      const char *unit);
+};
+
+extern const struct bench_reporter bench_reporter_text;
+extern const struct bench_reporter bench_reporter_csv;
+extern const struct bench_reporter bench_reporter_json;
+
+/**
+ * @brief Select the reporter used by the bench_stats_report_*() routines
+ *
+ * The default reporter is chosen at build time with REPORT_FORMAT.
+ */
+void bench_report_set(const struct bench_reporter *reporter);
 
 /**
  * @brief Display the test's title line
+ *
+ * The run header is emitted ahead of the first title. The title is copied,
+ * so the caller may reuse its buffer for the next title.
  */
 void bench_stats_report_title(const char *title);
 
@@ -54,4 +336,23 @@ void bench_stats_report_line(const char *summary, const struct bench_stats *stat
  */
 void bench_stats_report_na(const char *summary);
 
+/**
+ * @brief Display a metric that is a single value rather than a distribution
+ *
+ * @param summary Name of the metric
+ * @param value Value of the metric
+ * @param unit Unit of @a value (e.g. "ops/s")
+ */
+void bench_stats_report_value(const char *summary, uint64_t value,
+			      const char *unit);
+
+/**
+ * @brief Display how the time since the test's title line was spent
+ *
+ * With RUNTIME_STATS, this reports the run time of the calling thread, of
+ * each thread ID that ran and of the idle thread, as well as the time that
+ * none of them accounts for. Otherwise it does nothing.
+ */
+void bench_stats_report_runtime(void);
+
 #endif
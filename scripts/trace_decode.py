@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+
+"""Decode the raw sample traces from a benchmark console log.
+
+The benchmark emits traces when built with -DTRACE_SAMPLES=<n>. Each traced
+metric appears in the log as
+
+    TRACE-BEGIN id=<id> ns_per_mcycle=<ns> test="<test>" metric="<metric>"
+    TRACE <base64>
+    ...
+    TRACE-END id=<id> samples=<n> lost=<n>
+
+where the base64 payload is a sequence of 10 byte little endian records of
+(uint16 metric ID, uint32 iteration, uint32 cycles).
+
+The decoded time series is written as CSV with the columns
+test, metric, iteration, cycles, ns.
+"""
+
+import argparse
+import base64
+import csv
+import re
+import struct
+import sys
+
+RECORD = struct.Struct('<HII')
+
+BEGIN_RE = re.compile(r'TRACE-BEGIN id=(\d+) ns_per_mcycle=(\d+) '
+                      r'test="(.*)" metric="(.*)"')
+END_RE = re.compile(r'TRACE-END id=(\d+) samples=(\d+) lost=(\d+)')
+
+
+def decode(lines):
+    """Yield (test, metric, iteration, cycles, ns) for every traced sample."""
+    current = None
+    payload = []
+
+    for line in lines:
+        line = line.strip()
+
+        match = BEGIN_RE.search(line)
+        if match:
+            current = match.groups()
+            payload = []
+            continue
+
+        if current is None:
+            continue
+
+        if line.startswith('TRACE '):
+            payload.append(line[len('TRACE '):])
+            continue
+
+        match = END_RE.search(line)
+        if match:
+            trace_id, ns_per_mcycle, test, metric = current
+            data = base64.b64decode(''.join(payload))
+
+            for offset in range(0, len(data), RECORD.size):
+                record_id, iteration, cycles = RECORD.unpack_from(data, offset)
+                if record_id != int(trace_id):
+                    raise ValueError(f'unexpected metric ID {record_id} in '
+                                     f'trace of "{test}: {metric}"')
+                yield (test, metric, iteration, cycles,
+                       cycles * int(ns_per_mcycle) // 1000000)
+
+            lost = int(match.group(3))
+            if lost:
+                print(f'warning: "{test}: {metric}" lost {lost} samples '
+                      f'(trace buffer too small)', file=sys.stderr)
+
+            current = None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('log', nargs='?', type=argparse.FileType('r'),
+                        default=sys.stdin,
+                        help='console log of a benchmark run (default: stdin)')
+    parser.add_argument('-o', '--output', type=argparse.FileType('w'),
+                        default=sys.stdout,
+                        help='CSV output file (default: stdout)')
+    args = parser.parse_args()
+
+    writer = csv.writer(args.output)
+    writer.writerow(['test', 'metric', 'iteration', 'cycles', 'ns'])
+    writer.writerows(decode(args.log))
+
+
+if __name__ == '__main__':
+    main()
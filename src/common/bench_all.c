@@ -6,11 +6,27 @@
 extern void bench_basic_thread_ops(void *arg);
 extern void bench_interrupt_latency_test(void *arg);
 extern void bench_mutex_lock_unlock_test(void *arg);
+extern void bench_mutex_throughput_init(void *arg);
+extern void bench_nested_interrupt_init(void *arg);
 extern void bench_sem_context_switch_init(void *arg);
 extern void bench_sem_signal_release_init(void *arg);
+extern void bench_soft_interrupt_init(void *arg);
+extern void bench_soft_timer_init(void *arg);
+extern void bench_idle_wakeup_init(void *arg);
 extern void bench_thread_yield(void *arg);
+extern void bench_sched_scaling_init(void *arg);
 extern void bench_malloc_free(void *arg);
+extern void bench_malloc_contention_init(void *arg);
+extern void bench_pool_init(void *arg);
 extern void bench_message_queue_init(void *arg);
+extern void bench_message_queue_sweep_init(void *arg);
+extern void bench_smp_sem_init(void *arg);
+extern void bench_smp_mutex_init(void *arg);
+extern void bench_smp_message_queue_init(void *arg);
+extern void bench_condvar_init(void *arg);
+extern void bench_event_init(void *arg);
+extern void bench_work_queue_init(void *arg);
+extern void bench_zero_copy_init(void *arg);
 
 void bench_all(void *arg)
 {
@@ -18,11 +34,27 @@ void bench_all(void *arg)
 
 	bench_basic_thread_ops(arg);
 	bench_mutex_lock_unlock_test(arg);
+	bench_mutex_throughput_init(arg);
+	bench_nested_interrupt_init(arg);
 	bench_sem_context_switch_init(arg);
 	bench_sem_signal_release_init(arg);
+	bench_soft_interrupt_init(arg);
+	bench_soft_timer_init(arg);
+	bench_idle_wakeup_init(arg);
 	bench_thread_yield(arg);
+	bench_sched_scaling_init(arg);
 	bench_malloc_free(arg);
+	bench_malloc_contention_init(arg);
+	bench_pool_init(arg);
+	bench_condvar_init(arg);
+	bench_event_init(arg);
+	bench_work_queue_init(arg);
 	bench_message_queue_init(arg);
+	bench_message_queue_sweep_init(arg);
+	bench_zero_copy_init(arg);
+	bench_smp_sem_init(arg);
+	bench_smp_mutex_init(arg);
+	bench_smp_message_queue_init(arg);
 
 	/* This should be the last test as it can muck with the timer */
 
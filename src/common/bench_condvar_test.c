@@ -0,0 +1,269 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure time for condition variable operations
+ *
+ * This file contains the test that measures
+ *
+ *   - the cost of signaling and broadcasting a condition variable on which
+ *     no thread waits,
+ *   - the time from signaling a condition variable until the higher
+ *     priority thread waiting on it runs, and
+ *   - the time from broadcasting a condition variable until the last of 1,
+ *     2, 4, 8 and 16 higher priority threads waiting on it runs.
+ *
+ * The broadcast waiters alternate between two priorities. As each of them
+ * must lock the mutex again before it returns from its wait, they run one
+ * after another.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
+
+#define MAX_WAITERS   16
+
+#define THREAD_WAITER 1   /* ID of the first waiter thread */
+
+#define CONDVAR_ID    0
+#define MUTEX_ID      0
+
+static const char *broadcast_strings[] = {
+	"Broadcast waking 1 waiter",
+	"Broadcast waking 2 waiters",
+	"Broadcast waking 4 waiters",
+	"Broadcast waking 8 waiters",
+	"Broadcast waking 16 waiters",
+};
+
+#define NUM_LEVELS  (sizeof(broadcast_strings) / sizeof(broadcast_strings[0]))
+
+static volatile struct bench_stamp timestamp_wake[MAX_WAITERS];
+
+static struct bench_stats signal_times;
+static struct bench_stats broadcast_times;
+
+/**
+ * @brief Gather stats for signaling a condition variable without waiters
+ */
+static void gather_no_waiter_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp mid;
+	struct bench_stamp end;
+	uint32_t i;
+
+	bench_mutex_lock(MUTEX_ID);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_condvar_signal(CONDVAR_ID);
+		mid = bench_stamp_get();
+		bench_condvar_broadcast(CONDVAR_ID);
+		end = bench_stamp_get();
+
+		bench_stats_update(&signal_times, &start, &mid, i);
+		bench_stats_update(&broadcast_times, &mid, &end, i);
+	}
+
+	bench_mutex_unlock(MUTEX_ID);
+}
+
+/**
+ * @brief Higher priority thread waiting on the condition variable
+ *
+ * It waits again before the thread that woke it runs.
+ */
+static void bench_condvar_waiter(void *args)
+{
+	int waiter = (int)(uintptr_t)args;
+	uint32_t i;
+
+	bench_mutex_lock(MUTEX_ID);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_condvar_wait(CONDVAR_ID, MUTEX_ID);
+		timestamp_wake[waiter] = bench_stamp_get();
+	}
+
+	bench_mutex_unlock(MUTEX_ID);
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Start @a num_waiters waiter threads
+ *
+ * @return false if the threads cannot be created
+ */
+static bool waiters_start(int num_waiters)
+{
+	int j;
+
+	for (j = 0; j < num_waiters; j++) {
+		if (bench_thread_create(THREAD_WAITER + j, "condvar_waiter",
+					MAIN_PRIORITY - 1 - (j % 2),
+					bench_condvar_waiter,
+					(void *)(uintptr_t)j) != BENCH_SUCCESS) {
+			return false;
+		}
+	}
+
+	/* Each waiter runs at once and waits on the condition variable */
+
+	for (j = 0; j < num_waiters; j++) {
+		bench_thread_start(THREAD_WAITER + j);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Gather stats for signaling a condition variable with a waiter
+ */
+static void gather_signal_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp wake;
+	uint32_t i;
+
+	if (!waiters_start(1)) {
+		bench_stats_report_na("Signal to waiter (context switch)");
+		return;
+	}
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		bench_mutex_lock(MUTEX_ID);
+		start = bench_stamp_get();
+		bench_condvar_signal(CONDVAR_ID);
+		bench_mutex_unlock(MUTEX_ID);
+
+		wake = timestamp_wake[0];
+		bench_stats_update(&signal_times, &start, &wake, i);
+	}
+
+	bench_collect_resources();
+
+	bench_stats_report_line("Signal to waiter (context switch)",
+				&signal_times);
+}
+
+/**
+ * @brief Gather stats for broadcasting to @a num_waiters waiters
+ *
+ * All waiters have run and are waiting again by the time the mutex is
+ * unlocked. The time reported is that until the last of them ran.
+ */
+static void gather_broadcast_stats(uint32_t level, int num_waiters)
+{
+	struct bench_stamp start;
+	struct bench_stamp wake;
+	struct bench_stamp last_wake;
+	bench_time_t cycles;
+	bench_time_t last;
+	uint32_t i;
+	int j;
+
+	bench_stats_reset(&broadcast_times);
+
+	if (!waiters_start(num_waiters)) {
+		bench_stats_report_na(broadcast_strings[level]);
+		return;
+	}
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		bench_mutex_lock(MUTEX_ID);
+		start = bench_stamp_get();
+		bench_condvar_broadcast(CONDVAR_ID);
+		bench_mutex_unlock(MUTEX_ID);
+
+		last = 0;
+		last_wake = start;
+		for (j = 0; j < num_waiters; j++) {
+			wake = timestamp_wake[j];
+			cycles = bench_stamp_cycles(&start, &wake);
+			if (cycles > last) {
+				last = cycles;
+				last_wake = wake;
+			}
+		}
+		bench_stats_update(&broadcast_times, &start, &last_wake, i);
+	}
+
+	bench_collect_resources();
+
+	bench_stats_report_line(broadcast_strings[level], &broadcast_times);
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_condvar_init(void *arg)
+{
+	uint32_t level;
+	int num_waiters;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Condition variable stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_mutex_create(MUTEX_ID);
+
+	if (bench_condvar_create(CONDVAR_ID) != BENCH_SUCCESS) {
+		bench_stats_report_na("Signal (no waiter)");
+		bench_stats_report_na("Broadcast (no waiter)");
+		bench_stats_report_na("Signal to waiter (context switch)");
+		for (level = 0; level < NUM_LEVELS; level++) {
+			bench_stats_report_na(broadcast_strings[level]);
+		}
+
+		bench_timing_stop();
+		return;
+	}
+
+	bench_stats_reset(&signal_times);
+	bench_stats_reset(&broadcast_times);
+
+	gather_no_waiter_stats();
+
+	bench_stats_report_line("Signal (no waiter)", &signal_times);
+	bench_stats_report_line("Broadcast (no waiter)", &broadcast_times);
+
+	bench_stats_reset(&signal_times);
+
+	gather_signal_stats();
+
+	for (level = 0, num_waiters = 1; level < NUM_LEVELS;
+	     level++, num_waiters *= 2) {
+		gather_broadcast_stats(level, num_waiters);
+	}
+
+	bench_condvar_delete(CONDVAR_ID);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_CONDVAR
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_condvar_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
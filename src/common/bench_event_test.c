@@ -0,0 +1,334 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure time for event object operations
+ *
+ * This file contains the test that measures the cost of posting events
+ *
+ *   - when no thread is waiting for them,
+ *   - when they wake one higher priority thread, with a context switch,
+ *     for a thread waiting for any of a set of events and for a thread
+ *     waiting for all of them, and
+ *   - when they wake 1, 2, 4 and 8 higher priority threads at once, until
+ *     the last of them runs.
+ *
+ * The waiters of the last case alternate between two priorities.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
+
+#define MAX_WAITERS   8
+
+#define THREAD_WAITER 1   /* ID of the first waiter thread */
+
+#define EVENT_ID      0
+#define SEM_ID        0
+
+#define FLAG_A        0x1
+#define FLAG_B        0x2
+
+static const char *wake_strings[] = {
+	"Post waking 1 waiter",
+	"Post waking 2 waiters",
+	"Post waking 4 waiters",
+	"Post waking 8 waiters",
+};
+
+#define NUM_LEVELS  (sizeof(wake_strings) / sizeof(wake_strings[0]))
+
+static volatile struct bench_stamp timestamp_wake[MAX_WAITERS];
+
+static struct bench_stats post_times;
+static struct bench_stats wait_times;
+static struct bench_stats clear_times;
+
+/**
+ * @brief Gather stats for event operations that do not block or wake
+ */
+static void gather_no_waiter_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp mid;
+	struct bench_stamp end;
+	uint32_t i;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_event_post(EVENT_ID, FLAG_A);
+		mid = bench_stamp_get();
+		bench_event_wait_any(EVENT_ID, FLAG_A);
+		end = bench_stamp_get();
+
+		bench_stats_update(&post_times, &start, &mid, i);
+		bench_stats_update(&wait_times, &mid, &end, i);
+
+		start = bench_stamp_get();
+		bench_event_clear(EVENT_ID, FLAG_A);
+		end = bench_stamp_get();
+
+		bench_stats_update(&clear_times, &start, &end, i);
+	}
+}
+
+/**
+ * @brief Higher priority thread waiting for either event
+ */
+static void bench_event_any_waiter(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_event_wait_any(EVENT_ID, FLAG_A | FLAG_B);
+		timestamp_wake[0] = bench_stamp_get();
+		bench_event_clear(EVENT_ID, FLAG_A | FLAG_B);
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Higher priority thread waiting for both events
+ */
+static void bench_event_all_waiter(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_event_wait_all(EVENT_ID, FLAG_A | FLAG_B);
+		timestamp_wake[0] = bench_stamp_get();
+		bench_event_clear(EVENT_ID, FLAG_A | FLAG_B);
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather stats for posting an event that wakes a waiter for either
+ *
+ * The waiter has run, cleared the events and is waiting again by the time
+ * bench_event_post() returns.
+ */
+static void gather_any_waiter_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp wake;
+	uint32_t i;
+
+	bench_thread_create(THREAD_WAITER, "event_any_waiter",
+			    MAIN_PRIORITY - 1, bench_event_any_waiter, NULL);
+	bench_thread_start(THREAD_WAITER);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_event_post(EVENT_ID, FLAG_A);
+
+		wake = timestamp_wake[0];
+		bench_stats_update(&wait_times, &start, &wake, i);
+	}
+
+	bench_collect_resources();
+}
+
+/**
+ * @brief Gather stats for posting events to a waiter for both
+ *
+ * Posting the first event does not satisfy the waiter. Posting the second
+ * one wakes it.
+ */
+static void gather_all_waiter_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	struct bench_stamp wake;
+	uint32_t i;
+
+	bench_thread_create(THREAD_WAITER, "event_all_waiter",
+			    MAIN_PRIORITY - 1, bench_event_all_waiter, NULL);
+	bench_thread_start(THREAD_WAITER);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_event_post(EVENT_ID, FLAG_B);
+		end = bench_stamp_get();
+
+		bench_stats_update(&post_times, &start, &end, i);
+
+		start = bench_stamp_get();
+		bench_event_post(EVENT_ID, FLAG_A);
+
+		wake = timestamp_wake[0];
+		bench_stats_update(&wait_times, &start, &wake, i);
+	}
+
+	bench_collect_resources();
+}
+
+/**
+ * @brief One of several higher priority threads woken by the same post
+ *
+ * Once woken, each waiter parks on the semaphore so that the main thread
+ * can clear the event before it waits again.
+ */
+static void bench_event_waiter(void *args)
+{
+	int waiter = (int)(uintptr_t)args;
+	uint32_t i;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_event_wait_any(EVENT_ID, FLAG_A);
+		timestamp_wake[waiter] = bench_stamp_get();
+		bench_sem_take(SEM_ID);
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather stats for posting an event that wakes @a num_waiters
+ *
+ * All waiters have run by the time bench_event_post() returns. The time
+ * reported is that until the last of them ran.
+ */
+static void gather_broadcast_stats(uint32_t level, int num_waiters)
+{
+	struct bench_stamp start;
+	struct bench_stamp wake;
+	struct bench_stamp last_wake;
+	bench_time_t cycles;
+	bench_time_t last;
+	uint32_t i;
+	int j;
+
+	bench_stats_reset(&post_times);
+
+	for (j = 0; j < num_waiters; j++) {
+		bench_thread_create(THREAD_WAITER + j, "event_waiter",
+				    MAIN_PRIORITY - 1 - (j % 2),
+				    bench_event_waiter, (void *)(uintptr_t)j);
+		bench_thread_start(THREAD_WAITER + j);
+	}
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_event_post(EVENT_ID, FLAG_A);
+
+		last = 0;
+		last_wake = start;
+		for (j = 0; j < num_waiters; j++) {
+			wake = timestamp_wake[j];
+			cycles = bench_stamp_cycles(&start, &wake);
+			if (cycles > last) {
+				last = cycles;
+				last_wake = wake;
+			}
+		}
+		bench_stats_update(&post_times, &start, &last_wake, i);
+
+		bench_event_clear(EVENT_ID, FLAG_A);
+		for (j = 0; j < num_waiters; j++) {
+			bench_sem_give(SEM_ID);
+		}
+	}
+
+	bench_collect_resources();
+
+	bench_stats_report_line(wake_strings[level], &post_times);
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_event_init(void *arg)
+{
+	uint32_t level;
+	int num_waiters;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Event stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	if (bench_event_create(EVENT_ID) != BENCH_SUCCESS) {
+		bench_stats_report_na("Post (no waiter)");
+		bench_stats_report_na("Wait (already set)");
+		bench_stats_report_na("Clear");
+		bench_stats_report_na("Post to waiter (any, context switch)");
+		bench_stats_report_na("Post (waiter not satisfied)");
+		bench_stats_report_na("Post to waiter (all, context switch)");
+		for (level = 0; level < NUM_LEVELS; level++) {
+			bench_stats_report_na(wake_strings[level]);
+		}
+
+		bench_timing_stop();
+		return;
+	}
+
+	bench_sem_create(SEM_ID, 0, MAX_WAITERS);
+
+	bench_stats_reset(&post_times);
+	bench_stats_reset(&wait_times);
+	bench_stats_reset(&clear_times);
+
+	gather_no_waiter_stats();
+
+	bench_stats_report_line("Post (no waiter)", &post_times);
+	bench_stats_report_line("Wait (already set)", &wait_times);
+	bench_stats_report_line("Clear", &clear_times);
+
+	bench_stats_reset(&wait_times);
+
+	gather_any_waiter_stats();
+
+	bench_stats_report_line("Post to waiter (any, context switch)",
+				&wait_times);
+
+	bench_stats_reset(&post_times);
+	bench_stats_reset(&wait_times);
+
+	gather_all_waiter_stats();
+
+	bench_stats_report_line("Post (waiter not satisfied)", &post_times);
+	bench_stats_report_line("Post to waiter (all, context switch)",
+				&wait_times);
+
+	for (level = 0, num_waiters = 1; level < NUM_LEVELS;
+	     level++, num_waiters *= 2) {
+		gather_broadcast_stats(level, num_waiters);
+	}
+
+	bench_event_delete(EVENT_ID);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_EVENT
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_event_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,352 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure the latency of waking a thread from idle
+ *
+ * This file contains the test that blocks a thread for IDLE_WAKEUP_DELAY_US
+ * microseconds, so that its CPU goes idle (and, on a tickless kernel, stops
+ * its tick), and then measures how long the thread takes to run again after
+ *
+ *   - a one-shot software timer expires, and
+ *   - an external event gives the semaphore it waits for. On SMP systems a
+ *     thread on another CPU raises the event. Otherwise the callback of a
+ *     second software timer does, which a thread on the same CPU starts.
+ *
+ * Each is measured with the CPU of the waiting thread idle and, for
+ * reference, with a lower priority thread spinning on it.
+ *
+ * The timer is started on a tick boundary, so that the RTOS rounds its
+ * expiry the same way every time. The expiry to thread latency therefore
+ * includes a constant part of up to one tick, which is the same with the
+ * CPU idle or busy.
+ *
+ * With a tick longer than the delay, each wakeup takes about a tick. Fewer
+ * wakeups are then timed, in proportion, so that a slow tick does not
+ * stretch the test. At least 2 are always timed.
+ *
+ * The timing counter must be synchronized across CPUs.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#ifndef IDLE_WAKEUP_DELAY_US
+#define IDLE_WAKEUP_DELAY_US  10000
+#endif
+
+#ifndef IDLE_WAKEUP_SAMPLES
+#define IDLE_WAKEUP_SAMPLES   200
+#endif
+
+/* Time (in ms) a port must be idle before it enters its low power state */
+#ifndef BENCH_IDLE_TIME
+#define BENCH_IDLE_TIME       0
+#endif
+
+/* Block long enough for the CPU to reach its low power state */
+#if IDLE_WAKEUP_DELAY_US > (BENCH_IDLE_TIME + 1) * 1000
+#define IDLE_DELAY_US  IDLE_WAKEUP_DELAY_US
+#else
+#define IDLE_DELAY_US  ((BENCH_IDLE_TIME + 1) * 1000)
+#endif
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 3)
+#define WAITER_PRIORITY (MAIN_PRIORITY - 2)
+#define SOURCE_PRIORITY (MAIN_PRIORITY - 1)
+#define BUSY_PRIORITY   (MAIN_PRIORITY + 1)
+
+#define THREAD_WAITER   1
+#define THREAD_SOURCE   2
+#define THREAD_BUSY     3
+
+#define SEM_WAKE        0
+#define SEM_ACK         1
+#define SEM_DONE        2
+
+#define TIMER_ID        0
+#define TIMER_EVENT     1
+
+#define IDLE_CPU        0
+#define SOURCE_CPU      1
+
+static volatile struct bench_stamp timestamp_event;
+static volatile bool busy_stop;
+
+static bench_time_t delay_cycles;
+static uint32_t wakeup_samples;
+static bool smp;
+
+static struct bench_stats expiry_times;
+static struct bench_stats callback_times;
+static struct bench_stats event_times;
+
+/**
+ * @brief Callback of the one-shot timers
+ */
+static void bench_idle_timer_callback(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	timestamp_event = bench_stamp_get();
+	bench_sem_give_from_isr(SEM_WAKE);
+}
+
+/**
+ * @brief Thread that sleeps on the timer
+ */
+static void bench_idle_timer_waiter(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp callback;
+	struct bench_stamp end;
+	bench_time_t elapsed;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= wakeup_samples; i++) {
+		bench_tick_align();
+
+		start = bench_stamp_get();
+		bench_soft_timer_start(TIMER_ID, IDLE_DELAY_US, false);
+		bench_sem_take(SEM_WAKE);
+		end = bench_stamp_get();
+
+		/* The stats hold lateness, not durations, so skip the overhead */
+
+		elapsed = bench_stamp_cycles(&start, &end);
+		bench_stats_update_raw(&expiry_times,
+				       (elapsed > delay_cycles) ?
+				       (elapsed - delay_cycles) : 0, i);
+
+		callback = timestamp_event;
+		bench_stats_update(&callback_times, &callback, &end, i);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that waits for the external event
+ */
+static void bench_idle_event_waiter(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= wakeup_samples; i++) {
+		bench_sem_take(SEM_WAKE);
+		end = bench_stamp_get();
+
+		start = timestamp_event;
+		bench_stats_update(&event_times, &start, &end, i);
+
+		bench_sem_give(SEM_ACK);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that raises the external event
+ *
+ * On SMP systems it runs on another CPU and raises the event itself.
+ * Otherwise it starts a timer whose callback raises it, and blocks so that
+ * the CPU goes idle.
+ */
+static void bench_idle_event_source(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= wakeup_samples; i++) {
+		if (smp) {
+			bench_busy_wait_ns(IDLE_DELAY_US * 1000);
+
+			timestamp_event = bench_stamp_get();
+			bench_sem_give(SEM_WAKE);
+		} else {
+			bench_soft_timer_start(TIMER_EVENT, IDLE_DELAY_US,
+					       false);
+		}
+
+		bench_sem_take(SEM_ACK);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that keeps the CPU of the waiter busy until told to stop
+ */
+static void bench_idle_busy(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (!busy_stop) {
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Run the waiter (and the event source) with the CPU idle or busy
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+static int gather_wakeup_stats(bool external, bool busy)
+{
+	if ((bench_thread_cpu_set(THREAD_WAITER, IDLE_CPU) != BENCH_SUCCESS) ||
+	    (external &&
+	     (bench_thread_cpu_set(THREAD_SOURCE, smp ? SOURCE_CPU : IDLE_CPU) !=
+	      BENCH_SUCCESS)) ||
+	    (busy && (bench_thread_cpu_set(THREAD_BUSY, IDLE_CPU) != BENCH_SUCCESS))) {
+		return BENCH_ERROR;
+	}
+
+	bench_stats_reset(&expiry_times);
+	bench_stats_reset(&callback_times);
+	bench_stats_reset(&event_times);
+
+	bench_sem_create(SEM_WAKE, 0, 1);
+	bench_sem_create(SEM_ACK, 0, 1);
+	bench_sem_create(SEM_DONE, 0, 3);
+
+	if (busy) {
+		busy_stop = false;
+		bench_thread_create(THREAD_BUSY, "idle_busy", BUSY_PRIORITY,
+				    bench_idle_busy, NULL);
+		bench_thread_start(THREAD_BUSY);
+	}
+
+	if (external) {
+		bench_thread_create(THREAD_WAITER, "idle_waiter",
+				    WAITER_PRIORITY, bench_idle_event_waiter,
+				    NULL);
+		bench_thread_start(THREAD_WAITER);
+		bench_thread_create(THREAD_SOURCE, "idle_source",
+				    SOURCE_PRIORITY, bench_idle_event_source,
+				    NULL);
+		bench_thread_start(THREAD_SOURCE);
+
+		bench_sem_take(SEM_DONE);
+	} else {
+		bench_thread_create(THREAD_WAITER, "idle_waiter",
+				    WAITER_PRIORITY, bench_idle_timer_waiter,
+				    NULL);
+		bench_thread_start(THREAD_WAITER);
+	}
+
+	bench_sem_take(SEM_DONE);
+
+	if (busy) {
+		busy_stop = true;
+		bench_sem_take(SEM_DONE);
+	}
+
+	bench_collect_resources();
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_idle_wakeup_init(void *arg)
+{
+	uint32_t tick_us;
+	uint64_t samples;
+	bool timer;
+	bool event;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Idle wakeup stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	delay_cycles = (IDLE_DELAY_US * 1000ULL * 1000000) /
+		       bench_timing_cycles_to_ns(1000000);
+
+	tick_us = bench_tick_period_us();
+	samples = ((uint64_t)IDLE_WAKEUP_SAMPLES * IDLE_DELAY_US) /
+		  ((tick_us > IDLE_DELAY_US) ? tick_us : IDLE_DELAY_US);
+	wakeup_samples = (samples < 2) ? 2 : (uint32_t)samples;
+
+	smp = (bench_cpu_count() > SOURCE_CPU);
+
+	timer = (bench_soft_timer_create(TIMER_ID, bench_idle_timer_callback,
+					 NULL) == BENCH_SUCCESS);
+
+	if (timer && (gather_wakeup_stats(false, true) == BENCH_SUCCESS)) {
+		bench_stats_report_line("Timer expiry to thread (busy)",
+					&expiry_times);
+		bench_stats_report_line("Timer callback to thread (busy)",
+					&callback_times);
+	} else {
+		bench_stats_report_na("Timer expiry to thread (busy)");
+		bench_stats_report_na("Timer callback to thread (busy)");
+	}
+
+	if (timer && (gather_wakeup_stats(false, false) == BENCH_SUCCESS)) {
+		bench_stats_report_line("Timer expiry to thread (idle)",
+					&expiry_times);
+		bench_stats_report_line("Timer callback to thread (idle)",
+					&callback_times);
+	} else {
+		bench_stats_report_na("Timer expiry to thread (idle)");
+		bench_stats_report_na("Timer callback to thread (idle)");
+	}
+
+	if (timer) {
+		bench_soft_timer_delete(TIMER_ID);
+	}
+
+	event = smp ||
+		(bench_soft_timer_create(TIMER_EVENT, bench_idle_timer_callback,
+					 NULL) == BENCH_SUCCESS);
+
+	if (event && (gather_wakeup_stats(true, true) == BENCH_SUCCESS)) {
+		bench_stats_report_line("External event to thread (busy)",
+					&event_times);
+	} else {
+		bench_stats_report_na("External event to thread (busy)");
+	}
+
+	if (event && (gather_wakeup_stats(true, false) == BENCH_SUCCESS)) {
+		bench_stats_report_line("External event to thread (idle)",
+					&event_times);
+	} else {
+		bench_stats_report_na("External event to thread (idle)");
+	}
+
+	if (event && !smp) {
+		bench_soft_timer_delete(TIMER_EVENT);
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_IDLE_WAKEUP
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_idle_wakeup_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
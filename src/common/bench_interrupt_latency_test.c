@@ -6,6 +6,48 @@
  * This file contains the test that measures the time from when a hardware
  * interrupt is triggered, until its associated interrupt handler begins
  * to execute.
+ *
+ * The handler gives a semaphore on which a higher priority thread waits. From
+ * the same run, the test also measures the time until that thread returns
+ * from bench_sem_take():
+ *
+ *   - from the interrupt being triggered (end to end),
+ *   - from the handler beginning to execute, and
+ *   - from the handler finishing, which is the cost of exiting the interrupt
+ *     and switching to the thread.
+ *
+ * The measurements are repeated under each of the enabled background loads,
+ * which run in lower priority threads while the main thread waits for the
+ * interrupt:
+ *
+ *   - IRQ_LOAD_SPIN: a thread that just spins, keeping caches warm,
+ *   - IRQ_LOAD_MEMORY: a thread streaming through IRQ_THRASH_SIZE bytes to
+ *     evict the caches,
+ *   - IRQ_LOAD_LOCK: a thread locking and unlocking a kernel mutex, whose
+ *     implementation briefly locks out interrupts, and
+ *   - IRQ_LOAD_YIELD: two threads yielding to each other.
+ *
+ * All loads but IRQ_LOAD_MEMORY are enabled if none is selected. The memory
+ * load is only built when selected, as its buffer takes IRQ_THRASH_SIZE
+ * bytes of RAM (16 KB by default, more than the caches of the supported
+ * microcontrollers).
+ *
+ * Each of those samples re-arms the timer IRQ_DELAY_US microseconds ahead.
+ * The test then switches the timer to periodic mode for each period in
+ * IRQ_PERIODS_US and records when the handler runs for IRQ_PERIOD_COUNT
+ * periods under the spinning load. For each period it reports
+ *
+ *   - the time between consecutive handler runs,
+ *   - the jitter, which is how far each of those times is from the period,
+ *   - the drift, which is how far the last handler run is from where the
+ *     nominal period puts it, counting missed expiries as periods, and
+ *   - the number of missed deadlines, which are expiries for which the
+ *     handler did not run (the whole periods since the first handler run,
+ *     less the handler runs since).
+ *
+ * Handler runs are timestamped with the timing counter, which may run from
+ * a different clock than the timer. Any difference in rate shows up as
+ * drift.
  */
 
 #include "bench_api.h"
@@ -13,30 +55,125 @@
 
 #define SEM_ID      0
 
-#define THREAD_LOW  0
+#define MUTEX_ID    0
 
-#define MAIN_THREAD_PRIORITY   (BENCH_LAST_PRIORITY - 3)
+#define THREAD_LOW  0   /* ID of the first load thread */
 
-#define ISR_DELAY  1000     /* Time in microseconds until ISR fires */
+#define MAX_LOAD_THREADS 2
+
+#if !defined(IRQ_LOAD_SPIN) && !defined(IRQ_LOAD_MEMORY) && \
+    !defined(IRQ_LOAD_LOCK) && !defined(IRQ_LOAD_YIELD)
+#define IRQ_LOAD_SPIN    1
+#define IRQ_LOAD_LOCK    1
+#define IRQ_LOAD_YIELD   1
+#endif
+
+#ifndef IRQ_LOAD_SPIN
+#define IRQ_LOAD_SPIN    0
+#endif
+
+#ifndef IRQ_LOAD_MEMORY
+#define IRQ_LOAD_MEMORY  0
+#endif
+
+#ifndef IRQ_LOAD_LOCK
+#define IRQ_LOAD_LOCK    0
+#endif
+
+#ifndef IRQ_LOAD_YIELD
+#define IRQ_LOAD_YIELD   0
+#endif
+
+#ifndef IRQ_THRASH_SIZE
+#define IRQ_THRASH_SIZE  (16 * 1024)
+#endif
+
+#define CACHE_LINE_SIZE  64
+
+/* Time in microseconds until ISR fires */
+#ifndef IRQ_DELAY_US
+#define IRQ_DELAY_US  1000
+#endif
+
+/* Periods in microseconds at which the periodic mode is measured */
+#ifndef IRQ_PERIODS_US
+#define IRQ_PERIODS_US  100, 50, 20
+#endif
+
+#ifndef IRQ_PERIOD_COUNT
+#define IRQ_PERIOD_COUNT  20000
+#endif
+
+#define MAIN_THREAD_PRIORITY   (BENCH_LAST_PRIORITY - 3)
 
 volatile bench_time_t  bench_isr_cycles;
+volatile bench_time_t  bench_isr_exit_cycles;
 volatile bench_time_t  bench_trigger_cycles;
 volatile bench_time_t  diff_cycles;
 
 struct bench_stats latency_times;
+struct bench_stats end_to_end_times;
+struct bench_stats isr_to_thread_times;
+struct bench_stats isr_exit_times;
 
 bench_isr_handler_t  old_timer_isr;
 
 volatile bool valid_measurement = false;
 
+/*
+ * Number of times the timer has been armed, and the value it had when the
+ * handler last finished. They match when the handler for the current
+ * expiry has finished before the woken thread runs.
+ */
+volatile uint32_t timer_armed_count;
+volatile uint32_t isr_exit_count;
+
 static volatile bool run_thread_low = true;
 
+#if IRQ_LOAD_MEMORY
+static volatile uint8_t thrash_buffer[IRQ_THRASH_SIZE];
+#endif
+
+static const uint32_t periods_usec[] = { IRQ_PERIODS_US };
+
+#define NUM_PERIODS  (sizeof(periods_usec) / sizeof(periods_usec[0]))
+
+/* Title of the current period */
+static char periodic_title[64];
+
+static struct bench_stats period_times;
+static struct bench_stats jitter_times;
+
+/* Nominal period in timing counter cycles */
+static bench_time_t periodic_nominal;
+
+/* State of the periodic handler, cleared before each period is measured */
+static volatile bool periodic_running;
+static volatile uint32_t periodic_count;
+static volatile uint32_t periodic_missed;
+static bench_time_t periodic_first;
+static bench_time_t periodic_last;
+
+struct load_profile {
+	const char *title;
+	void (*entry)(void *);
+	int num_threads;
+};
+
 /**
  * @brief Display the interrupt latency stats
  */
 void report_stats(void)
 {
 	bench_stats_report_line("Latency", &latency_times);
+	bench_stats_report_line("Interrupt to thread", &end_to_end_times);
+	bench_stats_report_line("ISR to thread", &isr_to_thread_times);
+
+	if (isr_exit_times.count != 0) {
+		bench_stats_report_line("ISR exit to thread", &isr_exit_times);
+	} else {
+		bench_stats_report_na("ISR exit to thread");
+	}
 }
 
 /**
@@ -57,6 +194,8 @@ __weak void bench_exit_timer_isr(void)
  */
 static void irq_latency_isr(void *arg)
 {
+	uint32_t armed_count = timer_armed_count;
+
 	bench_isr_cycles = bench_timer_cycles_get();
 
 	diff_cycles = bench_timer_cycles_diff(bench_trigger_cycles,
@@ -73,6 +212,60 @@ static void irq_latency_isr(void *arg)
 	 */
 
 	bench_exit_timer_isr();
+
+	bench_isr_exit_cycles = bench_timer_cycles_get();
+	isr_exit_count = armed_count;
+}
+
+/**
+ * @brief Special ISR used to measure periodic timer jitter
+ */
+static void periodic_isr(void *arg)
+{
+	bench_time_t  now = bench_timing_counter_get();
+	bench_time_t  interval;
+	bench_time_t  deviation;
+	bench_time_t  elapsed;
+	bench_time_t  periods;
+	uint32_t  count = periodic_count;
+
+	if (periodic_running && (count <= IRQ_PERIOD_COUNT)) {
+		if (count == 0) {
+			periodic_first = now;
+		} else {
+			interval = bench_timing_cycles_get(&periodic_last, &now);
+			deviation = (interval > periodic_nominal) ?
+				    interval - periodic_nominal :
+				    periodic_nominal - interval;
+
+			bench_stats_update_raw(&period_times, interval, count);
+			bench_stats_update_raw(&jitter_times, deviation, count);
+
+			/*
+			 * Count the whole periods since the first run. Periods
+			 * beyond one per run were missed. A run that is late
+			 * by less than a period, or that catches up after a
+			 * late one, misses none.
+			 */
+
+			elapsed = bench_timing_cycles_get(&periodic_first, &now);
+			periods = elapsed / periodic_nominal;
+			if (periods > count + periodic_missed) {
+				periodic_missed = (uint32_t)(periods - count);
+			}
+
+			if (count == IRQ_PERIOD_COUNT) {
+				bench_sem_give_from_isr(SEM_ID);
+			}
+		}
+
+		periodic_last = now;
+		periodic_count = count + 1;
+	}
+
+	bench_exit_timer_isr();
+
+	bench_timer_isr_periodic_ack();
 }
 
 /**
@@ -82,11 +275,25 @@ static void irq_latency_isr(void *arg)
  */
 bool gather_irq_latency_stats(uint32_t  i)
 {
+	bench_time_t  thread_cycles;
+	bench_time_t  end_to_end_cycles;
+	bench_time_t  isr_to_thread_cycles;
+	bench_time_t  isr_exit_cycles;
+
 	valid_measurement = false;
+	timer_armed_count++;
 
-	bench_trigger_cycles = bench_timer_isr_expiry_set(ISR_DELAY);
+	bench_trigger_cycles = bench_timer_isr_expiry_set(IRQ_DELAY_US);
 
 	bench_sem_take(SEM_ID);
+	thread_cycles = bench_timer_cycles_get();
+
+	end_to_end_cycles = bench_timer_cycles_diff(bench_trigger_cycles,
+						    thread_cycles);
+	isr_to_thread_cycles = bench_timer_cycles_diff(bench_isr_cycles,
+						       thread_cycles);
+	isr_exit_cycles = bench_timer_cycles_diff(bench_isr_exit_cycles,
+						  thread_cycles);
 
 	/*
 	 * Since we are dealing with timer interrupts and cycle register reads,
@@ -96,8 +303,27 @@ bool gather_irq_latency_stats(uint32_t  i)
 	 * Thus we only deal with clearly valid measurements.
 	 */
 
+	valid_measurement = valid_measurement &&
+			    ((int)end_to_end_cycles >= 0) &&
+			    ((int)isr_to_thread_cycles >= 0);
+
 	if (valid_measurement) {
-		bench_stats_update(&latency_times, diff_cycles, i);
+		bench_stats_update_raw(&latency_times, diff_cycles, i);
+		bench_stats_update_raw(&end_to_end_times, end_to_end_cycles, i);
+		bench_stats_update_raw(&isr_to_thread_times,
+				       isr_to_thread_cycles, i);
+
+		/*
+		 * Where giving the semaphore switches to the thread at once,
+		 * the handler has not finished yet and its exit cannot be
+		 * measured.
+		 */
+
+		if ((isr_exit_count == timer_armed_count) &&
+		    ((int)isr_exit_cycles >= 0)) {
+			bench_stats_update_raw(&isr_exit_times, isr_exit_cycles,
+					       isr_exit_times.count + 1);
+		}
 	}
 
 	return valid_measurement;
@@ -121,23 +347,100 @@ static void bench_thread_low(void *args)
 	bench_thread_exit();
 }
 
+#if IRQ_LOAD_MEMORY
 /**
- * @brief Test setup function
+ * @brief A low priority thread that streams through memory
+ *
+ * Every cache line of the buffer is written in turn, so the caches hold
+ * little besides the buffer when the interrupt arrives.
  */
-void bench_interrupt_latency_test(void *arg)
+static void bench_thread_memory(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	while (run_thread_low) {
+		for (i = 0; i < IRQ_THRASH_SIZE; i += CACHE_LINE_SIZE) {
+			thrash_buffer[i]++;
+		}
+	}
+
+	bench_thread_exit();
+}
+#endif
+
+#if IRQ_LOAD_LOCK
+/**
+ * @brief A low priority thread that locks and unlocks a kernel mutex
+ */
+static void bench_thread_lock(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (run_thread_low) {
+		bench_mutex_lock(MUTEX_ID);
+		bench_mutex_unlock(MUTEX_ID);
+	}
+
+	bench_thread_exit();
+}
+#endif
+
+#if IRQ_LOAD_YIELD
+/**
+ * @brief A low priority thread that yields to its peer
+ */
+static void bench_thread_yield_load(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (run_thread_low) {
+		bench_yield();
+	}
+
+	bench_thread_exit();
+}
+#endif
+
+static const struct load_profile load_profiles[] = {
+#if IRQ_LOAD_SPIN
+	{ "Interrupt Stats", bench_thread_low, 1 },
+#endif
+#if IRQ_LOAD_MEMORY
+	{ "Interrupt Stats (memory load)", bench_thread_memory, 1 },
+#endif
+#if IRQ_LOAD_LOCK
+	{ "Interrupt Stats (lock load)", bench_thread_lock, 1 },
+#endif
+#if IRQ_LOAD_YIELD
+	{ "Interrupt Stats (yield load)", bench_thread_yield_load, 2 },
+#endif
+};
+
+#define NUM_LOAD_PROFILES  (sizeof(load_profiles) / sizeof(load_profiles[0]))
+
+/**
+ * @brief Gather and report the interrupt stats under one background load
+ */
+static void gather_profile_stats(const struct load_profile *profile)
 {
 	uint32_t  i;
+	int  t;
 
 	bench_stats_reset(&latency_times);
-	bench_stats_report_title("Interrupt Stats");
+	bench_stats_reset(&end_to_end_times);
+	bench_stats_reset(&isr_to_thread_times);
+	bench_stats_reset(&isr_exit_times);
 
-	bench_sem_create(SEM_ID, 0, 1);
+	run_thread_low = true;
 
-	bench_thread_set_priority(MAIN_THREAD_PRIORITY);
-
-	bench_thread_create(THREAD_LOW, "thread_low",
-			    MAIN_THREAD_PRIORITY + 1, bench_thread_low, NULL);
-	bench_thread_start(THREAD_LOW);
+	for (t = 0; t < profile->num_threads; t++) {
+		bench_thread_create(THREAD_LOW + t, "thread_low",
+				    MAIN_THREAD_PRIORITY + 1, profile->entry,
+				    NULL);
+		bench_thread_start(THREAD_LOW + t);
+	}
 
 	/*
 	 * Align to a tick boundary to eliminate likelihood of a system tick
@@ -169,15 +472,150 @@ void bench_interrupt_latency_test(void *arg)
 
 	/*
 	 * Lower the priority of the main thread to allow the low priority
-	 * thread to finish and then restore the priority of the main thread.
+	 * threads to finish and then restore the priority of the main thread.
 	 */
 
 	bench_thread_set_priority(MAIN_THREAD_PRIORITY + 2);
 	bench_thread_set_priority(MAIN_THREAD_PRIORITY);
 
+	bench_collect_resources();
+
+	bench_stats_report_title(profile->title);
 	report_stats();
 }
 
+/**
+ * @brief Report the drift of the periodic timer
+ *
+ * The drift is reported as a magnitude under a label giving its direction,
+ * with the other direction reported as zero.
+ */
+static void report_drift(void)
+{
+	bench_time_t  actual;
+	bench_time_t  expected;
+	bench_time_t  late = 0;
+	bench_time_t  early = 0;
+
+	actual = bench_timing_cycles_get(&periodic_first, &periodic_last);
+	expected = periodic_nominal * (IRQ_PERIOD_COUNT + periodic_missed);
+
+	if (actual >= expected) {
+		late = bench_timing_cycles_to_ns(actual - expected);
+	} else {
+		early = bench_timing_cycles_to_ns(expected - actual);
+	}
+
+	bench_stats_report_value("Drift (late)", late, "ns");
+	bench_stats_report_value("Drift (early)", early, "ns");
+}
+
+/**
+ * @brief Gather and report the periodic timer stats for one period
+ */
+static void gather_periodic_stats(uint32_t usec)
+{
+	uint64_t  ns_per_mcycle;
+	bool  supported;
+
+	bench_stats_reset(&period_times);
+	bench_stats_reset(&jitter_times);
+
+	periodic_running = false;
+	periodic_count = 0;
+	periodic_missed = 0;
+
+	/* The timing counter may count at a rate other than the timer's */
+
+	ns_per_mcycle = bench_timing_cycles_to_ns(1000000);
+	periodic_nominal = (ns_per_mcycle != 0) ?
+			   ((uint64_t)usec * 1000000000ULL / ns_per_mcycle) : 0;
+
+	run_thread_low = true;
+
+	bench_thread_create(THREAD_LOW, "thread_low", MAIN_THREAD_PRIORITY + 1,
+			    bench_thread_low, NULL);
+	bench_thread_start(THREAD_LOW);
+
+	bench_sync_ticks();
+
+	old_timer_isr = bench_timer_isr_get();
+	bench_timer_isr_set(periodic_isr);
+
+	bench_sync_ticks();
+
+	/*
+	 * The timer only fires for the system tick until the periodic mode
+	 * is set, which also postpones its first expiry by a full period.
+	 */
+
+	supported = (periodic_nominal != 0) &&
+		    (bench_timer_isr_periodic_set(usec) == BENCH_SUCCESS);
+	if (supported) {
+		periodic_running = true;
+		bench_sem_take(SEM_ID);
+	}
+
+	bench_timer_isr_restore(old_timer_isr);
+
+	periodic_running = false;
+	run_thread_low = false;
+
+	bench_thread_set_priority(MAIN_THREAD_PRIORITY + 2);
+	bench_thread_set_priority(MAIN_THREAD_PRIORITY);
+
+	bench_collect_resources();
+
+	snprintf(periodic_title, sizeof(periodic_title),
+		 "Periodic Interrupt Stats (%u us)", (unsigned int)usec);
+	bench_stats_report_title(periodic_title);
+
+	if (!supported) {
+		bench_stats_report_na("Period");
+		bench_stats_report_na("Jitter");
+		bench_stats_report_na("Drift (late)");
+		bench_stats_report_na("Drift (early)");
+		bench_stats_report_na("Missed deadlines");
+		return;
+	}
+
+	bench_stats_report_line("Period", &period_times);
+	bench_stats_report_line("Jitter", &jitter_times);
+	report_drift();
+	bench_stats_report_value("Missed deadlines", periodic_missed,
+				 "periods");
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_interrupt_latency_test(void *arg)
+{
+	uint32_t  i;
+
+	bench_sem_create(SEM_ID, 0, 1);
+	bench_mutex_create(MUTEX_ID);
+
+	bench_thread_set_priority(MAIN_THREAD_PRIORITY);
+
+	for (i = 0; i < NUM_LOAD_PROFILES; i++) {
+		gather_profile_stats(&load_profiles[i]);
+	}
+
+	/* Periodic handler runs are timestamped with the timing counter */
+
+	bench_timing_init();
+	bench_timing_start();
+
+	for (i = 0; i < NUM_PERIODS; i++) {
+		gather_periodic_stats(periods_usec[i]);
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
 #ifdef RUN_INTERRUPT_LATENCY
 int main(void)
 {
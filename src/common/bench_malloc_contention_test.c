@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure heap contention between threads
+ *
+ * This file contains the test in which 1, 2, 4 and 8 worker threads call
+ * bench_malloc() and bench_free() in a loop for a window of
+ * MALLOC_WINDOW_MS milliseconds. For each number of workers it reports
+ *
+ *   - the aggregate number of malloc/free pairs per second, and
+ *   - the malloc and free times of all workers.
+ *
+ * On SMP systems worker n is pinned to CPU n modulo the number of CPUs, so
+ * the workers contend for the heap lock from different CPUs. On a
+ * uniprocessor the workers only interleave if the RTOS time-slices them.
+ *
+ * Each worker collects its samples in a small local batch and records the
+ * batch into the shared stats under a mutex, outside the timed region.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#ifndef MALLOC_WINDOW_MS
+#define MALLOC_WINDOW_MS  1000
+#endif
+
+#define MAIN_PRIORITY    (BENCH_LAST_PRIORITY - 3)
+#define WORKER_PRIORITY  (MAIN_PRIORITY + 1)
+
+#define MAX_WORKERS      8
+
+#define THREAD_WORKER    1   /* ID of the first worker thread */
+
+#define SEM_START        0
+#define SEM_DONE         1
+
+#define MUTEX_ID         0
+
+#define TEST_SIZE        128
+#define BATCH_SIZE       32
+
+#define NSEC_PER_SEC     1000000000ULL
+#define NSEC_PER_MSEC    1000000ULL
+
+static const char *throughput_strings[] = {
+	"Throughput (1 thread)",
+	"Throughput (2 threads)",
+	"Throughput (4 threads)",
+	"Throughput (8 threads)",
+};
+
+static const char *malloc_strings[] = {
+	"Malloc (1 thread)",
+	"Malloc (2 threads)",
+	"Malloc (4 threads)",
+	"Malloc (8 threads)",
+};
+
+static const char *free_strings[] = {
+	"Free (1 thread)",
+	"Free (2 threads)",
+	"Free (4 threads)",
+	"Free (8 threads)",
+};
+
+#define NUM_LEVELS  (sizeof(throughput_strings) / sizeof(throughput_strings[0]))
+
+static bench_time_t timestamp_window_start;
+
+/* Per-worker batches of samples not yet recorded */
+static bench_time_t malloc_batches[MAX_WORKERS][BATCH_SIZE];
+static bench_time_t free_batches[MAX_WORKERS][BATCH_SIZE];
+static bool malloc_ticked[MAX_WORKERS][BATCH_SIZE];
+static bool free_ticked[MAX_WORKERS][BATCH_SIZE];
+
+/* Protected by the mutex */
+static uint32_t operations;
+static struct bench_stats malloc_times;
+static struct bench_stats free_times;
+
+/**
+ * @brief Record the first @a count samples of a worker's batches
+ */
+static void batch_record(int worker, uint32_t count)
+{
+	uint32_t i;
+
+	bench_mutex_lock(MUTEX_ID);
+
+	for (i = 0; i < count; i++) {
+		operations++;
+		bench_stats_update_cycles(&malloc_times,
+					  malloc_batches[worker][i], operations,
+					  malloc_ticked[worker][i]);
+		bench_stats_update_cycles(&free_times, free_batches[worker][i],
+					  operations, free_ticked[worker][i]);
+	}
+
+	bench_mutex_unlock(MUTEX_ID);
+}
+
+/**
+ * @brief Worker thread that hammers the heap
+ *
+ * @param args Index of the worker
+ */
+static void bench_malloc_contention_worker(void *args)
+{
+	int worker = (int)(uintptr_t)args;
+	bench_time_t window_start;
+	bench_time_t now;
+	struct bench_stamp start;
+	struct bench_stamp mid;
+	struct bench_stamp end;
+	uint32_t count = 0;
+	void *p;
+
+	bench_sem_take(SEM_START);
+
+	for (;;) {
+		window_start = timestamp_window_start;
+		now = bench_timing_counter_get();
+		if (bench_timing_cycles_to_ns(bench_timing_cycles_get(&window_start,
+								      &now)) >=
+		    MALLOC_WINDOW_MS * NSEC_PER_MSEC) {
+			break;
+		}
+
+		start = bench_stamp_get();
+		p = bench_malloc(TEST_SIZE);
+		mid = bench_stamp_get();
+		bench_free(p);
+		end = bench_stamp_get();
+
+		malloc_batches[worker][count] = bench_stamp_cycles(&start, &mid);
+		free_batches[worker][count] = bench_stamp_cycles(&mid, &end);
+		malloc_ticked[worker][count] = bench_stamp_ticked(&start, &mid);
+		free_ticked[worker][count] = bench_stamp_ticked(&mid, &end);
+
+		if (++count == BATCH_SIZE) {
+			batch_record(worker, count);
+			count = 0;
+		}
+	}
+
+	batch_record(worker, count);
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Run @a num_workers workers for one window and report the results
+ */
+static void gather_contention_stats(uint32_t level, int num_workers)
+{
+	int cpus = bench_cpu_count();
+	bench_time_t end;
+	uint64_t elapsed_ns;
+	int i;
+
+	bench_stats_reset(&malloc_times);
+	bench_stats_reset(&free_times);
+	operations = 0;
+
+	/*
+	 * The workers have a lower priority than this thread. They are
+	 * released once this thread blocks waiting for them to finish.
+	 */
+
+	for (i = 0; i < num_workers; i++) {
+		if (cpus > 1) {
+			bench_thread_cpu_set(THREAD_WORKER + i, i % cpus);
+		}
+
+		bench_thread_create(THREAD_WORKER + i, "malloc_worker",
+				    WORKER_PRIORITY,
+				    bench_malloc_contention_worker,
+				    (void *)(uintptr_t)i);
+		bench_thread_start(THREAD_WORKER + i);
+	}
+
+	timestamp_window_start = bench_timing_counter_get();
+
+	for (i = 0; i < num_workers; i++) {
+		bench_sem_give(SEM_START);
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		bench_sem_take(SEM_DONE);
+	}
+
+	end = bench_timing_counter_get();
+	elapsed_ns = bench_timing_cycles_to_ns(
+		bench_timing_cycles_get(&timestamp_window_start, &end));
+
+	bench_collect_resources();
+
+	bench_stats_report_value(throughput_strings[level],
+				 (elapsed_ns != 0) ?
+				 (operations * NSEC_PER_SEC / elapsed_ns) : 0,
+				 "ops/s");
+	bench_stats_report_line(malloc_strings[level], &malloc_times);
+	bench_stats_report_line(free_strings[level], &free_times);
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_malloc_contention_init(void *arg)
+{
+	uint32_t level;
+	int num_workers;
+	void *p;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Malloc contention stats");
+
+	/* Not every port provides a heap */
+
+	p = bench_malloc(TEST_SIZE);
+	if (p == NULL) {
+		for (level = 0; level < NUM_LEVELS; level++) {
+			bench_stats_report_na(throughput_strings[level]);
+			bench_stats_report_na(malloc_strings[level]);
+			bench_stats_report_na(free_strings[level]);
+		}
+
+		bench_timing_stop();
+		return;
+	}
+	bench_free(p);
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_sem_create(SEM_START, 0, MAX_WORKERS);
+	bench_sem_create(SEM_DONE, 0, MAX_WORKERS);
+	bench_mutex_create(MUTEX_ID);
+
+	for (level = 0, num_workers = 1; level < NUM_LEVELS;
+	     level++, num_workers *= 2) {
+		gather_contention_stats(level, num_workers);
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_MALLOC_CONTENTION
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_malloc_contention_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
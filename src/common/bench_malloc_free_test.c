@@ -5,6 +5,13 @@
  *
  * This test module measures the system usage of
  * malloc and free usage time.
+ *
+ * It then replays a deterministic pseudo-random trace that keeps
+ * MALLOC_LIVE_BLOCKS blocks of 8 B to 4 KB live at once. Each step frees one
+ * live block and allocates a new one in its place. Most steps replace one
+ * of a few short-lived blocks, so the remaining blocks live much longer and
+ * pin the heap as it fragments. The trace reports alloc and free times for
+ * each quarter of the run, the worst alloc time, and the peak heap usage.
  */
 
 #include "bench_api.h"
@@ -12,9 +19,50 @@
 
 #define TEST_SIZE 128
 
+#ifndef MALLOC_LIVE_BLOCKS
+#define MALLOC_LIVE_BLOCKS 8
+#endif
+
+#if MALLOC_LIVE_BLOCKS < 1
+#error "MALLOC_LIVE_BLOCKS must be at least 1"
+#endif
+
+#define TRACE_SEED         0x2545f491u
+#define TRACE_PHASES       4
+
+/* Blocks that are replaced by most steps of the trace */
+#define TRACE_SHORT_LIVED  ((MALLOC_LIVE_BLOCKS + 3) / 4)
+
 static struct bench_stats time_to_malloc;  /* time to malloc*/
 static struct bench_stats time_to_free;    /* time to free */
 
+static const char *trace_alloc_strings[TRACE_PHASES] = {
+	"Trace malloc (1st quarter)",
+	"Trace malloc (2nd quarter)",
+	"Trace malloc (3rd quarter)",
+	"Trace malloc (4th quarter)",
+};
+
+static const char *trace_free_strings[TRACE_PHASES] = {
+	"Trace free (1st quarter)",
+	"Trace free (2nd quarter)",
+	"Trace free (3rd quarter)",
+	"Trace free (4th quarter)",
+};
+
+static struct bench_stats trace_malloc_times[TRACE_PHASES];
+static struct bench_stats trace_free_times[TRACE_PHASES];
+
+static void *live_blocks[MALLOC_LIVE_BLOCKS];
+static size_t live_sizes[MALLOC_LIVE_BLOCKS];
+
+static uint32_t trace_state;
+static size_t live_bytes;
+static size_t peak_live_bytes;
+static size_t peak_heap_bytes;
+static bool heap_usage_known;
+static uint32_t failed_allocs;
+
 /**
  * @brief Reset time statistics
  */
@@ -29,23 +77,217 @@ static void reset_time_stats(void)
  */
 static void gather_set1_stats(uint32_t iteration)
 {
-	bench_time_t start;
-	bench_time_t mid;
-	bench_time_t end;
+	struct bench_stamp start;
+	struct bench_stamp mid;
+	struct bench_stamp end;
 	void *p;
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	p = bench_malloc(TEST_SIZE);
-	mid = bench_timing_counter_get();
+	mid = bench_stamp_get();
 	bench_free(p);
-	end = bench_timing_counter_get();
-
-	bench_stats_update(&time_to_malloc,
-				bench_timing_cycles_get(&start, &mid),
-				iteration);
-	bench_stats_update(&time_to_free,
-				bench_timing_cycles_get(&mid,&end),
-				iteration);
+	end = bench_stamp_get();
+
+	bench_stats_update(&time_to_malloc, &start, &mid, iteration);
+	bench_stats_update(&time_to_free, &mid, &end, iteration);
+}
+
+/**
+ * @brief Get the next value of the trace (xorshift32)
+ */
+static uint32_t trace_next(void)
+{
+	trace_state ^= trace_state << 13;
+	trace_state ^= trace_state >> 17;
+	trace_state ^= trace_state << 5;
+
+	return trace_state;
+}
+
+/**
+ * @brief Get the size of the next block of the trace
+ *
+ * Sizes are spread evenly over the powers of two from 8 B to 2 KB, and
+ * uniformly within each, giving 8 B to 4 KB - 1.
+ */
+static size_t trace_size_get(void)
+{
+	uint32_t r = trace_next();
+	size_t base = (size_t)8 << (r % 9);
+
+	return base + (r >> 8) % base;
+}
+
+/**
+ * @brief Get the slot whose block is replaced by the next step of the trace
+ */
+static uint32_t trace_slot_get(void)
+{
+	uint32_t r = trace_next();
+
+	if ((r & 3) != 0) {
+		return (r >> 2) % TRACE_SHORT_LIVED;
+	}
+
+	return (r >> 2) % MALLOC_LIVE_BLOCKS;
+}
+
+/**
+ * @brief Track the peak heap usage after an allocation
+ */
+static void trace_usage_update(void)
+{
+	size_t used;
+
+	if (live_bytes > peak_live_bytes) {
+		peak_live_bytes = live_bytes;
+	}
+
+	if (bench_heap_usage_get(&used) == BENCH_SUCCESS) {
+		heap_usage_known = true;
+		if (used > peak_heap_bytes) {
+			peak_heap_bytes = used;
+		}
+	}
+}
+
+/**
+ * @brief Allocate a block of the trace into @a slot
+ *
+ * The time taken by bench_malloc() is added to @a stats unless it is NULL.
+ */
+static void trace_malloc(uint32_t slot, struct bench_stats *stats,
+			 uint32_t iteration)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	size_t size = trace_size_get();
+
+	start = bench_stamp_get();
+	live_blocks[slot] = bench_malloc(size);
+	end = bench_stamp_get();
+
+	if (live_blocks[slot] != NULL) {
+		live_sizes[slot] = size;
+		live_bytes += size;
+		trace_usage_update();
+	} else {
+		live_sizes[slot] = 0;
+		failed_allocs++;
+	}
+
+	if (stats != NULL) {
+		bench_stats_update(stats, &start, &end, iteration);
+	}
+}
+
+/**
+ * @brief Free the block of the trace in @a slot
+ *
+ * The time taken by bench_free() is added to @a stats unless it is NULL.
+ */
+static void trace_free(uint32_t slot, struct bench_stats *stats,
+		       uint32_t iteration)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+
+	start = bench_stamp_get();
+	bench_free(live_blocks[slot]);
+	end = bench_stamp_get();
+
+	live_bytes -= live_sizes[slot];
+	live_blocks[slot] = NULL;
+	live_sizes[slot] = 0;
+
+	if (stats != NULL) {
+		bench_stats_update(stats, &start, &end, iteration);
+	}
+}
+
+/**
+ * @brief Replay the trace and gather its stats
+ */
+static void gather_trace_stats(void)
+{
+	uint32_t counts[TRACE_PHASES] = { 0 };
+	uint32_t phase;
+	uint32_t slot;
+	uint32_t i;
+
+	trace_state = TRACE_SEED;
+	live_bytes = 0;
+	peak_live_bytes = 0;
+	peak_heap_bytes = 0;
+	heap_usage_known = false;
+	failed_allocs = 0;
+
+	for (phase = 0; phase < TRACE_PHASES; phase++) {
+		bench_stats_reset(&trace_malloc_times[phase]);
+		bench_stats_reset(&trace_free_times[phase]);
+	}
+
+	for (slot = 0; slot < MALLOC_LIVE_BLOCKS; slot++) {
+		trace_malloc(slot, NULL, 0);
+	}
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		phase = (uint32_t)(((uint64_t)(i - 1) * TRACE_PHASES) /
+				   ITERATIONS);
+		counts[phase]++;
+
+		slot = trace_slot_get();
+
+		if (live_blocks[slot] != NULL) {
+			trace_free(slot, &trace_free_times[phase],
+				   counts[phase]);
+		}
+
+		trace_malloc(slot, &trace_malloc_times[phase], counts[phase]);
+	}
+
+	for (slot = 0; slot < MALLOC_LIVE_BLOCKS; slot++) {
+		if (live_blocks[slot] != NULL) {
+			trace_free(slot, NULL, 0);
+		}
+	}
+}
+
+/**
+ * @brief Report the stats of the trace
+ */
+static void report_trace_stats(void)
+{
+	bench_time_t worst = 0;
+	uint32_t phase;
+
+	for (phase = 0; phase < TRACE_PHASES; phase++) {
+		bench_stats_report_line(trace_alloc_strings[phase],
+					&trace_malloc_times[phase]);
+		if (trace_malloc_times[phase].max > worst) {
+			worst = trace_malloc_times[phase].max;
+		}
+	}
+
+	for (phase = 0; phase < TRACE_PHASES; phase++) {
+		bench_stats_report_line(trace_free_strings[phase],
+					&trace_free_times[phase]);
+	}
+
+	bench_stats_report_value("Trace worst malloc",
+				 bench_timing_cycles_to_ns(worst), "ns");
+	bench_stats_report_value("Trace failed mallocs", failed_allocs,
+				 "allocs");
+	bench_stats_report_value("Trace peak live bytes", peak_live_bytes, "B");
+
+	if (heap_usage_known) {
+		bench_stats_report_value("Trace peak heap usage", peak_heap_bytes,
+					 "B");
+	} else {
+		bench_stats_report_na("Trace peak heap usage");
+	}
 }
 
 /**
@@ -54,6 +296,7 @@ static void gather_set1_stats(uint32_t iteration)
 void bench_malloc_free(void *arg)
 {
 	uint32_t i;
+	void *p;
 
 	bench_timing_init();
 	reset_time_stats();
@@ -62,12 +305,37 @@ void bench_malloc_free(void *arg)
 	bench_timing_start();
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_set1_stats(i);
 	}
 
 	bench_stats_report_line("Malloc", &time_to_malloc);
 	bench_stats_report_line("Free", &time_to_free);
 
+	bench_stats_report_title("Heap fragmentation stats");
+
+	/* Not every port provides a heap */
+
+	p = bench_malloc(TEST_SIZE);
+	if (p != NULL) {
+		bench_free(p);
+		gather_trace_stats();
+		report_trace_stats();
+	} else {
+		for (i = 0; i < TRACE_PHASES; i++) {
+			bench_stats_report_na(trace_alloc_strings[i]);
+		}
+		for (i = 0; i < TRACE_PHASES; i++) {
+			bench_stats_report_na(trace_free_strings[i]);
+		}
+		bench_stats_report_na("Trace worst malloc");
+		bench_stats_report_na("Trace failed mallocs");
+		bench_stats_report_na("Trace peak live bytes");
+		bench_stats_report_na("Trace peak heap usage");
+	}
+
+	bench_stats_report_runtime();
+
 	bench_timing_stop();
 }
 
@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure message queue performance across message sizes and depths
+ *
+ * This file contains the test that sweeps the message length and the queue
+ * depth. For each combination it measures
+ *
+ *   - send and receive times without a context switch, filling the queue
+ *     to its depth and then draining it,
+ *   - send and receive times with a context switch to a higher priority
+ *     thread that is waiting on an empty (or full) queue, and
+ *   - the throughput in bytes per second of both patterns. Throughput is
+ *     measured in separate passes that do not time the individual
+ *     operations.
+ *
+ * Combinations larger than BENCH_MQ_MAX_SIZE bytes (4 KB by default on MCU
+ * ports, 32 KB on POSIX) report n/a.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#if RTOS_HAS_MESSAGE_QUEUE
+
+#define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
+#define MQ_NAME       "bench_message_queue_sweep"
+#define MQ_ID         0
+
+#define THREAD_HIGH   1
+
+#define NSEC_PER_SEC  1000000000ULL
+
+/* Message lengths (in bytes) and queue depths that are swept */
+static const uint32_t msg_lengths[] = { 16, 128, 512 };
+static const uint32_t queue_depths[] = { 8, 64 };
+
+#define NUM_LENGTHS (sizeof(msg_lengths) / sizeof(msg_lengths[0]))
+#define NUM_DEPTHS  (sizeof(queue_depths) / sizeof(queue_depths[0]))
+
+#define MAX_MSG_LEN 512
+
+static char msg_send_buf[MAX_MSG_LEN];
+static char msg_rcv_buf[MAX_MSG_LEN];
+
+/* Title of the current combination */
+static char title[64];
+
+static uint32_t msg_len;
+static uint32_t msg_num;
+
+static volatile struct bench_stamp timestamp_end;
+
+static struct bench_stats send_times;
+static struct bench_stats receive_times;
+
+/**
+ * @brief Get the throughput of moving @a bytes in @a cycles
+ *
+ * @return Throughput in bytes per second
+ */
+static uint64_t throughput_get(uint64_t bytes, bench_time_t cycles)
+{
+	bench_time_t ns = bench_timing_cycles_to_ns(cycles);
+
+	return (ns != 0) ? (bytes * NSEC_PER_SEC / ns) : 0;
+}
+
+/**
+ * @brief Gather stats for filling and draining the queue
+ */
+static void gather_no_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t iteration = 0;
+	uint32_t i;
+
+	while (iteration < ITERATIONS) {
+		for (i = 0; i < msg_num; i++) {
+			start = bench_stamp_get();
+			bench_message_queue_send(MQ_ID, msg_send_buf, msg_len);
+			end = bench_stamp_get();
+
+			bench_stats_update(&send_times,
+					   &start, &end, iteration + i + 1);
+		}
+
+		for (i = 0; i < msg_num; i++) {
+			start = bench_stamp_get();
+			bench_message_queue_receive(MQ_ID, msg_rcv_buf, msg_len);
+			end = bench_stamp_get();
+
+			bench_stats_update(&receive_times,
+					   &start, &end, iteration + i + 1);
+		}
+
+		iteration += msg_num;
+	}
+}
+
+/**
+ * @brief Get the throughput of filling and draining the queue
+ *
+ * @return Throughput in bytes per second
+ */
+static uint64_t no_switch_throughput_get(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t iteration;
+	uint32_t i;
+
+	start = bench_stamp_get();
+
+	for (iteration = 0; iteration < ITERATIONS; iteration += msg_num) {
+		for (i = 0; i < msg_num; i++) {
+			bench_message_queue_send(MQ_ID, msg_send_buf, msg_len);
+		}
+
+		for (i = 0; i < msg_num; i++) {
+			bench_message_queue_receive(MQ_ID, msg_rcv_buf, msg_len);
+		}
+	}
+
+	end = bench_stamp_get();
+
+	return throughput_get((uint64_t)iteration * msg_len,
+			      bench_stamp_cycles(&start, &end));
+}
+
+/**
+ * @brief High priority thread that receives ITERATIONS messages
+ */
+static void bench_mq_sweep_receiver(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_message_queue_receive(MQ_ID, msg_rcv_buf, msg_len);
+		timestamp_end = bench_stamp_get();
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief High priority thread that sends ITERATIONS messages
+ */
+static void bench_mq_sweep_sender(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_message_queue_send(MQ_ID, msg_send_buf, msg_len);
+		timestamp_end = bench_stamp_get();
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather stats for sending to a waiting higher priority thread
+ *
+ * The receiver blocks on the empty queue and preempts the sender as soon
+ * as a message is sent.
+ */
+static void gather_send_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	bench_thread_create(THREAD_HIGH, "mq_receiver", MAIN_PRIORITY - 1,
+			    bench_mq_sweep_receiver, NULL);
+	bench_thread_start(THREAD_HIGH);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_message_queue_send(MQ_ID, msg_send_buf, msg_len);
+		end = timestamp_end;
+
+		bench_stats_update(&send_times, &start, &end, i);
+	}
+
+	bench_collect_resources();
+}
+
+/**
+ * @brief Gather stats for receiving from a waiting higher priority thread
+ *
+ * The queue is kept full, so the sender blocks until a message is received
+ * and then preempts the receiver.
+ */
+static void gather_receive_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	for (i = 0; i < msg_num; i++) {
+		bench_message_queue_send(MQ_ID, msg_send_buf, msg_len);
+	}
+
+	bench_thread_create(THREAD_HIGH, "mq_sender", MAIN_PRIORITY - 1,
+			    bench_mq_sweep_sender, NULL);
+	bench_thread_start(THREAD_HIGH);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_message_queue_receive(MQ_ID, msg_rcv_buf, msg_len);
+		end = timestamp_end;
+
+		bench_stats_update(&receive_times, &start, &end, i);
+	}
+
+	bench_collect_resources();
+
+	for (i = 0; i < msg_num; i++) {
+		bench_message_queue_receive(MQ_ID, msg_rcv_buf, msg_len);
+	}
+}
+
+/**
+ * @brief Get the throughput of sending to a waiting higher priority thread
+ *
+ * @return Throughput in bytes per second
+ */
+static uint64_t switch_throughput_get(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	bench_thread_create(THREAD_HIGH, "mq_receiver", MAIN_PRIORITY - 1,
+			    bench_mq_sweep_receiver, NULL);
+	bench_thread_start(THREAD_HIGH);
+
+	start = bench_stamp_get();
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_message_queue_send(MQ_ID, msg_send_buf, msg_len);
+	}
+
+	end = timestamp_end;
+
+	bench_collect_resources();
+
+	return throughput_get((uint64_t)ITERATIONS * msg_len,
+			      bench_stamp_cycles(&start, &end));
+}
+
+/**
+ * @brief Measure and report one message length and queue depth
+ */
+static void gather_sweep_stats(uint32_t length, uint32_t depth)
+{
+	msg_len = length;
+	msg_num = depth;
+
+	snprintf(title, sizeof(title), "Message queue %u B x %u stats",
+		 (unsigned int)length, (unsigned int)depth);
+	bench_stats_report_title(title);
+
+	if ((length > MAX_MSG_LEN) || (depth > BENCH_MQ_MAX_MSG_NUM) ||
+	    (length * depth > BENCH_MQ_MAX_SIZE) ||
+	    (bench_message_queue_create(MQ_ID, MQ_NAME, msg_num,
+					msg_len) != BENCH_SUCCESS)) {
+		bench_stats_report_na("Send (no context switch)");
+		bench_stats_report_na("Receive (no context switch)");
+		bench_stats_report_na("Throughput (no context switch)");
+		bench_stats_report_na("Send (context switch)");
+		bench_stats_report_na("Receive (context switch)");
+		bench_stats_report_na("Throughput (context switch)");
+		return;
+	}
+
+	bench_stats_reset(&send_times);
+	bench_stats_reset(&receive_times);
+
+	gather_no_switch_stats();
+
+	bench_stats_report_line("Send (no context switch)", &send_times);
+	bench_stats_report_line("Receive (no context switch)", &receive_times);
+	bench_stats_report_value("Throughput (no context switch)",
+				 no_switch_throughput_get(), "B/s");
+
+	bench_stats_reset(&send_times);
+	bench_stats_reset(&receive_times);
+
+	gather_send_switch_stats();
+	gather_receive_switch_stats();
+
+	bench_stats_report_line("Send (context switch)", &send_times);
+	bench_stats_report_line("Receive (context switch)", &receive_times);
+	bench_stats_report_value("Throughput (context switch)",
+				 switch_throughput_get(), "B/s");
+
+	bench_message_queue_delete(MQ_ID, MQ_NAME);
+}
+
+#endif /* RTOS_HAS_MESSAGE_QUEUE */
+
+/**
+ * @brief Test setup function
+ */
+void bench_message_queue_sweep_init(void *arg)
+{
+#if RTOS_HAS_MESSAGE_QUEUE
+	uint32_t i;
+	uint32_t j;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	for (i = 0; i < sizeof(msg_send_buf); i++) {
+		msg_send_buf[i] = (char)i;
+	}
+
+	for (i = 0; i < NUM_LENGTHS; i++) {
+		for (j = 0; j < NUM_DEPTHS; j++) {
+			gather_sweep_stats(msg_lengths[i], queue_depths[j]);
+		}
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+#else
+	bench_stats_report_title("Message queue sweep stats");
+
+	bench_stats_report_na("Send (no context switch)");
+	bench_stats_report_na("Receive (no context switch)");
+	bench_stats_report_na("Throughput (no context switch)");
+	bench_stats_report_na("Send (context switch)");
+	bench_stats_report_na("Receive (context switch)");
+	bench_stats_report_na("Throughput (context switch)");
+#endif
+}
+
+#ifdef RUN_MESSAGE_QUEUE_SWEEP
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_message_queue_sweep_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
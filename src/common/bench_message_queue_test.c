@@ -27,10 +27,10 @@
 static char msg_send_buf [MSG_LEN + 1] = "1";
 static char msg_rcv_buf [MSG_LEN + 1] = "0";
 
-static bench_time_t timestamp_start_mq_r_c;
-static bench_time_t timestamp_end_mq_r_c;
-static bench_time_t timestamp_start_mq_s_c;
-static bench_time_t timestamp_end_mq_s_c;
+static struct bench_stamp timestamp_start_mq_r_c;
+static struct bench_stamp timestamp_end_mq_r_c;
+static struct bench_stamp timestamp_start_mq_s_c;
+static struct bench_stamp timestamp_end_mq_s_c;
 
 static struct bench_stats create_times;
 static struct bench_stats receive_times;
@@ -41,18 +41,16 @@ static struct bench_stats send_times;
  */
 static void gather_create_stats(uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_message_queue_create(MQ_ID, MQ_NAME, MSG_NUM, MSG_LEN);
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 
 	bench_message_queue_delete(MQ_ID, MQ_NAME);
 
-	bench_stats_update(&create_times,
-		   bench_timing_cycles_get(&start, &end),
-		   iteration);
+	bench_stats_update(&create_times, &start, &end, iteration);
 
 }
 
@@ -61,23 +59,19 @@ static void gather_create_stats(uint32_t iteration)
  */
 static void gather_send_receive_stats(uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  mid;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  mid;
+	struct bench_stamp  end;
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_message_queue_send(MQ_ID, msg_send_buf, MSG_LEN);
-	mid = bench_timing_counter_get();
+	mid = bench_stamp_get();
 	bench_message_queue_receive(MQ_ID, msg_rcv_buf, MSG_LEN);
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 
-	bench_stats_update(&send_times,
-		   bench_timing_cycles_get(&start, &mid),
-		   iteration);
+	bench_stats_update(&send_times, &start, &mid, iteration);
 
-	bench_stats_update(&receive_times,
-		   bench_timing_cycles_get(&mid, &end),
-		   iteration);
+	bench_stats_update(&receive_times, &mid, &end, iteration);
 
 }
 
@@ -91,7 +85,7 @@ static void bench_message_queue_high_prio_receive(void *args)
 	ARG_UNUSED(args);
 
 	bench_message_queue_receive(MQ_ID, msg_rcv_buf, MSG_LEN);
-	timestamp_end_mq_s_c = bench_timing_counter_get();
+	timestamp_end_mq_s_c = bench_stamp_get();
 
 	bench_thread_exit();
 }
@@ -103,17 +97,14 @@ static void bench_message_queue_high_prio_receive(void *args)
  */
 static void gather_send_context_switch_stats(int priority, int iteration)
 {
-	bench_time_t diff;
-
 	bench_thread_create(THREAD_HIGH, "high_prio_receive", priority - 1,
 			    bench_message_queue_high_prio_receive, NULL);
 	bench_thread_start(THREAD_HIGH);
 
-	timestamp_start_mq_s_c = bench_timing_counter_get();
+	timestamp_start_mq_s_c = bench_stamp_get();
 	bench_message_queue_send(MQ_ID, msg_send_buf, MSG_LEN);
-	diff = bench_timing_cycles_get(&timestamp_start_mq_s_c,
-				       &timestamp_end_mq_s_c);
-	bench_stats_update(&send_times, diff, iteration);
+	bench_stats_update(&send_times, &timestamp_start_mq_s_c,
+			   &timestamp_end_mq_s_c, iteration);
 
 }
 
@@ -127,7 +118,7 @@ static void bench_message_queue_high_prio_send(void *args)
 	ARG_UNUSED(args);
 
 	bench_message_queue_send(MQ_ID, msg_send_buf, MSG_LEN);
-	timestamp_end_mq_r_c = bench_timing_counter_get();
+	timestamp_end_mq_r_c = bench_stamp_get();
 
 	bench_thread_exit();
 }
@@ -139,18 +130,15 @@ static void bench_message_queue_high_prio_send(void *args)
  */
 static void gather_receive_context_switch_stats(int priority, int iteration)
 {
-	bench_time_t diff;
-
 	bench_thread_create(THREAD_HIGH, "high_prio_send", priority - 1,
 			    bench_message_queue_high_prio_send, NULL);
 	bench_thread_start(THREAD_HIGH);
 
-	timestamp_start_mq_r_c = bench_timing_counter_get();
+	timestamp_start_mq_r_c = bench_stamp_get();
 	bench_message_queue_receive(MQ_ID, msg_rcv_buf, MSG_LEN);
 
-	diff = bench_timing_cycles_get(&timestamp_start_mq_r_c,
-				       &timestamp_end_mq_r_c);
-	bench_stats_update(&receive_times, diff, iteration);
+	bench_stats_update(&receive_times, &timestamp_start_mq_r_c,
+			   &timestamp_end_mq_r_c, iteration);
 
 }
 
@@ -176,6 +164,7 @@ void bench_message_queue_init(void *arg)
 	bench_thread_set_priority(MAIN_PRIORITY);
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_create_stats(i);
 	}
 
@@ -184,6 +173,7 @@ void bench_message_queue_init(void *arg)
 	bench_message_queue_create(MQ_ID, MQ_NAME, MSG_NUM, MSG_LEN);
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_send_receive_stats(i);
 	}
 
@@ -194,6 +184,7 @@ void bench_message_queue_init(void *arg)
 	bench_stats_reset(&receive_times);
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_send_context_switch_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
@@ -203,6 +194,7 @@ void bench_message_queue_init(void *arg)
 	bench_message_queue_send(MQ_ID, msg_send_buf, MSG_LEN);
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_receive_context_switch_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
@@ -214,6 +206,8 @@ void bench_message_queue_init(void *arg)
 
 	bench_message_queue_delete(MQ_ID, MQ_NAME);
 
+	bench_stats_report_runtime();
+
 	bench_timing_stop();
 #else
 	bench_stats_report_title("Message queue stats");
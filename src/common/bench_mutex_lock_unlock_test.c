@@ -38,8 +38,8 @@
 
 static struct bench_stats times[NUM_TIMES];
 
-static bench_time_t  helper_start;
-static bench_time_t  helper_end;
+static struct bench_stamp  helper_start;
+static struct bench_stamp  helper_end;
 
 static const char *report_strings[NUM_TIMES] = {
     "Lock (no owner)",
@@ -82,23 +82,19 @@ static void report_stats(void)
  */
 static void gather_lock_unlock_stats(uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  mid;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  mid;
+	struct bench_stamp  end;
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_mutex_lock(MUTEX_ID);
-	mid   = bench_timing_counter_get();
+	mid   = bench_stamp_get();
 	bench_mutex_unlock(MUTEX_ID);
-	end   = bench_timing_counter_get();
+	end   = bench_stamp_get();
 
-	bench_stats_update(&times[TIME_TO_LOCK],
-			   bench_timing_cycles_get(&start, &mid),
-			   iteration);
+	bench_stats_update(&times[TIME_TO_LOCK], &start, &mid, iteration);
 
-	bench_stats_update(&times[TIME_TO_UNLOCK],
-			   bench_timing_cycles_get(&mid, &end),
-			   iteration);
+	bench_stats_update(&times[TIME_TO_UNLOCK], &mid, &end, iteration);
 }
 
 /**
@@ -106,16 +102,15 @@ static void gather_lock_unlock_stats(uint32_t iteration)
  */
 static void gather_recursive_lock_stats(uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_mutex_lock(MUTEX_ID);
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 
 	bench_stats_update(&times[TIME_TO_RECURSIVELY_LOCK],
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+			   &start, &end, iteration);
 }
 
 /**
@@ -125,15 +120,14 @@ static void gather_recursive_lock_stats(uint32_t iteration)
  */
 static void gather_recursive_unlock_stats(uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_mutex_unlock(MUTEX_ID);
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 	bench_stats_update(&times[TIME_TO_RECURSIVELY_UNLOCK],
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+			   &start, &end, iteration);
 }
 
 /**
@@ -151,7 +145,7 @@ static void bench_unpend_helper(void *args)
 
 	bench_mutex_lock(MUTEX_ID);
 
-	helper_end = bench_timing_counter_get();
+	helper_end = bench_stamp_get();
 
 	bench_mutex_unlock(MUTEX_ID);
 	bench_thread_exit();
@@ -162,8 +156,8 @@ static void bench_unpend_helper(void *args)
  */
 static void gather_unpend_stats(int priority, uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
 
 	bench_mutex_lock(MUTEX_ID);
 
@@ -180,13 +174,11 @@ static void gather_unpend_stats(int priority, uint32_t iteration)
 	 * there will not be any thread context switch.
 	 */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_mutex_unlock(MUTEX_ID);
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 
-	bench_stats_update(&times[TIME_TO_UNPEND],
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+	bench_stats_update(&times[TIME_TO_UNPEND], &start, &end, iteration);
 
 	/*
 	 * Lower the priority of the current thread to ensure the
@@ -205,7 +197,7 @@ static void gather_unpend_stats(int priority, uint32_t iteration)
  */
 static void gather_unpend_inheritance_stats(int priority, uint32_t iteration)
 {
-	bench_time_t  start;
+	struct bench_stamp  start;
 
 	bench_mutex_lock(MUTEX_ID);
 
@@ -220,12 +212,11 @@ static void gather_unpend_inheritance_stats(int priority, uint32_t iteration)
 	 * is expected to run to completion.
 	 */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_mutex_unlock(MUTEX_ID);
 
 	bench_stats_update(&times[TIME_TO_UNPEND_PRI_INH],
-			   bench_timing_cycles_get(&start, &helper_end),
-			   iteration);
+			   &start, &helper_end, iteration);
 }
 
 /**
@@ -241,7 +232,7 @@ static void bench_pend_low(void *args)
 
 	/* Step 5 */
 
-	helper_end = bench_timing_counter_get();
+	helper_end = bench_stamp_get();
 
 	bench_sem_give(SEM_ID);    /* Unblock the main thread */
 
@@ -257,7 +248,7 @@ static void bench_pend_high(void *args)
 {
 	/* Step 4 */
 
-	helper_start = bench_timing_counter_get();
+	helper_start = bench_stamp_get();
 
 	bench_mutex_lock(MUTEX_ID);
 
@@ -313,8 +304,7 @@ static void gather_pend_stats(int priority, uint32_t iteration)
 	/* Step 6. */
 
 	bench_stats_update(&times[TIME_TO_PEND],
-			   bench_timing_cycles_get(&helper_start, &helper_end),
-			   iteration);
+			   &helper_start, &helper_end, iteration);
 
 	bench_mutex_unlock(MUTEX_ID);
 
@@ -345,7 +335,7 @@ static void gather_pend_stats(int priority, uint32_t iteration)
  */
 static void gather_pend_inheritance_stats(int priority, uint32_t iteration)
 {
-	bench_time_t  end;
+	struct bench_stamp  end;
 
 	/* Step 1 */
 
@@ -355,7 +345,7 @@ static void gather_pend_inheritance_stats(int priority, uint32_t iteration)
 			    priority - 1, bench_pend_high, NULL);
 	bench_thread_start(THREAD_HIGH);
 
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 
 	/* Step 5 */
 
@@ -364,8 +354,7 @@ static void gather_pend_inheritance_stats(int priority, uint32_t iteration)
 	/* Step 8 */
 
 	bench_stats_update(&times[TIME_TO_PEND_PRI_INH],
-			   bench_timing_cycles_get(&helper_start, &end),
-			   iteration);
+			   &helper_start, &end, iteration);
 }
 
 /**
@@ -387,42 +376,50 @@ void bench_mutex_lock_unlock_test(void *arg)
 	bench_stats_report_title("Mutex Stats");
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_lock_unlock_stats(i);
 	}
 
 	bench_mutex_lock(MUTEX_ID);        /* Prep mutex so it is locked */
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_recursive_lock_stats(i);
 	}
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_recursive_unlock_stats(i);
 	}
 
 	bench_mutex_unlock(MUTEX_ID);      /* Undo final lock */
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_unpend_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_unpend_inheritance_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_pend_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_pend_inheritance_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
 
 	report_stats();
+	bench_stats_report_runtime();
 	bench_timing_stop();
 }
 
@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure mutex throughput under sustained contention
+ *
+ * This file contains the test in which MUTEX_WORKERS threads lock and
+ * unlock the same mutex around a critical section of MUTEX_CRITICAL_NS
+ * nanoseconds of busy looping, for a window of MUTEX_WINDOW_MS
+ * milliseconds. It is run once with all workers at the same priority and
+ * once with the workers spread over two priorities. For each run it
+ * reports
+ *
+ *   - the aggregate number of critical sections per second,
+ *   - the smallest and largest share of those taken by a single worker, and
+ *   - the handoff latency, from the owner unlocking the mutex until
+ *     another worker holds it.
+ *
+ * The workers first run the critical section as is. On a uniprocessor,
+ * however, a thread only finds the mutex locked if its owner was
+ * descheduled inside the critical section. With MUTEX_YIELD, a second run
+ * therefore has each worker yield once inside the critical section, letting
+ * the other ready workers of the same priority run and block on the mutex.
+ * Its throughput includes the cost of the yields, so it is reported
+ * separately. MUTEX_YIELD is 1 to always do the second run, 0 never, and -1
+ * (the default) only on uniprocessors.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#ifndef MUTEX_WORKERS
+#define MUTEX_WORKERS      4
+#endif
+
+#ifndef MUTEX_CRITICAL_NS
+#define MUTEX_CRITICAL_NS  1000
+#endif
+
+#ifndef MUTEX_WINDOW_MS
+#define MUTEX_WINDOW_MS    1000
+#endif
+
+#ifndef MUTEX_YIELD
+#define MUTEX_YIELD        (-1)
+#endif
+
+#define MAX_WORKERS  8
+
+#if (MUTEX_WORKERS < 1) || (MUTEX_WORKERS > MAX_WORKERS)
+#error "MUTEX_WORKERS must be between 1 and 8"
+#endif
+
+#define MAIN_PRIORITY    (BENCH_LAST_PRIORITY - 3)
+#define WORKER_PRIORITY  (MAIN_PRIORITY + 1)
+
+#define THREAD_WORKER    1   /* ID of the first worker thread */
+
+#define SEM_START        0
+#define SEM_DONE         1
+
+#define MUTEX_ID         0
+
+#define NO_OWNER         (-1)
+
+#define PPM              1000000ULL
+#define NSEC_PER_SEC     1000000000ULL
+#define NSEC_PER_MSEC    1000000ULL
+
+#define SAME_PRIORITY    0
+#define MIXED_PRIORITY   1
+
+#define NUM_MODES        2
+
+#define NO_YIELD         0
+#define YIELD            1
+
+#define NUM_RUNS         2
+
+static const char *throughput_strings[NUM_RUNS][NUM_MODES] = {
+	{
+		"Throughput (same priority)",
+		"Throughput (mixed priority)",
+	},
+	{
+		"Throughput (same priority, yielding)",
+		"Throughput (mixed priority, yielding)",
+	},
+};
+
+static const char *min_share_strings[NUM_RUNS][NUM_MODES] = {
+	{
+		"Smallest thread share (same priority)",
+		"Smallest thread share (mixed priority)",
+	},
+	{
+		"Smallest thread share (same priority, yielding)",
+		"Smallest thread share (mixed priority, yielding)",
+	},
+};
+
+static const char *max_share_strings[NUM_RUNS][NUM_MODES] = {
+	{
+		"Largest thread share (same priority)",
+		"Largest thread share (mixed priority)",
+	},
+	{
+		"Largest thread share (same priority, yielding)",
+		"Largest thread share (mixed priority, yielding)",
+	},
+};
+
+static const char *handoff_strings[NUM_RUNS][NUM_MODES] = {
+	{
+		"Handoff (same priority)",
+		"Handoff (mixed priority)",
+	},
+	{
+		"Handoff (same priority, yielding)",
+		"Handoff (mixed priority, yielding)",
+	},
+};
+
+static bench_time_t timestamp_window_start;
+static volatile bool workers_stop;
+static bool workers_yield;
+
+/* Protected by the mutex under test */
+static uint32_t operations[MAX_WORKERS];
+static uint32_t handoffs;
+static int last_owner;
+static struct bench_stamp timestamp_release;
+
+static struct bench_stats handoff_times;
+
+/**
+ * @brief Worker thread that hammers the mutex
+ *
+ * @param args Index of the worker
+ */
+static void bench_mutex_throughput_worker(void *args)
+{
+	int worker = (int)(uintptr_t)args;
+	bench_time_t window_start;
+	bench_time_t window_now;
+	struct bench_stamp start;
+	struct bench_stamp now;
+
+	bench_sem_take(SEM_START);
+
+	while (!workers_stop) {
+		window_now = bench_timing_counter_get();
+		window_start = timestamp_window_start;
+		if (bench_timing_cycles_to_ns(bench_timing_cycles_get(&window_start,
+								      &window_now)) >=
+		    MUTEX_WINDOW_MS * NSEC_PER_MSEC) {
+			break;
+		}
+
+		bench_mutex_lock(MUTEX_ID);
+		now = bench_stamp_get();
+
+		if ((last_owner != NO_OWNER) && (last_owner != worker)) {
+			start = timestamp_release;
+			handoffs++;
+			bench_stats_update(&handoff_times, &start, &now,
+					   handoffs);
+		}
+
+		if (MUTEX_CRITICAL_NS > 0) {
+			bench_busy_wait_ns(MUTEX_CRITICAL_NS);
+		}
+		if (workers_yield) {
+			bench_yield();
+		}
+
+		operations[worker]++;
+		last_owner = worker;
+
+		timestamp_release = bench_stamp_get();
+		bench_mutex_unlock(MUTEX_ID);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Report the results of one run as n/a
+ */
+static void report_na(int run, int mode)
+{
+	bench_stats_report_na(throughput_strings[run][mode]);
+	bench_stats_report_na(min_share_strings[run][mode]);
+	bench_stats_report_na(max_share_strings[run][mode]);
+	bench_stats_report_na(handoff_strings[run][mode]);
+}
+
+/**
+ * @brief Run the workers for one window and report the results
+ */
+static void gather_throughput_stats(int run, int mode)
+{
+	bench_time_t end;
+	uint64_t elapsed_ns;
+	uint64_t total = 0;
+	uint32_t min_ops = UINT32_MAX;
+	uint32_t max_ops = 0;
+	int created;
+	int priority;
+	int i;
+
+	bench_stats_reset(&handoff_times);
+	handoffs = 0;
+	last_owner = NO_OWNER;
+	workers_stop = false;
+	workers_yield = (run == YIELD);
+
+	/*
+	 * The workers have a lower priority than this thread. They are
+	 * released once this thread blocks waiting for them to finish.
+	 */
+
+	for (created = 0; created < MUTEX_WORKERS; created++) {
+		operations[created] = 0;
+
+		priority = WORKER_PRIORITY;
+		if (mode == MIXED_PRIORITY) {
+			priority += created % 2;
+		}
+
+		if (bench_thread_create(THREAD_WORKER + created, "mutex_worker",
+					priority, bench_mutex_throughput_worker,
+					(void *)(uintptr_t)created) !=
+		    BENCH_SUCCESS) {
+			break;
+		}
+		bench_thread_start(THREAD_WORKER + created);
+	}
+
+	/* Without all the workers, release the created ones to exit at once */
+
+	if (created < MUTEX_WORKERS) {
+		workers_stop = true;
+	}
+
+	timestamp_window_start = bench_timing_counter_get();
+
+	for (i = 0; i < created; i++) {
+		bench_sem_give(SEM_START);
+	}
+
+	for (i = 0; i < created; i++) {
+		bench_sem_take(SEM_DONE);
+	}
+
+	end = bench_timing_counter_get();
+	elapsed_ns = bench_timing_cycles_to_ns(
+		bench_timing_cycles_get(&timestamp_window_start, &end));
+
+	bench_collect_resources();
+
+	if (created < MUTEX_WORKERS) {
+		report_na(run, mode);
+		return;
+	}
+
+	for (i = 0; i < MUTEX_WORKERS; i++) {
+		total += operations[i];
+		if (operations[i] < min_ops) {
+			min_ops = operations[i];
+		}
+		if (operations[i] > max_ops) {
+			max_ops = operations[i];
+		}
+	}
+
+	bench_stats_report_value(throughput_strings[run][mode],
+				 (elapsed_ns != 0) ?
+				 (total * NSEC_PER_SEC / elapsed_ns) : 0,
+				 "ops/s");
+	bench_stats_report_value(min_share_strings[run][mode],
+				 (total != 0) ? (min_ops * PPM / total) : 0,
+				 "ppm");
+	bench_stats_report_value(max_share_strings[run][mode],
+				 (total != 0) ? (max_ops * PPM / total) : 0,
+				 "ppm");
+
+	if (handoffs != 0) {
+		bench_stats_report_line(handoff_strings[run][mode],
+					&handoff_times);
+	} else {
+		bench_stats_report_na(handoff_strings[run][mode]);
+	}
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_mutex_throughput_init(void *arg)
+{
+	bool yielding_run;
+	int mode;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Mutex throughput stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_sem_create(SEM_START, 0, MAX_WORKERS);
+	bench_sem_create(SEM_DONE, 0, MAX_WORKERS);
+	bench_mutex_create(MUTEX_ID);
+
+	if (MUTEX_YIELD < 0) {
+		yielding_run = (bench_cpu_count() == 1);
+	} else {
+		yielding_run = (MUTEX_YIELD != 0);
+	}
+
+	for (mode = 0; mode < NUM_MODES; mode++) {
+		gather_throughput_stats(NO_YIELD, mode);
+	}
+
+	if (yielding_run) {
+		for (mode = 0; mode < NUM_MODES; mode++) {
+			gather_throughput_stats(YIELD, mode);
+		}
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_MUTEX_THROUGHPUT
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_mutex_throughput_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
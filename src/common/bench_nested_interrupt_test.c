@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure nested and back-to-back interrupt latency
+ *
+ * This file contains the test that uses two software-triggered interrupts
+ * of different priorities to measure the interrupt entry and exit paths of
+ * the RTOS:
+ *
+ *   - from a thread triggering the low priority interrupt until its handler
+ *     runs, and from that handler finishing until the thread runs again,
+ *   - from the low priority handler triggering the high priority interrupt
+ *     until the high priority handler preempts it, and from the high
+ *     priority handler finishing until the low priority handler resumes,
+ *   - from the high priority handler finishing until the low priority
+ *     interrupt it triggered (and which had to wait) is taken, and
+ *   - the rate at which the low priority interrupt can be taken back to
+ *     back, with each handler triggering the next one.
+ *
+ * Ports that cannot trigger interrupts from software report n/a.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
+
+#define NSEC_PER_SEC  1000000000ULL
+
+#define MODE_ENTRY       0
+#define MODE_NESTED      1
+#define MODE_TAIL_CHAIN  2
+#define MODE_BURST       3
+
+static volatile int mode;
+static volatile bool low_done;
+static volatile bool high_done;
+static volatile uint32_t burst_count;
+
+static volatile struct bench_stamp timestamp_low_start;
+static volatile struct bench_stamp timestamp_low_trigger;
+static volatile struct bench_stamp timestamp_low_end;
+static volatile struct bench_stamp timestamp_high_start;
+static volatile struct bench_stamp timestamp_high_end;
+
+static struct bench_stats entry_times;
+static struct bench_stats exit_times;
+
+/**
+ * @brief Handler of the low priority software interrupt
+ */
+static void low_isr(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	switch (mode) {
+	case MODE_ENTRY:
+	case MODE_TAIL_CHAIN:
+		timestamp_low_start = bench_stamp_get();
+		break;
+
+	case MODE_NESTED:
+		timestamp_low_trigger = bench_stamp_get();
+		bench_soft_irq_trigger(BENCH_SOFT_IRQ_HIGH);
+		while (!high_done) {
+		}
+		timestamp_low_start = bench_stamp_get();
+		break;
+
+	case MODE_BURST:
+		if (++burst_count < ITERATIONS) {
+			bench_soft_irq_trigger(BENCH_SOFT_IRQ_LOW);
+			return;
+		}
+		break;
+	}
+
+	low_done = true;
+	timestamp_low_end = bench_stamp_get();
+}
+
+/**
+ * @brief Handler of the high priority software interrupt
+ */
+static void high_isr(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	timestamp_high_start = bench_stamp_get();
+
+	if (mode == MODE_TAIL_CHAIN) {
+		bench_soft_irq_trigger(BENCH_SOFT_IRQ_LOW);
+	}
+
+	high_done = true;
+	timestamp_high_end = bench_stamp_get();
+}
+
+/**
+ * @brief Trigger a software interrupt and wait until it is done
+ */
+static void trigger_and_wait(int irq_id)
+{
+	low_done = false;
+	high_done = false;
+
+	bench_soft_irq_trigger(irq_id);
+
+	while (!low_done) {
+	}
+}
+
+/**
+ * @brief Gather stats for entering and leaving an interrupt from a thread
+ */
+static void gather_entry_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp isr_start;
+	struct bench_stamp isr_end;
+	struct bench_stamp end;
+	uint32_t i;
+
+	mode = MODE_ENTRY;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		low_done = false;
+
+		start = bench_stamp_get();
+		bench_soft_irq_trigger(BENCH_SOFT_IRQ_LOW);
+		while (!low_done) {
+		}
+		end = bench_stamp_get();
+
+		isr_start = timestamp_low_start;
+		isr_end = timestamp_low_end;
+		bench_stats_update(&entry_times, &start, &isr_start, i);
+		bench_stats_update(&exit_times, &isr_end, &end, i);
+	}
+}
+
+/**
+ * @brief Gather stats for the high priority handler preempting the low one
+ */
+static void gather_nested_stats(void)
+{
+	struct bench_stamp low_trigger;
+	struct bench_stamp high_start;
+	struct bench_stamp high_end;
+	struct bench_stamp low_resume;
+	uint32_t i;
+
+	mode = MODE_NESTED;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		trigger_and_wait(BENCH_SOFT_IRQ_LOW);
+
+		low_trigger = timestamp_low_trigger;
+		high_start = timestamp_high_start;
+		high_end = timestamp_high_end;
+		low_resume = timestamp_low_start;
+		bench_stats_update(&entry_times, &low_trigger, &high_start, i);
+		bench_stats_update(&exit_times, &high_end, &low_resume, i);
+	}
+}
+
+/**
+ * @brief Gather stats for a pending low priority interrupt being taken
+ *
+ * The high priority handler triggers the low priority interrupt, which can
+ * only be taken once the high priority handler returns.
+ */
+static void gather_tail_chain_stats(void)
+{
+	struct bench_stamp high_end;
+	struct bench_stamp low_start;
+	uint32_t i;
+
+	mode = MODE_TAIL_CHAIN;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		trigger_and_wait(BENCH_SOFT_IRQ_HIGH);
+
+		high_end = timestamp_high_end;
+		low_start = timestamp_low_start;
+		bench_stats_update(&entry_times, &high_end, &low_start, i);
+	}
+}
+
+/**
+ * @brief Get the rate at which interrupts can be taken back to back
+ *
+ * @return Number of interrupts per second
+ */
+static uint64_t burst_rate_get(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	bench_time_t ns;
+
+	mode = MODE_BURST;
+	burst_count = 0;
+
+	start = bench_stamp_get();
+	trigger_and_wait(BENCH_SOFT_IRQ_LOW);
+	end = bench_stamp_get();
+
+	ns = bench_timing_cycles_to_ns(bench_stamp_cycles(&start, &end));
+
+	return (ns != 0) ? ((uint64_t)ITERATIONS * NSEC_PER_SEC / ns) : 0;
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_nested_interrupt_init(void *arg)
+{
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Nested interrupt stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	if ((bench_soft_irq_connect(BENCH_SOFT_IRQ_HIGH,
+				    high_isr) != BENCH_SUCCESS) ||
+	    (bench_soft_irq_connect(BENCH_SOFT_IRQ_LOW,
+				    low_isr) != BENCH_SUCCESS)) {
+		bench_stats_report_na("Interrupt entry (from thread)");
+		bench_stats_report_na("Interrupt exit (to thread)");
+		bench_stats_report_na("Nested entry (preempting ISR)");
+		bench_stats_report_na("Nested exit (to preempted ISR)");
+		bench_stats_report_na("Pending entry (after ISR exit)");
+		bench_stats_report_na("Back-to-back interrupts");
+		bench_timing_stop();
+		return;
+	}
+
+	bench_stats_reset(&entry_times);
+	bench_stats_reset(&exit_times);
+
+	gather_entry_stats();
+
+	bench_stats_report_line("Interrupt entry (from thread)", &entry_times);
+	bench_stats_report_line("Interrupt exit (to thread)", &exit_times);
+
+	bench_stats_reset(&entry_times);
+	bench_stats_reset(&exit_times);
+
+	gather_nested_stats();
+
+	bench_stats_report_line("Nested entry (preempting ISR)", &entry_times);
+	bench_stats_report_line("Nested exit (to preempted ISR)", &exit_times);
+
+	bench_stats_reset(&entry_times);
+
+	gather_tail_chain_stats();
+
+	bench_stats_report_line("Pending entry (after ISR exit)", &entry_times);
+
+	bench_stats_report_value("Back-to-back interrupts", burst_rate_get(),
+				 "irq/s");
+
+	bench_soft_irq_disconnect(BENCH_SOFT_IRQ_LOW);
+	bench_soft_irq_disconnect(BENCH_SOFT_IRQ_HIGH);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_NESTED_INTERRUPT
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_nested_interrupt_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure fixed-block pool allocation against the heap
+ *
+ * This file contains the test that compares allocating and freeing a
+ * BLOCK_SIZE byte block from the heap and from a fixed-block pool. It also
+ * measures the path taken when the pool is exhausted:
+ *
+ *   - the time from a higher priority thread calling bench_pool_alloc() on
+ *     the exhausted pool until the lower priority thread runs again, and
+ *   - the time from the lower priority thread calling bench_pool_free()
+ *     until the waiting higher priority thread has the block.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 3)
+#define WAITER_PRIORITY (MAIN_PRIORITY - 1)
+
+#define THREAD_WAITER   1
+
+#define SEM_NEXT        0
+
+#define POOL_ID         0
+
+#define BLOCK_SIZE      128
+#define BLOCK_NUM       4
+
+static volatile struct bench_stamp timestamp_alloc;
+static volatile struct bench_stamp timestamp_free;
+
+static struct bench_stats alloc_times;
+static struct bench_stats free_times;
+static struct bench_stats block_times;
+static struct bench_stats wake_times;
+
+/**
+ * @brief Gather stats for allocating and freeing from the heap
+ */
+static void gather_heap_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp mid;
+	struct bench_stamp end;
+	void *p;
+	uint32_t i;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		p = bench_malloc(BLOCK_SIZE);
+		mid = bench_stamp_get();
+		bench_free(p);
+		end = bench_stamp_get();
+
+		bench_stats_update(&alloc_times, &start, &mid, i);
+		bench_stats_update(&free_times, &mid, &end, i);
+	}
+}
+
+/**
+ * @brief Gather stats for allocating and freeing from the pool
+ */
+static void gather_pool_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp mid;
+	struct bench_stamp end;
+	void *p;
+	uint32_t i;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		p = bench_pool_alloc(POOL_ID);
+		mid = bench_stamp_get();
+		bench_pool_free(POOL_ID, p);
+		end = bench_stamp_get();
+
+		bench_stats_update(&alloc_times, &start, &mid, i);
+		bench_stats_update(&free_times, &mid, &end, i);
+	}
+}
+
+/**
+ * @brief Thread that allocates from the exhausted pool
+ *
+ * Each allocation blocks until the main thread frees a block. The block is
+ * returned at once, and the main thread takes it back before letting this
+ * thread allocate again.
+ */
+static void bench_pool_waiter(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	void *p;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_sem_take(SEM_NEXT);
+
+		timestamp_alloc = bench_stamp_get();
+		p = bench_pool_alloc(POOL_ID);
+		end = bench_stamp_get();
+
+		start = timestamp_free;
+		bench_stats_update(&wake_times, &start, &end, i);
+
+		bench_pool_free(POOL_ID, p);
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather stats for the exhausted pool
+ */
+static void gather_exhausted_stats(void)
+{
+	void *blocks[BLOCK_NUM];
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	for (i = 0; i < BLOCK_NUM; i++) {
+		blocks[i] = bench_pool_alloc(POOL_ID);
+	}
+
+	bench_thread_create(THREAD_WAITER, "pool_waiter", WAITER_PRIORITY,
+			    bench_pool_waiter, NULL);
+	bench_thread_start(THREAD_WAITER);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		/* The waiter runs until it blocks on the exhausted pool */
+
+		bench_sem_give(SEM_NEXT);
+		end = bench_stamp_get();
+
+		start = timestamp_alloc;
+		bench_stats_update(&block_times, &start, &end, i);
+
+		/* The waiter runs with the block, returns it and blocks */
+
+		timestamp_free = bench_stamp_get();
+		bench_pool_free(POOL_ID, blocks[0]);
+
+		blocks[0] = bench_pool_alloc(POOL_ID);
+	}
+
+	bench_collect_resources();
+
+	for (i = 0; i < BLOCK_NUM; i++) {
+		bench_pool_free(POOL_ID, blocks[i]);
+	}
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_pool_init(void *arg)
+{
+	void *p;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Pool allocation stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	/* Not every port provides a heap */
+
+	p = bench_malloc(BLOCK_SIZE);
+	if (p != NULL) {
+		bench_free(p);
+
+		bench_stats_reset(&alloc_times);
+		bench_stats_reset(&free_times);
+
+		gather_heap_stats();
+
+		bench_stats_report_line("Heap alloc", &alloc_times);
+		bench_stats_report_line("Heap free", &free_times);
+	} else {
+		bench_stats_report_na("Heap alloc");
+		bench_stats_report_na("Heap free");
+	}
+
+	if (bench_pool_create(POOL_ID, BLOCK_NUM, BLOCK_SIZE) != BENCH_SUCCESS) {
+		bench_stats_report_na("Pool alloc");
+		bench_stats_report_na("Pool free");
+		bench_stats_report_na("Pool alloc blocking (context switch)");
+		bench_stats_report_na("Pool free to waiter (context switch)");
+		bench_timing_stop();
+		return;
+	}
+
+	bench_stats_reset(&alloc_times);
+	bench_stats_reset(&free_times);
+
+	gather_pool_stats();
+
+	bench_stats_report_line("Pool alloc", &alloc_times);
+	bench_stats_report_line("Pool free", &free_times);
+
+	bench_stats_reset(&block_times);
+	bench_stats_reset(&wake_times);
+
+	bench_sem_create(SEM_NEXT, 0, 1);
+
+	gather_exhausted_stats();
+
+	bench_stats_report_line("Pool alloc blocking (context switch)",
+				&block_times);
+	bench_stats_report_line("Pool free to waiter (context switch)",
+				&wake_times);
+
+	bench_pool_delete(POOL_ID);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_POOL
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_pool_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,546 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Result reporters
+ *
+ * This file contains the routines that format the collected statistics.
+ * Besides the human readable text output, results can be emitted as one
+ * CSV or JSON record per metric so that they can be ingested without
+ * scraping the console.
+ */
+
+#include "bench_utils.h"
+
+#include "bench_api.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef BENCH_RTOS_NAME
+#if defined(RTEMS)
+#define BENCH_RTOS_NAME "rtems"
+#elif defined(__NuttX__)
+#define BENCH_RTOS_NAME "nuttx"
+#elif defined(__VXWORKS__)
+#define BENCH_RTOS_NAME "vxworks"
+#else
+#define BENCH_RTOS_NAME "unknown"
+#endif
+#endif
+
+#ifndef BENCH_BOARD_NAME
+#define BENCH_BOARD_NAME "unknown"
+#endif
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE ""
+#endif
+
+#ifdef __VERSION__
+#define BENCH_COMPILER __VERSION__
+#else
+#define BENCH_COMPILER "unknown"
+#endif
+
+#ifndef RUNTIME_STATS
+#define RUNTIME_STATS 0
+#endif
+
+/* Thread IDs whose run time is reported */
+#ifndef RUNTIME_MAX_THREADS
+#define RUNTIME_MAX_THREADS BENCH_THREAD_MAX_NUM
+#endif
+
+/* Percentiles reported for each metric, in parts per million */
+static const uint32_t report_percentiles[] = {
+	500000, 900000, 990000, 999000, 999900
+};
+
+#define NUM_REPORT_PERCENTILES \
+	(sizeof(report_percentiles) / sizeof(report_percentiles[0]))
+
+/* Names of the values reported for each metric */
+static const char *value_names[] = {
+	"avg", "min", "max", "p50", "p90", "p99", "p99.9", "p99.99", "stddev"
+};
+
+#define NUM_VALUES  (sizeof(value_names) / sizeof(value_names[0]))
+
+/*
+ * Machine readable records end in CR-LF rather than the LF-CR used by the
+ * text output so that every record starts at the beginning of a line.
+ */
+#define EOL "\r\n"
+
+#if defined(REPORT_FORMAT_JSON)
+static const struct bench_reporter *reporter = &bench_reporter_json;
+#elif defined(REPORT_FORMAT_CSV)
+static const struct bench_reporter *reporter = &bench_reporter_csv;
+#else
+static const struct bench_reporter *reporter = &bench_reporter_text;
+#endif
+
+/* Copy of the current title, so that callers may reuse their buffer */
+static char current_test[64];
+static bool header_done;
+
+#if RUNTIME_STATS
+/*
+ * Run time of the threads when the current test reported its title. Entry
+ * 0 is the calling thread, entry 1 the idle thread and entry 2 + n the
+ * thread of ID n.
+ */
+#define RUNTIME_ENTRIES  (2 + RUNTIME_MAX_THREADS)
+
+static bool runtime_open;
+static bench_time_t runtime_start;
+static uint64_t runtime_ns[RUNTIME_ENTRIES];
+static bool runtime_valid[RUNTIME_ENTRIES];
+
+static int runtime_thread_id(int entry)
+{
+	return (entry == 0) ? BENCH_THREAD_SELF :
+	       (entry == 1) ? BENCH_THREAD_IDLE : (entry - 2);
+}
+#endif
+
+/**
+ * @brief Get the frequency of the timing counter
+ *
+ * The porting layer only offers a conversion from cycles to nanoseconds,
+ * so the frequency is derived from the duration of one million cycles.
+ */
+static uint64_t timing_freq_get(void)
+{
+	uint64_t ns = bench_timing_cycles_to_ns(1000000);
+
+	return (ns != 0) ? (1000000000000000ULL / ns) : 0;
+}
+
+/**
+ * @brief Get the values reported for a metric (in cycles)
+ *
+ * The values are in the order avg, min, max, percentiles and stddev.
+ */
+static void stats_values_get(const struct bench_stats *stats,
+			     bench_time_t *values)
+{
+	uint32_t i;
+
+	values[0] = stats->avg;
+	values[1] = stats->min;
+	values[2] = stats->max;
+
+	for (i = 0; i < NUM_REPORT_PERCENTILES; i++) {
+		values[3 + i] = bench_stats_percentile(stats,
+						       report_percentiles[i]);
+	}
+
+	values[3 + NUM_REPORT_PERCENTILES] = bench_stats_stddev(stats);
+}
+
+/*
+ * Text output
+ */
+
+static void text_header(void)
+{
+	PRINTF("** Run: rtos %s, board %s, iterations %u, timing %llu Hz **\n\r",
+	       BENCH_RTOS_NAME, BENCH_BOARD_NAME, (unsigned int)ITERATIONS,
+	       (unsigned long long)timing_freq_get());
+}
+
+static void text_title(const char *title)
+{
+	PRINTF("** %s [avg, min, max, p50, p90, p99, p99.9, p99.99, stddev]"
+	       " in nanoseconds **\n\r", title);
+}
+
+static void text_line(const char *test, const char *summary,
+		      const struct bench_stats *stats)
+{
+	bench_time_t values[NUM_VALUES];
+	uint32_t i;
+
+	ARG_UNUSED(test);
+
+	stats_values_get(stats, values);
+
+	PRINTF(" %-40s: ", summary);
+	for (i = 0; i < NUM_VALUES; i++) {
+		PRINTF("%s%6llu", (i == 0) ? "" : ", ",
+		       bench_timing_cycles_to_ns(values[i]));
+	}
+	PRINTF("\n\r");
+}
+
+static void text_na(const char *test, const char *summary)
+{
+	uint32_t i;
+
+	ARG_UNUSED(test);
+
+	PRINTF(" %-40s: ", summary);
+	for (i = 0; i < NUM_VALUES; i++) {
+		PRINTF("%s%6s", (i == 0) ? "" : ", ", "n/a");
+	}
+	PRINTF("\n\r");
+}
+
+static void text_value(const char *test, const char *summary, uint64_t value,
+		       const char *unit)
+{
+	ARG_UNUSED(test);
+
+	PRINTF(" %-40s: %6llu %s\n\r", summary, (unsigned long long)value, unit);
+}
+
+const struct bench_reporter bench_reporter_text = {
+	.header = text_header,
+	.title = text_title,
+	.line = text_line,
+	.na = text_na,
+	.value = text_value,
+};
+
+/*
+ * CSV output
+ *
+ * Every record begins with its type. The run record is followed by the
+ * column names of the result and value records.
+ */
+
+static void csv_header(void)
+{
+	uint32_t i;
+
+	PRINTF("run,rtos,board,iterations,calibration_loops,timing_hz,"
+	       "timing_overhead_cycles,hist_sub_bits,build_type,compiler" EOL);
+	PRINTF("run,\"%s\",\"%s\",%u,%u,%llu,%llu,%u,\"%s\",\"%s\"" EOL,
+	       BENCH_RTOS_NAME, BENCH_BOARD_NAME, (unsigned int)ITERATIONS,
+	       (unsigned int)CALIBRATION_LOOPS,
+	       (unsigned long long)timing_freq_get(),
+	       (unsigned long long)bench_timing_overhead_get(),
+	       (unsigned int)BENCH_HIST_SUB_BITS, BENCH_BUILD_TYPE,
+	       BENCH_COMPILER);
+
+	PRINTF("result,rtos,board,test,metric,samples");
+	for (i = 0; i < NUM_VALUES; i++) {
+		PRINTF(",%s_cycles", value_names[i]);
+	}
+	for (i = 0; i < NUM_VALUES; i++) {
+		PRINTF(",%s_ns", value_names[i]);
+	}
+	PRINTF(EOL);
+
+	PRINTF("value,rtos,board,test,metric,value,unit" EOL);
+}
+
+static void csv_title(const char *title)
+{
+	ARG_UNUSED(title);
+}
+
+static void csv_line(const char *test, const char *summary,
+		     const struct bench_stats *stats)
+{
+	bench_time_t values[NUM_VALUES];
+	uint32_t i;
+
+	stats_values_get(stats, values);
+
+	PRINTF("result,\"%s\",\"%s\",\"%s\",\"%s\",%u", BENCH_RTOS_NAME,
+	       BENCH_BOARD_NAME, test, summary, (unsigned int)stats->count);
+	for (i = 0; i < NUM_VALUES; i++) {
+		PRINTF(",%llu", (unsigned long long)values[i]);
+	}
+	for (i = 0; i < NUM_VALUES; i++) {
+		PRINTF(",%llu", bench_timing_cycles_to_ns(values[i]));
+	}
+	PRINTF(EOL);
+}
+
+static void csv_na(const char *test, const char *summary)
+{
+	uint32_t i;
+
+	PRINTF("result,\"%s\",\"%s\",\"%s\",\"%s\",0", BENCH_RTOS_NAME,
+	       BENCH_BOARD_NAME, test, summary);
+	for (i = 0; i < 2 * NUM_VALUES; i++) {
+		PRINTF(",");
+	}
+	PRINTF(EOL);
+}
+
+static void csv_value(const char *test, const char *summary, uint64_t value,
+		      const char *unit)
+{
+	PRINTF("value,\"%s\",\"%s\",\"%s\",\"%s\",%llu,\"%s\"" EOL,
+	       BENCH_RTOS_NAME, BENCH_BOARD_NAME, test, summary,
+	       (unsigned long long)value, unit);
+}
+
+const struct bench_reporter bench_reporter_csv = {
+	.header = csv_header,
+	.title = csv_title,
+	.line = csv_line,
+	.na = csv_na,
+	.value = csv_value,
+};
+
+/*
+ * JSON lines output
+ */
+
+/**
+ * @brief Print a JSON string, escaping as needed
+ */
+static void json_string(const char *str)
+{
+	PRINTF("\"");
+	for (; *str != '\0'; str++) {
+		if ((*str == '"') || (*str == '\\')) {
+			PRINTF("\\%c", *str);
+		} else {
+			PRINTF("%c", *str);
+		}
+	}
+	PRINTF("\"");
+}
+
+static void json_record_begin(const char *type)
+{
+	PRINTF("{\"type\":\"%s\",\"rtos\":", type);
+	json_string(BENCH_RTOS_NAME);
+	PRINTF(",\"board\":");
+	json_string(BENCH_BOARD_NAME);
+}
+
+static void json_header(void)
+{
+	json_record_begin("run");
+	PRINTF(",\"iterations\":%u,\"calibration_loops\":%u,"
+	       "\"timing_hz\":%llu,\"timing_overhead_cycles\":%llu,"
+	       "\"hist_sub_bits\":%u,\"build_type\":",
+	       (unsigned int)ITERATIONS, (unsigned int)CALIBRATION_LOOPS,
+	       (unsigned long long)timing_freq_get(),
+	       (unsigned long long)bench_timing_overhead_get(),
+	       (unsigned int)BENCH_HIST_SUB_BITS);
+	json_string(BENCH_BUILD_TYPE);
+	PRINTF(",\"compiler\":");
+	json_string(BENCH_COMPILER);
+	PRINTF("}" EOL);
+}
+
+static void json_title(const char *title)
+{
+	ARG_UNUSED(title);
+}
+
+static void json_values(const bench_time_t *values, bool to_ns)
+{
+	bench_time_t value;
+	uint32_t i;
+
+	for (i = 0; i < NUM_VALUES; i++) {
+		value = to_ns ? bench_timing_cycles_to_ns(values[i]) : values[i];
+
+		PRINTF("%s\"%s\":%llu", (i == 0) ? "{" : ",", value_names[i],
+		       (unsigned long long)value);
+	}
+	PRINTF("}");
+}
+
+static void json_line(const char *test, const char *summary,
+		      const struct bench_stats *stats)
+{
+	bench_time_t values[NUM_VALUES];
+
+	stats_values_get(stats, values);
+
+	json_record_begin("result");
+	PRINTF(",\"test\":");
+	json_string(test);
+	PRINTF(",\"metric\":");
+	json_string(summary);
+	PRINTF(",\"samples\":%u,\"cycles\":", (unsigned int)stats->count);
+	json_values(values, false);
+	PRINTF(",\"ns\":");
+	json_values(values, true);
+	PRINTF("}" EOL);
+}
+
+static void json_na(const char *test, const char *summary)
+{
+	json_record_begin("result");
+	PRINTF(",\"test\":");
+	json_string(test);
+	PRINTF(",\"metric\":");
+	json_string(summary);
+	PRINTF(",\"samples\":0,\"cycles\":null,\"ns\":null}" EOL);
+}
+
+static void json_value(const char *test, const char *summary, uint64_t value,
+		       const char *unit)
+{
+	json_record_begin("value");
+	PRINTF(",\"test\":");
+	json_string(test);
+	PRINTF(",\"metric\":");
+	json_string(summary);
+	PRINTF(",\"value\":%llu,\"unit\":", (unsigned long long)value);
+	json_string(unit);
+	PRINTF("}" EOL);
+}
+
+const struct bench_reporter bench_reporter_json = {
+	.header = json_header,
+	.title = json_title,
+	.line = json_line,
+	.na = json_na,
+	.value = json_value,
+};
+
+void bench_report_set(const struct bench_reporter *new_reporter)
+{
+	reporter = new_reporter;
+}
+
+void bench_stats_report_title(const char *title)
+{
+#if RUNTIME_STATS
+	int i;
+#endif
+
+	if (!header_done) {
+		header_done = true;
+		reporter->header();
+	}
+
+#if RUNTIME_STATS
+	/* A test reporting several titles reports its run time for each */
+
+	bench_stats_report_runtime();
+#endif
+
+	snprintf(current_test, sizeof(current_test), "%s", title);
+	reporter->title(current_test);
+
+#if RUNTIME_STATS
+	/*
+	 * Snapshot the test thread last so that the cost of the snapshot is
+	 * not accounted to it.
+	 */
+
+	for (i = RUNTIME_ENTRIES - 1; i >= 0; i--) {
+		runtime_valid[i] = (bench_thread_runtime_get(runtime_thread_id(i),
+							     &runtime_ns[i]) ==
+				    BENCH_SUCCESS);
+	}
+
+	runtime_open = true;
+	runtime_start = bench_timing_counter_get();
+#endif
+}
+
+void bench_stats_report_line(const char *summary, const struct bench_stats *stats)
+{
+#if TICK_FILTER
+	char ticked_summary[64];
+#endif
+
+	if ((stats->count == 0) && (stats->ticked != 0)) {
+		/* Every sample was tick-affected */
+
+		reporter->na(current_test, summary);
+	} else {
+		reporter->line(current_test, summary, stats);
+		bench_trace_dump(current_test, summary, stats);
+	}
+
+#if TICK_FILTER
+	if (stats->ticked != 0) {
+		snprintf(ticked_summary, sizeof(ticked_summary),
+			 "%s [tick-affected]", summary);
+		reporter->value(current_test, ticked_summary, stats->ticked,
+				"samples");
+		snprintf(ticked_summary, sizeof(ticked_summary),
+			 "%s [tick-affected max]", summary);
+		reporter->value(current_test, ticked_summary,
+				bench_timing_cycles_to_ns(stats->ticked_max),
+				"ns");
+	}
+#endif
+}
+
+void bench_stats_report_na(const char *summary)
+{
+	reporter->na(current_test, summary);
+}
+
+void bench_stats_report_value(const char *summary, uint64_t value,
+			      const char *unit)
+{
+	reporter->value(current_test, summary, value, unit);
+}
+
+void bench_stats_report_runtime(void)
+{
+#if RUNTIME_STATS
+	static const char *fixed_strings[] = {
+		"Run time (test thread)",
+		"Run time (idle)",
+	};
+	char summary[40];
+	bench_time_t end;
+	uint64_t elapsed_ns;
+	uint64_t accounted_ns = 0;
+	uint64_t ns;
+	int i;
+
+	if (!runtime_open) {
+		return;
+	}
+
+	runtime_open = false;
+
+	end = bench_timing_counter_get();
+	elapsed_ns = bench_timing_cycles_to_ns(
+		bench_timing_cycles_get(&runtime_start, &end));
+
+	for (i = 0; i < RUNTIME_ENTRIES; i++) {
+		if (bench_thread_runtime_get(runtime_thread_id(i),
+					     &ns) != BENCH_SUCCESS) {
+			continue;
+		}
+
+		/* Thread IDs first used by this test had not run before */
+
+		if (runtime_valid[i]) {
+			ns -= runtime_ns[i];
+		}
+
+		if ((i >= 2) && (ns == 0)) {
+			continue;
+		}
+
+		if (i < 2) {
+			bench_stats_report_value(fixed_strings[i], ns / 1000,
+						 "us");
+		} else {
+			snprintf(summary, sizeof(summary),
+				 "Run time (thread %d)", i - 2);
+			bench_stats_report_value(summary, ns / 1000, "us");
+		}
+
+		accounted_ns += ns;
+	}
+
+	/* Threads on other CPUs may account for more than the elapsed time */
+
+	bench_stats_report_value("Run time (unaccounted)",
+				 (elapsed_ns > accounted_ns) ?
+				 (elapsed_ns - accounted_ns) / 1000 : 0, "us");
+	bench_stats_report_value("Elapsed time", elapsed_ns / 1000, "us");
+#endif
+}
@@ -0,0 +1,394 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure context switch latency as the number of ready threads grows
+ *
+ * This file contains the test that makes 0, 10, 50, 100 and 200 threads
+ * ready and with each count reports
+ *
+ *   - the time to yield to a thread of equal priority, and
+ *   - the time from giving a semaphore until the higher priority thread
+ *     waiting for it runs.
+ *
+ * One in four ready threads (peers) shares the priority of the thread that
+ * yields or gives the semaphore, and the others are spread over the lower
+ * priorities. The lower ones never run while the measurements are taken,
+ * but they sit in the ready queue of the scheduler, whose data structures
+ * then decide how the switch cost scales. The peers only yield, so that
+ * they take their turn in the same queue as the measured threads. Each
+ * yield sample is the switch from whichever thread yielded last to the
+ * measuring thread.
+ *
+ * The test needs BENCH_THREAD_MAX_NUM to be at least two more than the
+ * number of ready threads. Larger counts report n/a, which on MCU ports is
+ * the default for all but the smallest counts. All threads are pinned
+ * to CPU 0, so that on SMP systems the ready threads do not run either.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+/*
+ * The main thread stays above all others while it creates them. The ready
+ * threads other than the peers take every priority from READY_PRIORITY to
+ * BENCH_LAST_PRIORITY.
+ */
+#define MAIN_PRIORITY   1
+#define HIGH_PRIORITY   2
+#define LOW_PRIORITY    3
+#define READY_PRIORITY  4
+
+#define THREAD_HIGH     0
+#define THREAD_LOW      1
+#define THREAD_READY    2   /* ID of the first ready thread */
+
+#define SEM_WAKE        0
+#define SEM_DONE        1
+
+#define SCHED_CPU       0
+
+#define PEER_RATIO      4   /* One in PEER_RATIO ready threads is a peer */
+
+static const int ready_counts[] = { 0, 10, 50, 100, 200 };
+
+static const char *yield_strings[] = {
+	"Yield (0 ready threads)",
+	"Yield (10 ready threads)",
+	"Yield (50 ready threads)",
+	"Yield (100 ready threads)",
+	"Yield (200 ready threads)",
+};
+
+static const char *wake_strings[] = {
+	"Semaphore wake (0 ready threads)",
+	"Semaphore wake (10 ready threads)",
+	"Semaphore wake (50 ready threads)",
+	"Semaphore wake (100 ready threads)",
+	"Semaphore wake (200 ready threads)",
+};
+
+#define NUM_LEVELS  (sizeof(ready_counts) / sizeof(ready_counts[0]))
+
+static volatile struct bench_stamp timestamp_start;
+static volatile bool ready_stop;
+
+static struct bench_stats yield_times;
+static struct bench_stats wake_times;
+
+/**
+ * @brief Thread that is ready but only runs once told to stop
+ */
+static void bench_sched_ready(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (!ready_stop) {
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Peer of the yielding threads, which yields whenever it runs
+ */
+static void bench_sched_yield_peer(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (!ready_stop) {
+		timestamp_start = bench_stamp_get();
+		bench_yield();
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Peer of the waking thread, which yields whenever it runs
+ *
+ * It only runs if the RTOS slices time between threads of equal priority.
+ */
+static void bench_sched_wake_peer(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (!ready_stop) {
+		bench_yield();
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that yields to the measuring thread
+ */
+static void bench_sched_yielder(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		timestamp_start = bench_stamp_get();
+		bench_yield();
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that measures the yields of the other one
+ */
+static void bench_sched_yield_measurer(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	/* Let the other thread take the first timestamp */
+
+	bench_yield();
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		end = bench_stamp_get();
+
+		start = timestamp_start;
+		bench_stats_update(&yield_times, &start, &end, i);
+
+		bench_yield();
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Higher priority thread that waits for the semaphore
+ */
+static void bench_sched_waiter(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_sem_take(SEM_WAKE);
+		end = bench_stamp_get();
+
+		start = timestamp_start;
+		bench_stats_update(&wake_times, &start, &end, i);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Lower priority thread that gives the semaphore
+ */
+static void bench_sched_waker(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		timestamp_start = bench_stamp_get();
+		bench_sem_give(SEM_WAKE);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Start a thread pinned to the CPU of the test
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+static int sched_thread_start(int thread_id, const char *name, int priority,
+			      void (*entry)(void *))
+{
+	if ((bench_thread_cpu_set(thread_id, SCHED_CPU) != BENCH_SUCCESS) ||
+	    (bench_thread_create(thread_id, name, priority, entry,
+				 NULL) != BENCH_SUCCESS)) {
+		return BENCH_ERROR;
+	}
+
+	bench_thread_start(thread_id);
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Make @a num_ready threads ready
+ *
+ * One in PEER_RATIO runs @a peer_entry at @a peer_priority, and the others
+ * are spread over the lower priorities.
+ *
+ * @return Number of threads made ready
+ */
+static int ready_threads_start(int num_ready, int peer_priority,
+			       void (*peer_entry)(void *))
+{
+	int priorities = BENCH_LAST_PRIORITY - READY_PRIORITY + 1;
+	int ret;
+	int n;
+
+	ready_stop = false;
+
+	for (n = 0; n < num_ready; n++) {
+		if ((n % PEER_RATIO) == 0) {
+			ret = sched_thread_start(THREAD_READY + n, "sched_peer",
+						 peer_priority, peer_entry);
+		} else {
+			ret = sched_thread_start(THREAD_READY + n, "sched_ready",
+						 READY_PRIORITY + (n % priorities),
+						 bench_sched_ready);
+		}
+
+		if (ret != BENCH_SUCCESS) {
+			break;
+		}
+	}
+
+	return n;
+}
+
+/**
+ * @brief Let the ready threads, and any other finished threads, exit
+ */
+static void ready_threads_stop(int num_ready)
+{
+	int n;
+
+	ready_stop = true;
+
+	for (n = 0; n < num_ready; n++) {
+		bench_sem_take(SEM_DONE);
+	}
+
+	/*
+	 * Lower the priority of the main thread so that the threads finish
+	 * exiting before the next peers, which never block, are started.
+	 */
+
+	bench_thread_set_priority(BENCH_LAST_PRIORITY);
+	bench_yield();
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_collect_resources();
+}
+
+/**
+ * @brief Gather the switch stats with @a num_ready ready threads
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+static int gather_level_stats(int num_ready)
+{
+	int started;
+	int ret = BENCH_ERROR;
+
+	bench_stats_reset(&yield_times);
+	bench_stats_reset(&wake_times);
+
+	/* The peers take their turns between the yields */
+
+	started = ready_threads_start(num_ready, HIGH_PRIORITY,
+				      bench_sched_yield_peer);
+	if (started != num_ready) {
+		goto out;
+	}
+
+	if ((sched_thread_start(THREAD_HIGH, "sched_measurer", HIGH_PRIORITY,
+				bench_sched_yield_measurer) != BENCH_SUCCESS) ||
+	    (sched_thread_start(THREAD_LOW, "sched_yielder", HIGH_PRIORITY,
+				bench_sched_yielder) != BENCH_SUCCESS)) {
+		goto out;
+	}
+
+	bench_sem_take(SEM_DONE);
+	bench_sem_take(SEM_DONE);
+
+	ready_threads_stop(started);
+
+	/* The peers wait behind the waker, which never blocks */
+
+	started = ready_threads_start(num_ready, LOW_PRIORITY,
+				      bench_sched_wake_peer);
+	if (started != num_ready) {
+		goto out;
+	}
+
+	if ((sched_thread_start(THREAD_HIGH, "sched_waiter", HIGH_PRIORITY,
+				bench_sched_waiter) != BENCH_SUCCESS) ||
+	    (sched_thread_start(THREAD_LOW, "sched_waker", LOW_PRIORITY,
+				bench_sched_waker) != BENCH_SUCCESS)) {
+		goto out;
+	}
+
+	bench_sem_take(SEM_DONE);
+	bench_sem_take(SEM_DONE);
+
+	ret = BENCH_SUCCESS;
+
+out:
+	ready_threads_stop(started);
+
+	return ret;
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_sched_scaling_init(void *arg)
+{
+	uint32_t i;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Scheduler scaling stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_sem_create(SEM_WAKE, 0, 1);
+	bench_sem_create(SEM_DONE, 0, BENCH_THREAD_MAX_NUM);
+
+	for (i = 0; i < NUM_LEVELS; i++) {
+		if ((THREAD_READY + ready_counts[i] <= BENCH_THREAD_MAX_NUM) &&
+		    (gather_level_stats(ready_counts[i]) == BENCH_SUCCESS)) {
+			bench_stats_report_line(yield_strings[i], &yield_times);
+			bench_stats_report_line(wake_strings[i], &wake_times);
+		} else {
+			bench_stats_report_na(yield_strings[i]);
+			bench_stats_report_na(wake_strings[i]);
+		}
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_SCHED_SCALING
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_sched_scaling_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -12,10 +12,10 @@
 
 #define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
 
-static bench_time_t timestamp_start_sema_t_c;
-static bench_time_t timestamp_end_sema_t_c;
-static bench_time_t timestamp_start_sema_g_c;
-static bench_time_t timestamp_end_sema_g_c;
+static struct bench_stamp timestamp_start_sema_t_c;
+static struct bench_stamp timestamp_end_sema_t_c;
+static struct bench_stamp timestamp_start_sema_g_c;
+static struct bench_stamp timestamp_end_sema_g_c;
 
 static struct bench_stats take_times;
 static struct bench_stats give_times;
@@ -29,9 +29,9 @@ void bench_sem_context_switch_high_prio_take(void *args)
 {
 	ARG_UNUSED(args);
 
-	timestamp_start_sema_t_c = bench_timing_counter_get();
+	timestamp_start_sema_t_c = bench_stamp_get();
 	bench_sem_take(0);
-	timestamp_end_sema_g_c = bench_timing_counter_get();
+	timestamp_end_sema_g_c = bench_stamp_get();
 
 	bench_thread_exit();
 }
@@ -43,22 +43,18 @@ void bench_sem_context_switch_high_prio_take(void *args)
  */
 void bench_sem_context_switch_low_prio_give(int priority, int iteration)
 {
-	bench_time_t diff;
-
 	bench_thread_create(1, "high_prio_take", priority - 1,
 			    bench_sem_context_switch_high_prio_take, NULL);
 	bench_thread_start(1);
 
-	timestamp_end_sema_t_c = bench_timing_counter_get();
-	diff = bench_timing_cycles_get(&timestamp_start_sema_t_c,
-				       &timestamp_end_sema_t_c);
-	bench_stats_update(&take_times, diff, iteration);
+	timestamp_end_sema_t_c = bench_stamp_get();
+	bench_stats_update(&take_times, &timestamp_start_sema_t_c,
+			   &timestamp_end_sema_t_c, iteration);
 
-	timestamp_start_sema_g_c = bench_timing_counter_get();
+	timestamp_start_sema_g_c = bench_stamp_get();
 	bench_sem_give(0);
-	diff = bench_timing_cycles_get(&timestamp_start_sema_g_c,
-				       &timestamp_end_sema_g_c);
-	bench_stats_update(&give_times, diff, iteration);
+	bench_stats_update(&give_times, &timestamp_start_sema_g_c,
+			   &timestamp_end_sema_g_c, iteration);
 }
 
 /**
@@ -81,6 +77,7 @@ void bench_sem_context_switch_init(void *arg)
 
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		bench_sem_context_switch_low_prio_give(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
@@ -88,6 +85,8 @@ void bench_sem_context_switch_init(void *arg)
 	bench_stats_report_line("Take (context switch)", &take_times);
 	bench_stats_report_line("Give (context switch)", &give_times);
 
+	bench_stats_report_runtime();
+
 	bench_timing_stop();
 }
 
@@ -21,9 +21,8 @@ static struct bench_stats give_times;
 void bench_sem_signal_release()
 {
 	int i;
-	bench_time_t diff;
-	bench_time_t timestamp_start;
-	bench_time_t timestamp_end;
+	struct bench_stamp timestamp_start;
+	struct bench_stamp timestamp_end;
 
 	/* Measure average semaphore signal time */
 	bench_timing_start();
@@ -31,11 +30,13 @@ void bench_sem_signal_release()
 	bench_stats_report_title("Semaphore stats");
 
 	for (i = 1; i <= ITERATIONS; i++) {
-		timestamp_start = bench_timing_counter_get();
+		bench_iteration_start(i);
+
+		timestamp_start = bench_stamp_get();
 		bench_sem_give(0);
-		timestamp_end = bench_timing_counter_get();
-		diff = bench_timing_cycles_get(&timestamp_start, &timestamp_end);
-		bench_stats_update(&give_times, diff, i);
+		timestamp_end = bench_stamp_get();
+		bench_stats_update(&give_times, &timestamp_start, &timestamp_end,
+				   i);
 	}
 
 	bench_timing_stop();
@@ -47,16 +48,20 @@ void bench_sem_signal_release()
 	bench_stats_reset(&take_times);
 
 	for (i = 1; i <= ITERATIONS; i++) {
-		timestamp_start = bench_timing_counter_get();
+		bench_iteration_start(i);
+
+		timestamp_start = bench_stamp_get();
 		bench_sem_take(0);
-		timestamp_end = bench_timing_counter_get();
-		diff = bench_timing_cycles_get(&timestamp_start, &timestamp_end);
-		bench_stats_update(&take_times, diff, i);
+		timestamp_end = bench_stamp_get();
+		bench_stats_update(&take_times, &timestamp_start, &timestamp_end,
+				   i);
 	}
 
 	bench_timing_stop();
 
 	bench_stats_report_line("Take (no context switch)", &take_times);
+
+	bench_stats_report_runtime();
 }
 
 /**
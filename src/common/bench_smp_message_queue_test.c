@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure cross-CPU message queue latency
+ *
+ * This file contains the test that measures the time from sending a
+ * message on CPU 0 until the thread waiting to receive it has the
+ * message. The receiving thread is pinned either to CPU 0 (for reference)
+ * or to CPU 1.
+ *
+ * The timing counter must be synchronized across CPUs.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#if RTOS_HAS_MESSAGE_QUEUE
+
+#define MAIN_PRIORITY     (BENCH_LAST_PRIORITY - 3)
+#define RECEIVER_PRIORITY (MAIN_PRIORITY - 2)
+#define SENDER_PRIORITY   (MAIN_PRIORITY - 1)
+
+#define THREAD_SENDER     1
+#define THREAD_RECEIVER   2
+
+#define SEM_ACK           0
+#define SEM_DONE          1
+
+#define MSG_NUM           1
+#define MSG_LEN           1
+#define MQ_NAME           "bench_smp_message_queue"
+#define MQ_ID             0
+
+#define SENDER_CPU        0
+#define REMOTE_CPU        1
+
+/* Time given to the receiver to block before a message is sent */
+#define SETTLE_NS         20000
+
+static char msg_send_buf[MSG_LEN + 1] = "1";
+static char msg_rcv_buf[MSG_LEN + 1];
+
+static volatile struct bench_stamp timestamp_send;
+
+static struct bench_stats transfer_times;
+
+/**
+ * @brief Thread that receives the messages
+ */
+static void bench_smp_mq_receiver(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_message_queue_receive(MQ_ID, msg_rcv_buf, MSG_LEN);
+		end = bench_stamp_get();
+
+		start = timestamp_send;
+		bench_stats_update(&transfer_times, &start, &end, i);
+
+		bench_sem_give(SEM_ACK);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that sends the messages
+ */
+static void bench_smp_mq_sender(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_busy_wait_ns(SETTLE_NS);
+
+		timestamp_send = bench_stamp_get();
+		bench_message_queue_send(MQ_ID, msg_send_buf, MSG_LEN);
+
+		bench_sem_take(SEM_ACK);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather transfer stats for a receiver on @a cpu
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+static int gather_transfer_stats(int cpu)
+{
+	if ((bench_thread_cpu_set(THREAD_RECEIVER, cpu) != BENCH_SUCCESS) ||
+	    (bench_thread_cpu_set(THREAD_SENDER, SENDER_CPU) != BENCH_SUCCESS)) {
+		return BENCH_ERROR;
+	}
+
+	bench_stats_reset(&transfer_times);
+
+	bench_sem_create(SEM_ACK, 0, 1);
+	bench_sem_create(SEM_DONE, 0, 2);
+
+	bench_thread_create(THREAD_RECEIVER, "smp_receiver", RECEIVER_PRIORITY,
+			    bench_smp_mq_receiver, NULL);
+	bench_thread_start(THREAD_RECEIVER);
+	bench_thread_create(THREAD_SENDER, "smp_sender", SENDER_PRIORITY,
+			    bench_smp_mq_sender, NULL);
+	bench_thread_start(THREAD_SENDER);
+
+	bench_sem_take(SEM_DONE);
+	bench_sem_take(SEM_DONE);
+
+	bench_collect_resources();
+
+	return BENCH_SUCCESS;
+}
+
+#endif /* RTOS_HAS_MESSAGE_QUEUE */
+
+/**
+ * @brief Test setup function
+ */
+void bench_smp_message_queue_init(void *arg)
+{
+#if RTOS_HAS_MESSAGE_QUEUE
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("SMP message queue stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_message_queue_create(MQ_ID, MQ_NAME, MSG_NUM, MSG_LEN);
+
+	if (gather_transfer_stats(SENDER_CPU) == BENCH_SUCCESS) {
+		bench_stats_report_line("Send to receive (same CPU)",
+					&transfer_times);
+	} else {
+		bench_stats_report_na("Send to receive (same CPU)");
+	}
+
+	if ((bench_cpu_count() > REMOTE_CPU) &&
+	    (gather_transfer_stats(REMOTE_CPU) == BENCH_SUCCESS)) {
+		bench_stats_report_line("Send to receive (other CPU)",
+					&transfer_times);
+	} else {
+		bench_stats_report_na("Send to receive (other CPU)");
+	}
+
+	bench_message_queue_delete(MQ_ID, MQ_NAME);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+#else
+	bench_stats_report_title("SMP message queue stats");
+
+	bench_stats_report_na("Send to receive (same CPU)");
+	bench_stats_report_na("Send to receive (other CPU)");
+#endif
+}
+
+#ifdef RUN_SMP_MESSAGE_QUEUE
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_smp_message_queue_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure mutex contention across CPUs
+ *
+ * This file contains the test that measures how a mutex scales as 1, 2, 4
+ * and 8 CPUs contend for it. One worker thread is pinned to each CPU and
+ * repeatedly locks and unlocks the same mutex. Two metrics are gathered:
+ *
+ *   - the time each worker waits to acquire the mutex, and
+ *   - the interval between consecutive acquisitions by any worker, whose
+ *     average is the inverse of the aggregate throughput.
+ *
+ * The samples are recorded while holding the mutex, so the recording is
+ * part of the critical section.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 3)
+#define WORKER_PRIORITY (MAIN_PRIORITY + 1)
+
+#define MAX_WORKERS     8
+
+#define THREAD_WORKER   1   /* ID of the first worker thread */
+
+#define SEM_START       0
+#define SEM_DONE        1
+
+#define MUTEX_ID        0
+
+static const char *lock_summaries[] = {
+	"Lock (1 CPU)",
+	"Lock (2 CPUs contending)",
+	"Lock (4 CPUs contending)",
+	"Lock (8 CPUs contending)",
+};
+
+static const char *interval_summaries[] = {
+	"Acquire interval (1 CPU)",
+	"Acquire interval (2 CPUs contending)",
+	"Acquire interval (4 CPUs contending)",
+	"Acquire interval (8 CPUs contending)",
+};
+
+#define NUM_LEVELS  (sizeof(lock_summaries) / sizeof(lock_summaries[0]))
+
+/* Protected by the mutex under test */
+static uint32_t acquisitions;
+static struct bench_stamp timestamp_last_acquired;
+
+static struct bench_stats lock_times;
+static struct bench_stats interval_times;
+
+/**
+ * @brief Worker thread that hammers the mutex
+ */
+static void bench_smp_mutex_worker(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	bench_sem_take(SEM_START);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		start = bench_stamp_get();
+		bench_mutex_lock(MUTEX_ID);
+		end = bench_stamp_get();
+
+		acquisitions++;
+		bench_stats_update(&lock_times, &start, &end, acquisitions);
+
+		if (acquisitions > 1) {
+			start = timestamp_last_acquired;
+			bench_stats_update(&interval_times, &start, &end,
+					   acquisitions - 1);
+		}
+		timestamp_last_acquired = end;
+
+		bench_mutex_unlock(MUTEX_ID);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather stats with @a num_workers workers on as many CPUs
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+static int gather_contention_stats(int num_workers)
+{
+	int i;
+
+	for (i = 0; i < num_workers; i++) {
+		if (bench_thread_cpu_set(THREAD_WORKER + i, i) != BENCH_SUCCESS) {
+			return BENCH_ERROR;
+		}
+	}
+
+	bench_stats_reset(&lock_times);
+	bench_stats_reset(&interval_times);
+	acquisitions = 0;
+
+	/*
+	 * The workers have a lower priority than this thread. They all
+	 * start once they have been released and this thread blocks.
+	 */
+
+	for (i = 0; i < num_workers; i++) {
+		bench_thread_create(THREAD_WORKER + i, "smp_mutex_worker",
+				    WORKER_PRIORITY, bench_smp_mutex_worker, NULL);
+		bench_thread_start(THREAD_WORKER + i);
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		bench_sem_give(SEM_START);
+	}
+
+	for (i = 0; i < num_workers; i++) {
+		bench_sem_take(SEM_DONE);
+	}
+
+	bench_collect_resources();
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_smp_mutex_init(void *arg)
+{
+	uint32_t level;
+	int num_workers;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("SMP mutex stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_sem_create(SEM_START, 0, MAX_WORKERS);
+	bench_sem_create(SEM_DONE, 0, MAX_WORKERS);
+	bench_mutex_create(MUTEX_ID);
+
+	for (level = 0, num_workers = 1; level < NUM_LEVELS;
+	     level++, num_workers *= 2) {
+		if ((num_workers <= bench_cpu_count()) &&
+		    (gather_contention_stats(num_workers) == BENCH_SUCCESS)) {
+			bench_stats_report_line(lock_summaries[level],
+						&lock_times);
+			bench_stats_report_line(interval_summaries[level],
+						&interval_times);
+		} else {
+			bench_stats_report_na(lock_summaries[level]);
+			bench_stats_report_na(interval_summaries[level]);
+		}
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_SMP_MUTEX
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_smp_mutex_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
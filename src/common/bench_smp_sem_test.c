@@ -0,0 +1,199 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure cross-CPU semaphore wakeup latency
+ *
+ * This file contains the test that measures the time from giving a
+ * semaphore on CPU 0 until the thread waiting for it runs. The waiting
+ * thread is pinned either to CPU 0 (for reference) or to CPU 1. On CPU 1
+ * it is measured both with the CPU idle and with a lower priority thread
+ * spinning on it, in which case the waiter can only run after an
+ * inter-processor interrupt (IPI) has preempted the spinning thread.
+ *
+ * The timing counter must be synchronized across CPUs.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 3)
+#define WAITER_PRIORITY (MAIN_PRIORITY - 2)
+#define WAKER_PRIORITY  (MAIN_PRIORITY - 1)
+#define BUSY_PRIORITY   (MAIN_PRIORITY + 1)
+
+#define THREAD_WAKER    1
+#define THREAD_WAITER   2
+#define THREAD_BUSY     3
+
+#define SEM_WAKE        0
+#define SEM_ACK         1
+#define SEM_DONE        2
+
+#define WAKER_CPU       0
+#define REMOTE_CPU      1
+
+/* Time given to the waiter to block before it is woken */
+#define SETTLE_NS       20000
+
+static volatile struct bench_stamp timestamp_give;
+static volatile bool busy_stop;
+
+static struct bench_stats wake_times;
+
+/**
+ * @brief Thread that waits for the semaphore
+ */
+static void bench_smp_sem_waiter(void *args)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_sem_take(SEM_WAKE);
+		end = bench_stamp_get();
+
+		start = timestamp_give;
+		bench_stats_update(&wake_times, &start, &end, i);
+
+		bench_sem_give(SEM_ACK);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that gives the semaphore
+ */
+static void bench_smp_sem_waker(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_busy_wait_ns(SETTLE_NS);
+
+		timestamp_give = bench_stamp_get();
+		bench_sem_give(SEM_WAKE);
+
+		bench_sem_take(SEM_ACK);
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Thread that keeps its CPU busy until told to stop
+ */
+static void bench_smp_sem_busy(void *args)
+{
+	ARG_UNUSED(args);
+
+	while (!busy_stop) {
+	}
+
+	bench_sem_give(SEM_DONE);
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather wakeup stats for a waiter on @a cpu
+ *
+ * @return BENCH_SUCCESS on success or BENCH_ERROR on failure
+ */
+static int gather_wake_stats(int cpu, bool busy)
+{
+	if ((bench_thread_cpu_set(THREAD_WAITER, cpu) != BENCH_SUCCESS) ||
+	    (bench_thread_cpu_set(THREAD_WAKER, WAKER_CPU) != BENCH_SUCCESS) ||
+	    (busy && (bench_thread_cpu_set(THREAD_BUSY, cpu) != BENCH_SUCCESS))) {
+		return BENCH_ERROR;
+	}
+
+	bench_stats_reset(&wake_times);
+
+	bench_sem_create(SEM_WAKE, 0, 1);
+	bench_sem_create(SEM_ACK, 0, 1);
+	bench_sem_create(SEM_DONE, 0, 3);
+
+	if (busy) {
+		busy_stop = false;
+		bench_thread_create(THREAD_BUSY, "smp_busy", BUSY_PRIORITY,
+				    bench_smp_sem_busy, NULL);
+		bench_thread_start(THREAD_BUSY);
+	}
+
+	bench_thread_create(THREAD_WAITER, "smp_waiter", WAITER_PRIORITY,
+			    bench_smp_sem_waiter, NULL);
+	bench_thread_start(THREAD_WAITER);
+	bench_thread_create(THREAD_WAKER, "smp_waker", WAKER_PRIORITY,
+			    bench_smp_sem_waker, NULL);
+	bench_thread_start(THREAD_WAKER);
+
+	bench_sem_take(SEM_DONE);
+	bench_sem_take(SEM_DONE);
+
+	if (busy) {
+		busy_stop = true;
+		bench_sem_take(SEM_DONE);
+	}
+
+	bench_collect_resources();
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_smp_sem_init(void *arg)
+{
+	bool smp = (bench_cpu_count() > REMOTE_CPU);
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("SMP semaphore stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	if (gather_wake_stats(WAKER_CPU, false) == BENCH_SUCCESS) {
+		bench_stats_report_line("Wake (same CPU)", &wake_times);
+	} else {
+		bench_stats_report_na("Wake (same CPU)");
+	}
+
+	if (smp && (gather_wake_stats(REMOTE_CPU, false) == BENCH_SUCCESS)) {
+		bench_stats_report_line("Wake (other CPU, idle)", &wake_times);
+	} else {
+		bench_stats_report_na("Wake (other CPU, idle)");
+	}
+
+	if (smp && (gather_wake_stats(REMOTE_CPU, true) == BENCH_SUCCESS)) {
+		bench_stats_report_line("Wake (other CPU, IPI preempt)",
+					&wake_times);
+	} else {
+		bench_stats_report_na("Wake (other CPU, IPI preempt)");
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_SMP_SEM
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_smp_sem_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
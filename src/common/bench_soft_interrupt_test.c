@@ -0,0 +1,221 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure interrupt costs with a software-triggered interrupt
+ *
+ * This file contains the test that raises interrupts with
+ * bench_irq_offload() rather than with the system timer, so it runs on
+ * boards whose timer ISR cannot be replaced. It measures
+ *
+ *   - the time from a thread raising the interrupt until the handler runs,
+ *   - the time from the handler finishing until the thread runs again, and
+ *   - with the handler giving a semaphore on which a higher priority thread
+ *     waits, the time until that thread returns from bench_sem_take(): from
+ *     the interrupt being raised, from the handler giving the semaphore, and
+ *     from the handler finishing.
+ *
+ * Where giving the semaphore switches to the thread at once, the handler
+ * has not finished when the thread runs, and the last of these is n/a.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
+
+#define THREAD_HIGH   1
+
+#define SEM_ID        0
+
+static volatile struct bench_stamp timestamp_isr_start;
+static volatile struct bench_stamp timestamp_isr_give;
+static volatile struct bench_stamp timestamp_isr_end;
+static volatile struct bench_stamp timestamp_wake;
+
+static volatile bool isr_done;
+static volatile bool isr_done_at_wake;
+
+static struct bench_stats entry_times;
+static struct bench_stats exit_times;
+static struct bench_stats end_to_end_times;
+
+/**
+ * @brief Handler that just records when it starts and finishes
+ */
+static void entry_isr(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	timestamp_isr_start = bench_stamp_get();
+	timestamp_isr_end = bench_stamp_get();
+}
+
+/**
+ * @brief Handler that wakes the higher priority thread
+ */
+static void signal_isr(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	timestamp_isr_give = bench_stamp_get();
+	bench_sem_give_from_isr(SEM_ID);
+	timestamp_isr_end = bench_stamp_get();
+	isr_done = true;
+}
+
+/**
+ * @brief Gather stats for entering and leaving the interrupt
+ *
+ * @return false if interrupts cannot be raised by software
+ */
+static bool gather_no_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp isr_start;
+	struct bench_stamp isr_end;
+	struct bench_stamp end;
+	uint32_t i;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		if (bench_irq_offload(entry_isr, NULL) != BENCH_SUCCESS) {
+			return false;
+		}
+		end = bench_stamp_get();
+
+		isr_start = timestamp_isr_start;
+		isr_end = timestamp_isr_end;
+		bench_stats_update(&entry_times, &start, &isr_start, i);
+		bench_stats_update(&exit_times, &isr_end, &end, i);
+	}
+
+	return true;
+}
+
+/**
+ * @brief High priority thread woken by the interrupt handler
+ */
+static void bench_soft_interrupt_waiter(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_sem_take(SEM_ID);
+		timestamp_wake = bench_stamp_get();
+		isr_done_at_wake = isr_done;
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather stats for the interrupt waking a higher priority thread
+ *
+ * The woken thread has run and is waiting again by the time
+ * bench_irq_offload() returns.
+ */
+static void gather_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp isr_give;
+	struct bench_stamp isr_end;
+	struct bench_stamp wake;
+	uint32_t i;
+
+	bench_thread_create(THREAD_HIGH, "soft_irq_waiter", MAIN_PRIORITY - 1,
+			    bench_soft_interrupt_waiter, NULL);
+	bench_thread_start(THREAD_HIGH);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		isr_done = false;
+
+		start = bench_stamp_get();
+		bench_irq_offload(signal_isr, NULL);
+
+		isr_give = timestamp_isr_give;
+		isr_end = timestamp_isr_end;
+		wake = timestamp_wake;
+
+		bench_stats_update(&end_to_end_times, &start, &wake, i);
+		bench_stats_update(&entry_times, &isr_give, &wake, i);
+
+		if (isr_done_at_wake) {
+			bench_stats_update(&exit_times, &isr_end, &wake,
+					   exit_times.count + 1);
+		}
+	}
+
+	bench_collect_resources();
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_soft_interrupt_init(void *arg)
+{
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Software interrupt stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_stats_reset(&entry_times);
+	bench_stats_reset(&exit_times);
+
+	if (!gather_no_switch_stats()) {
+		bench_stats_report_na("Interrupt entry");
+		bench_stats_report_na("Interrupt exit");
+		bench_stats_report_na("Interrupt to thread (context switch)");
+		bench_stats_report_na("ISR to thread (context switch)");
+		bench_stats_report_na("ISR exit to thread (context switch)");
+		bench_timing_stop();
+		return;
+	}
+
+	bench_stats_report_line("Interrupt entry", &entry_times);
+	bench_stats_report_line("Interrupt exit", &exit_times);
+
+	bench_stats_reset(&entry_times);
+	bench_stats_reset(&exit_times);
+	bench_stats_reset(&end_to_end_times);
+
+	bench_sem_create(SEM_ID, 0, 1);
+
+	gather_switch_stats();
+
+	bench_stats_report_line("Interrupt to thread (context switch)",
+				&end_to_end_times);
+	bench_stats_report_line("ISR to thread (context switch)",
+				&entry_times);
+
+	if (exit_times.count != 0) {
+		bench_stats_report_line("ISR exit to thread (context switch)",
+					&exit_times);
+	} else {
+		bench_stats_report_na("ISR exit to thread (context switch)");
+	}
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_SOFT_INTERRUPT
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_soft_interrupt_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure software timer latency as the number of armed timers grows
+ *
+ * This file contains the test that arms 0, 9, 99 and 999 software timers
+ * that expire long after the test ends, so that 1, 10, 100 and 1000 timers
+ * are active with the one being measured, and reports for each count
+ *
+ *   - how late the callbacks of a periodic timer run, and
+ *   - the cost of starting and stopping a timer that expires after all the
+ *     armed ones.
+ *
+ * Counts above BENCH_SOFT_TIMER_MAX_NUM report n/a.
+ *
+ * The period is SOFT_TIMER_PERIOD_US rounded up to whole ticks, as the RTOS
+ * would round it. The timer is started just after a tick, and the k-th
+ * callback is due k of those periods after that. The lateness therefore
+ * includes any constant delay the RTOS adds to the first expiry, such as the
+ * extra tick Zephyr waits, and grows if the tick drifts from the timing
+ * counter.
+ *
+ * With a tick longer than SOFT_TIMER_PERIOD_US, fewer callbacks are timed,
+ * so that each count takes about SOFT_TIMER_SAMPLES periods of
+ * SOFT_TIMER_PERIOD_US even with a slow tick. At least 2 are always timed.
+ * On Zephyr, building this test on its own raises the tick to 1000 Hz.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#ifndef SOFT_TIMER_PERIOD_US
+#define SOFT_TIMER_PERIOD_US  10000
+#endif
+
+#ifndef SOFT_TIMER_SAMPLES
+#define SOFT_TIMER_SAMPLES    100
+#endif
+
+#if SOFT_TIMER_SAMPLES < 2
+#error "SOFT_TIMER_SAMPLES must be at least 2"
+#endif
+
+#define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
+
+#define TIMER_MEASURED  0   /* ID of the timer being measured */
+#define TIMER_ARMED     1   /* ID of the first armed timer */
+
+#define SEM_ID          0
+
+/* The armed timers expire in turn, all after the test ends */
+#define ARMED_DELAY_US    3000000000U
+#define ARMED_SPACING_US  1000U
+
+/* The started and stopped timer expires after all the armed ones */
+#define PROBE_DELAY_US    4000000000U
+
+static const int timer_counts[] = { 1, 10, 100, 1000 };
+
+static const char *lateness_strings[] = {
+	"Callback lateness (1 timer)",
+	"Callback lateness (10 timers)",
+	"Callback lateness (100 timers)",
+	"Callback lateness (1000 timers)",
+};
+
+static const char *start_strings[] = {
+	"Start (1 timer)",
+	"Start (10 timers)",
+	"Start (100 timers)",
+	"Start (1000 timers)",
+};
+
+static const char *stop_strings[] = {
+	"Stop (1 timer)",
+	"Stop (10 timers)",
+	"Stop (100 timers)",
+	"Stop (1000 timers)",
+};
+
+#define NUM_LEVELS  (sizeof(timer_counts) / sizeof(timer_counts[0]))
+
+static volatile uint32_t callback_count;
+static bench_time_t callback_times[SOFT_TIMER_SAMPLES];
+
+static uint32_t timer_period_us;
+static bench_time_t timer_period_cycles;
+static uint32_t timer_samples;
+
+static int timers_created;
+static int timers_armed;
+
+static struct bench_stats lateness_times;
+static struct bench_stats start_times;
+static struct bench_stats stop_times;
+
+/**
+ * @brief Callback of the measured timer
+ */
+static void measured_callback(void *arg)
+{
+	uint32_t count = callback_count;
+
+	ARG_UNUSED(arg);
+
+	if (count < timer_samples) {
+		callback_times[count] = bench_timing_counter_get();
+		callback_count = count + 1;
+
+		if (count + 1 == timer_samples) {
+			bench_sem_give_from_isr(SEM_ID);
+		}
+	}
+}
+
+/**
+ * @brief Callback of the armed timers, which never expire during the test
+ */
+static void armed_callback(void *arg)
+{
+	ARG_UNUSED(arg);
+}
+
+/**
+ * @brief Create and start armed timers until @a num_armed are active
+ *
+ * @return false if the timers cannot be created or started
+ */
+static bool timers_arm(int num_armed)
+{
+	int id;
+
+	while (timers_armed < num_armed) {
+		id = TIMER_ARMED + timers_armed;
+
+		if (timers_created <= timers_armed) {
+			if (bench_soft_timer_create(id, armed_callback,
+						    NULL) != BENCH_SUCCESS) {
+				return false;
+			}
+			timers_created++;
+		}
+
+		if (bench_soft_timer_start(id, ARMED_DELAY_US +
+					   timers_armed * ARMED_SPACING_US,
+					   false) != BENCH_SUCCESS) {
+			return false;
+		}
+		timers_armed++;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Round the period up to whole ticks and pick the number of callbacks
+ */
+static void timer_period_scale(void)
+{
+	uint32_t tick_us = bench_tick_period_us();
+	uint64_t samples;
+
+	if (tick_us == 0) {
+		tick_us = 1;
+	}
+
+	timer_period_us = ((SOFT_TIMER_PERIOD_US + tick_us - 1) / tick_us) *
+			  tick_us;
+	timer_period_cycles = (timer_period_us * 1000ULL * 1000000) /
+			      bench_timing_cycles_to_ns(1000000);
+
+	samples = ((uint64_t)SOFT_TIMER_SAMPLES * SOFT_TIMER_PERIOD_US) /
+		  timer_period_us;
+	timer_samples = (samples < 2) ? 2 : (uint32_t)samples;
+}
+
+/**
+ * @brief Gather stats for the lateness of the measured timer's callbacks
+ *
+ * @return false if the timer cannot be started
+ */
+static bool gather_lateness_stats(void)
+{
+	bench_time_t start;
+	bench_time_t elapsed;
+	int64_t offset;
+	uint32_t i;
+
+	callback_count = 0;
+
+	bench_tick_align();
+	start = bench_timing_counter_get();
+
+	if (bench_soft_timer_start(TIMER_MEASURED, timer_period_us,
+				   true) != BENCH_SUCCESS) {
+		return false;
+	}
+
+	bench_sem_take(SEM_ID);
+	bench_soft_timer_stop(TIMER_MEASURED);
+
+	/* The stats hold lateness, not durations, so skip the overhead */
+
+	for (i = 0; i < timer_samples; i++) {
+		elapsed = bench_timing_cycles_get(&start, &callback_times[i]);
+		offset = (int64_t)(elapsed - (i + 1) * timer_period_cycles);
+		bench_stats_update_raw(&lateness_times,
+				       (offset > 0) ? (bench_time_t)offset : 0,
+				       i + 1);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Gather stats for starting and stopping a timer
+ */
+static void gather_start_stop_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp mid;
+	struct bench_stamp end;
+	uint32_t i;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		bench_soft_timer_start(TIMER_MEASURED, PROBE_DELAY_US, false);
+		mid = bench_stamp_get();
+		bench_soft_timer_stop(TIMER_MEASURED);
+		end = bench_stamp_get();
+
+		bench_stats_update(&start_times, &start, &mid, i);
+		bench_stats_update(&stop_times, &mid, &end, i);
+	}
+}
+
+/**
+ * @brief Gather and report the stats with @a num_timers timers active
+ *
+ * @return false if the timers cannot be created or started
+ */
+static bool gather_level_stats(uint32_t level, int num_timers)
+{
+	if ((num_timers > BENCH_SOFT_TIMER_MAX_NUM) ||
+	    !timers_arm(num_timers - 1)) {
+		return false;
+	}
+
+	bench_stats_reset(&lateness_times);
+
+	if (!gather_lateness_stats()) {
+		return false;
+	}
+
+	bench_stats_report_line(lateness_strings[level], &lateness_times);
+
+	bench_stats_reset(&start_times);
+	bench_stats_reset(&stop_times);
+
+	gather_start_stop_stats();
+
+	bench_stats_report_line(start_strings[level], &start_times);
+	bench_stats_report_line(stop_strings[level], &stop_times);
+
+	return true;
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_soft_timer_init(void *arg)
+{
+	uint32_t level;
+	bool supported;
+	int id;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Software timer stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_sem_create(SEM_ID, 0, 1);
+
+	timers_created = 0;
+	timers_armed = 0;
+
+	timer_period_scale();
+
+	supported = (bench_soft_timer_create(TIMER_MEASURED, measured_callback,
+					     NULL) == BENCH_SUCCESS);
+
+	for (level = 0; level < NUM_LEVELS; level++) {
+		if (supported) {
+			supported = gather_level_stats(level,
+						       timer_counts[level]);
+			if (supported) {
+				continue;
+			}
+		}
+
+		bench_stats_report_na(lateness_strings[level]);
+		bench_stats_report_na(start_strings[level]);
+		bench_stats_report_na(stop_strings[level]);
+	}
+
+	for (id = TIMER_ARMED; id < TIMER_ARMED + timers_created; id++) {
+		bench_soft_timer_stop(id);
+		bench_soft_timer_delete(id);
+	}
+	bench_soft_timer_delete(TIMER_MEASURED);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_SOFT_TIMER
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_soft_timer_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
@@ -22,7 +22,7 @@
 #define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 2)
 
 
-static bench_time_t  helper_start;
+static struct bench_stamp  helper_start;
 
 static struct bench_stats time_to_yield;
 
@@ -49,7 +49,7 @@ static void bench_set2_helper(void *args)
 
 	bench_yield();
 
-	helper_start = bench_timing_counter_get();
+	helper_start = bench_stamp_get();
 
 	bench_yield();
 
@@ -62,7 +62,7 @@ static void bench_set2_helper(void *args)
  */
 static void gather_set2_stats(int priority, uint32_t iteration)
 {
-	bench_time_t  end;
+	struct bench_stamp  end;
 
 	/*
 	 * Create and start the low priority helper thread. As it is of
@@ -83,11 +83,9 @@ static void gather_set2_stats(int priority, uint32_t iteration)
 	bench_yield();
 
 	bench_yield();
-	end   = bench_timing_counter_get();
+	end   = bench_stamp_get();
 
-	bench_stats_update(&time_to_yield,
-			   bench_timing_cycles_get(&helper_start, &end),
-			   iteration);
+	bench_stats_update(&time_to_yield, &helper_start, &end, iteration);
 
 	/*
 	 * Abort lower priority thread, it's done its job.
@@ -112,8 +110,8 @@ static void bench_set1_helper(void *args)
  */
 static void gather_set1_stats(int priority, uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
 
 	/*
 	 * Create and start the low priority helper thread. As it is of
@@ -125,13 +123,11 @@ static void gather_set1_stats(int priority, uint32_t iteration)
 			    priority + 1, bench_set1_helper, NULL);
 	bench_thread_start(THREAD_LOW);
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_yield();
-	end   = bench_timing_counter_get();
+	end   = bench_stamp_get();
 
-	bench_stats_update(&time_to_yield,
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+	bench_stats_update(&time_to_yield, &start, &end, iteration);
 
 	/*
 	 * Abort lower priority thread, it's done its job.
@@ -163,6 +159,7 @@ void bench_thread_yield(void *arg)
 	bench_timing_start();
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_set1_stats(MAIN_PRIORITY, i);
 	}
 
@@ -171,12 +168,15 @@ void bench_thread_yield(void *arg)
 	reset_time_stats();
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_set2_stats(MAIN_PRIORITY, i);
 	}
 
 	bench_timing_stop();
 
 	bench_stats_report_line("Yield (context switch)", &time_to_yield);
+
+	bench_stats_report_runtime();
 }
 
 #ifdef RUN_THREAD_SWITCH_YIELD
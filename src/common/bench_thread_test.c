@@ -30,8 +30,8 @@
 
 #define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 2)    /* Priority of main thread in the system */
 
-static bench_time_t helper_start;        /* helper thread start timestamp */
-static bench_time_t helper_end;          /* helper thread end timestamp */
+static struct bench_stamp helper_start;        /* helper thread start timestamp */
+static struct bench_stamp helper_end;          /* helper thread end timestamp */
 
 /*
  * Each set of times are comprsied of the following:
@@ -72,7 +72,7 @@ static void bench_set2_helper(void *args)
 
 	/* End-timestamp for starting the thread */
 
-	helper_end = bench_timing_counter_get();
+	helper_end = bench_stamp_get();
 
 #if RTOS_HAS_SUSPEND_RESUME
 	/* Start suspending the thread. This causes a context switch. */
@@ -87,7 +87,7 @@ static void bench_set2_helper(void *args)
 	 */
 
 #endif
-	helper_end = bench_timing_counter_get();
+	helper_end = bench_stamp_get();
 	helper_start = helper_end;
 
 	bench_thread_exit();
@@ -100,7 +100,7 @@ static void bench_spawn_helper(void *args)
 {
 	ARG_UNUSED(args);
 
-	helper_end = bench_timing_counter_get();
+	helper_end = bench_stamp_get();
 	bench_thread_exit();
 }
 
@@ -115,8 +115,8 @@ static void bench_spawn_helper(void *args)
  */
 static void gather_set2_stats(int priority, uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
 
 #if RTOS_HAS_THREAD_CREATE_START
 	/* Create, but do not start the higher priority thread */
@@ -126,61 +126,51 @@ static void gather_set2_stats(int priority, uint32_t iteration)
 
 	/* Start the higher priority thread. This causes a context switch. */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_start(THREAD_HIGH);
 
 	/* Helper thread executed and then self-suspended. */
 
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 #else
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_spawn(THREAD_HIGH, "thread_suspend_resume",
 			   priority - 1, bench_set2_helper, NULL);
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 #endif
 
 #if RTOS_HAS_SUSPEND_RESUME
 	/* Update times for both starting and resuming the thread */
 
-	bench_stats_update(&time_to_start,
-			   bench_timing_cycles_get(&start, &helper_end),
-			   iteration);
-	bench_stats_update(&time_to_suspend,
-			   bench_timing_cycles_get(&helper_start, &end),
-			   iteration);
+	bench_stats_update(&time_to_start, &start, &helper_end, iteration);
+	bench_stats_update(&time_to_suspend, &helper_start, &end, iteration);
 
 	/* Resume the higher priority thread. This causes a context switch. */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_resume(THREAD_HIGH);
 #endif
 
 	/* Helper thread executed and then terminated. */
 
-	end = bench_timing_counter_get();
+	end = bench_stamp_get();
 
 	/* Update times for both starting and resuming the thread */
 
 #if RTOS_HAS_SUSPEND_RESUME
-	bench_stats_update(&time_to_resume,
-			   bench_timing_cycles_get(&start, &helper_end),
-			   iteration);
+	bench_stats_update(&time_to_resume, &start, &helper_end, iteration);
 #endif
 
-	bench_stats_update(&time_to_terminate,
-			   bench_timing_cycles_get(&helper_start, &end),
-			   iteration);
+	bench_stats_update(&time_to_terminate, &helper_start, &end, iteration);
 
 #if RTOS_HAS_THREAD_SPAWN
 
 	/* Spawn a higher priority thread. This causes a context switch. */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_spawn(THREAD_SPAWN, "thread_spawn",
 			   priority - 1, bench_spawn_helper, NULL);
-	bench_stats_update(&time_to_spawn,
-			   bench_timing_cycles_get(&start, &helper_end),
-			   iteration);
+	bench_stats_update(&time_to_spawn, &start, &helper_end, iteration);
 #endif
 }
 
@@ -207,46 +197,38 @@ static void bench_set1_helper(void *args)
 
 static void gather_set1_stats(int priority, uint32_t iteration)
 {
-	bench_time_t  start;
-	bench_time_t  end;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
 
 	/* Create, but do not start the lower priority thread */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_create(THREAD_LOW, "thread_suspend_resume",
 				priority + 1, bench_set1_helper, NULL);
-	end = bench_timing_counter_get();
-	bench_stats_update(&time_to_create,
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+	end = bench_stamp_get();
+	bench_stats_update(&time_to_create, &start, &end, iteration);
 
 	/* Start the lower priority thread, but do not schedule it */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_start(THREAD_LOW);
-	end = bench_timing_counter_get();
-	bench_stats_update(&time_to_start,
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+	end = bench_stamp_get();
+	bench_stats_update(&time_to_start, &start, &end, iteration);
 
 #if RTOS_HAS_SUSPEND_RESUME
 	/* Suspend the low priority thread (no context switch) */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_suspend(THREAD_LOW);
-	end = bench_timing_counter_get();
-	bench_stats_update(&time_to_suspend,
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+	end = bench_stamp_get();
+	bench_stats_update(&time_to_suspend, &start, &end, iteration);
 
 	/* Resume the low priority thread (no context switch) */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_resume(THREAD_LOW);
-	end = bench_timing_counter_get();
-	bench_stats_update(&time_to_resume,
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+	end = bench_stamp_get();
+	bench_stats_update(&time_to_resume, &start, &end, iteration);
 #endif
 
 	/*
@@ -261,13 +243,11 @@ static void gather_set1_stats(int priority, uint32_t iteration)
 
 	/* Spawn a low priority thread (no context switch) */
 
-	start = bench_timing_counter_get();
+	start = bench_stamp_get();
 	bench_thread_spawn(THREAD_SPAWN, "thread_spawn",
 			   priority + 1, bench_spawn_helper, NULL);
-	end = bench_timing_counter_get();
-	bench_stats_update(&time_to_spawn,
-			   bench_timing_cycles_get(&start, &end),
-			   iteration);
+	end = bench_stamp_get();
+	bench_stats_update(&time_to_spawn, &start, &end, iteration);
 
 	/* Abort lower priority thread. */
 
@@ -299,6 +279,7 @@ void bench_basic_thread_ops(void *arg)
 	bench_timing_start();
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_set1_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
@@ -342,6 +323,7 @@ void bench_basic_thread_ops(void *arg)
 	reset_time_stats();
 
 	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
 		gather_set2_stats(MAIN_PRIORITY, i);
 		bench_collect_resources();
 	}
@@ -373,6 +355,8 @@ void bench_basic_thread_ops(void *arg)
 #endif
 	bench_stats_report_line("Terminate (context switch)",
 				&time_to_terminate);
+
+	bench_stats_report_runtime();
 }
 
 #ifdef RUN_THREAD
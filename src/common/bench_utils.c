@@ -4,6 +4,118 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <string.h>
+
+/* Cost of a bench_timing_counter_get() pair, in cycles */
+static bench_time_t timing_overhead;
+
+/* Identifier handed out to a set of statistics when it is reset */
+static uint16_t trace_next_id;
+
+#if TRACE_SAMPLES > 0
+struct trace_entry {
+	uint32_t iteration;
+	uint32_t cycles;
+	uint16_t id;
+};
+
+static struct trace_entry trace_buffer[TRACE_SAMPLES];
+static uint32_t trace_head;     /* Index of the next entry to write */
+static bool trace_wrapped;      /* Oldest entries have been overwritten */
+
+/* Size of a serialized trace entry, in bytes */
+#define TRACE_RECORD_SIZE  10
+
+/* Bytes of trace data encoded per line of console output */
+#define TRACE_LINE_BYTES   48
+
+static const char base64_chars[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static inline void trace_record(uint16_t id, uint32_t iteration,
+				bench_time_t value)
+{
+	struct trace_entry *entry = &trace_buffer[trace_head];
+
+	entry->iteration = iteration;
+	entry->cycles = (value > UINT32_MAX) ? UINT32_MAX : (uint32_t)value;
+	entry->id = id;
+
+	if (++trace_head == TRACE_SAMPLES) {
+		trace_head = 0;
+		trace_wrapped = true;
+	}
+}
+
+/**
+ * @brief Print one line of base64 encoded trace data
+ */
+static void trace_line_print(const uint8_t *data, uint32_t len)
+{
+	char line[(TRACE_LINE_BYTES / 3) * 4 + 1];
+	uint32_t bits;
+	uint32_t i;
+	uint32_t n = 0;
+
+	for (i = 0; i < len; i += 3) {
+		bits = (uint32_t)data[i] << 16;
+		if (i + 1 < len) {
+			bits |= (uint32_t)data[i + 1] << 8;
+		}
+		if (i + 2 < len) {
+			bits |= data[i + 2];
+		}
+
+		line[n++] = base64_chars[(bits >> 18) & 0x3f];
+		line[n++] = base64_chars[(bits >> 12) & 0x3f];
+		line[n++] = (i + 1 < len) ? base64_chars[(bits >> 6) & 0x3f] : '=';
+		line[n++] = (i + 2 < len) ? base64_chars[bits & 0x3f] : '=';
+	}
+	line[n] = '\0';
+
+	PRINTF("TRACE %s\n\r", line);
+}
+#endif /* TRACE_SAMPLES > 0 */
+
+/**
+ * @brief Map a sample onto its histogram bucket
+ */
+static inline uint32_t hist_index(bench_time_t value)
+{
+	uint32_t msb;
+
+	if (value < BENCH_HIST_SUB_COUNT) {
+		return (uint32_t)value;
+	}
+
+	if ((value >> BENCH_HIST_MAX_BITS) != 0) {
+		return BENCH_HIST_BUCKETS - 1;
+	}
+
+	msb = 63 - __builtin_clzll((unsigned long long)value);
+
+	return ((msb - BENCH_HIST_SUB_BITS + 1) << BENCH_HIST_SUB_BITS) +
+	       ((uint32_t)(value >> (msb - BENCH_HIST_SUB_BITS)) &
+		(BENCH_HIST_SUB_COUNT - 1));
+}
+
+/**
+ * @brief Get the value representing a histogram bucket (its midpoint)
+ */
+static bench_time_t hist_value(uint32_t index)
+{
+	uint32_t group = index >> BENCH_HIST_SUB_BITS;
+	uint32_t sub = index & (BENCH_HIST_SUB_COUNT - 1);
+	bench_time_t low;
+
+	if (group == 0) {
+		return sub;
+	}
+
+	low = (bench_time_t)(BENCH_HIST_SUB_COUNT + sub) << (group - 1);
+
+	return low + (((bench_time_t)1 << (group - 1)) >> 1);
+}
 
 void bench_stats_reset(struct bench_stats *stats)
 {
@@ -11,11 +123,26 @@ void bench_stats_reset(struct bench_stats *stats)
 	stats->min = (bench_time_t) -1;
 	stats->max = 0;
 	stats->total = 0;
+	stats->sumsq_lo = 0;
+	stats->sumsq_hi = 0;
+	stats->count = 0;
+	stats->ticked = 0;
+	stats->ticked_max = 0;
+	memset(stats->hist, 0, sizeof(stats->hist));
+
+	/* ID 0 means "not traced", so skip it when the IDs wrap around */
+	if (++trace_next_id == 0) {
+		trace_next_id = 1;
+	}
+	stats->trace_id = trace_next_id;
 }
 
-void bench_stats_update(struct bench_stats *stats, bench_time_t value,
-			uint32_t iteration)
+void bench_stats_update_raw(struct bench_stats *stats, bench_time_t value,
+			    uint32_t iteration)
 {
+	uint64_t clamped = (value > UINT32_MAX) ? UINT32_MAX : value;
+	uint64_t square = clamped * clamped;
+
 	assert(iteration != 0);
 
 	if (value < stats->min)
@@ -25,28 +152,425 @@ void bench_stats_update(struct bench_stats *stats, bench_time_t value,
 		stats->max = value;
 
 	stats->total += value;
-	stats->avg = stats->total / iteration;
+	stats->count++;
+	stats->avg = stats->total / stats->count;
+
+	stats->sumsq_lo += square;
+	if (stats->sumsq_lo < square) {
+		stats->sumsq_hi++;
+	}
+
+	stats->hist[hist_index(value)]++;
+
+#if TRACE_SAMPLES > 0
+	if (stats->trace_id != 0) {
+		trace_record(stats->trace_id, iteration, value);
+	}
+#endif
+}
+
+void bench_stats_update_cycles(struct bench_stats *stats, bench_time_t value,
+			       uint32_t iteration, bool ticked)
+{
+	value = (value > timing_overhead) ? (value - timing_overhead) : 0;
+
+	if (ticked) {
+		stats->ticked++;
+		if (value > stats->ticked_max) {
+			stats->ticked_max = value;
+		}
+		return;
+	}
+
+	bench_stats_update_raw(stats, value, iteration);
+}
+
+void bench_stats_update(struct bench_stats *stats,
+			const struct bench_stamp *start,
+			const struct bench_stamp *end, uint32_t iteration)
+{
+	bench_stats_update_cycles(stats, bench_stamp_cycles(start, end),
+				  iteration, bench_stamp_ticked(start, end));
 }
 
-void bench_stats_report_title(const char *title)
+void bench_tick_align(void)
 {
-	PRINTF("** %s [avg, min, max] in nanoseconds **\n\r", title);
+	uint64_t tick = bench_tick_count_get();
+
+	while (bench_tick_count_get() == tick) {
+	}
 }
 
-void bench_stats_report_line(const char *summary, const struct bench_stats *stats)
+uint32_t bench_tick_period_us(void)
 {
-	PRINTF(" %-40s: %6llu, %6llu, %6llu\n\r", summary,
-	       bench_timing_cycles_to_ns(stats->avg),
-	       bench_timing_cycles_to_ns(stats->min),
-	       bench_timing_cycles_to_ns(stats->max));
+	bench_time_t start;
+	bench_time_t end;
+
+	bench_tick_align();
+	start = bench_timing_counter_get();
+	bench_tick_align();
+	end = bench_timing_counter_get();
+
+	return (uint32_t)((bench_timing_cycles_to_ns(
+			bench_timing_cycles_get(&start, &end)) + 500) / 1000);
 }
 
-void bench_stats_report_na(const char *summary)
+void bench_iteration_start(uint32_t iteration)
 {
-	PRINTF(" %-40s: %6s, %6s, %6s\n\r", summary, "n/a", "n/a", "n/a");
+#if TICK_REALIGN > 0
+	if ((iteration % TICK_REALIGN) == 0) {
+		bench_tick_align();
+	}
+#else
+	ARG_UNUSED(iteration);
+#endif
+}
+
+void bench_trace_dump(const char *test, const char *summary,
+		      const struct bench_stats *stats)
+{
+#if TRACE_SAMPLES > 0
+	uint8_t data[TRACE_LINE_BYTES];
+	const struct trace_entry *entry;
+	uint32_t len = 0;
+	uint32_t count = 0;
+	uint32_t index;
+	uint32_t i;
+	uint32_t j;
+
+	if (stats->trace_id == 0) {
+		return;
+	}
+
+	/*
+	 * Record layout (little endian):
+	 * [0..1] metric ID, [2..5] iteration, [6..9] cycles
+	 */
+
+	PRINTF("TRACE-BEGIN id=%u ns_per_mcycle=%llu test=\"%s\" "
+	       "metric=\"%s\"\n\r", (unsigned int)stats->trace_id,
+	       (unsigned long long)bench_timing_cycles_to_ns(1000000),
+	       test, summary);
+
+	index = trace_wrapped ? trace_head : 0;
+	for (i = 0; i < (trace_wrapped ? TRACE_SAMPLES : trace_head); i++) {
+		entry = &trace_buffer[index];
+		if (++index == TRACE_SAMPLES) {
+			index = 0;
+		}
+
+		if (entry->id != stats->trace_id) {
+			continue;
+		}
+
+		for (j = 0; j < 2; j++) {
+			data[len++] = (uint8_t)(entry->id >> (8 * j));
+		}
+		for (j = 0; j < 4; j++) {
+			data[len++] = (uint8_t)(entry->iteration >> (8 * j));
+		}
+		for (j = 0; j < 4; j++) {
+			data[len++] = (uint8_t)(entry->cycles >> (8 * j));
+		}
+		count++;
+
+		/* Flush whenever the next record might not fit */
+
+		if (len + TRACE_RECORD_SIZE > TRACE_LINE_BYTES) {
+			trace_line_print(data, len - (len % 3));
+			memmove(data, &data[len - (len % 3)], len % 3);
+			len %= 3;
+		}
+	}
+
+	if (len != 0) {
+		trace_line_print(data, len);
+	}
+
+	PRINTF("TRACE-END id=%u samples=%u lost=%u\n\r",
+	       (unsigned int)stats->trace_id, (unsigned int)count,
+	       (unsigned int)(stats->count - count));
+#else
+	ARG_UNUSED(test);
+	ARG_UNUSED(summary);
+	ARG_UNUSED(stats);
+#endif
+}
+
+void bench_timing_overhead_calibrate(void)
+{
+	static struct bench_stats overhead;
+	struct bench_stamp  start;
+	struct bench_stamp  end;
+	uint32_t  i;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	/* Keep the calibration samples out of the trace buffer */
+
+	bench_stats_reset(&overhead);
+	overhead.trace_id = 0;
+
+	for (i = 1; i <= CALIBRATION_LOOPS; i++) {
+		start = bench_stamp_get();
+		end = bench_stamp_get();
+
+		bench_stats_update_raw(&overhead,
+				       bench_stamp_cycles(&start, &end), i);
+	}
+
+	bench_timing_stop();
+
+	/*
+	 * Use the minimum so that no sample is over-corrected. The median is
+	 * reported (as p50) alongside it.
+	 */
+
+	timing_overhead = overhead.min;
+
+	bench_stats_report_title("Calibration");
+	bench_stats_report_line("Timer overhead (back-to-back read)",
+				&overhead);
+}
+
+bench_time_t bench_timing_overhead_get(void)
+{
+	return timing_overhead;
+}
+
+bench_time_t bench_stats_percentile(const struct bench_stats *stats,
+				    uint32_t ppm)
+{
+	uint64_t rank;
+	uint64_t seen = 0;
+	bench_time_t value;
+	uint32_t i;
+
+	if (stats->count == 0) {
+		return 0;
+	}
+
+	rank = ((uint64_t)stats->count * ppm + 999999) / 1000000;
+	if (rank == 0) {
+		rank = 1;
+	}
+
+	for (i = 0; i < BENCH_HIST_BUCKETS; i++) {
+		seen += stats->hist[i];
+		if (seen >= rank) {
+			break;
+		}
+	}
+
+	/* A bucket's midpoint may lie outside of the observed range */
+
+	value = hist_value(i);
+	if (value < stats->min) {
+		value = stats->min;
+	}
+	if (value > stats->max) {
+		value = stats->max;
+	}
+
+	return value;
+}
+
+/**
+ * @brief Integer square root
+ */
+static uint64_t isqrt64(uint64_t value)
+{
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while (bit > value) {
+		bit >>= 2;
+	}
+
+	while (bit != 0) {
+		if (value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+/*
+ * 128-bit unsigned arithmetic for the standard deviation, which 32-bit
+ * targets have no native type for.
+ */
+struct u128 {
+	uint64_t hi;
+	uint64_t lo;
+};
+
+/**
+ * @brief Multiply two 64-bit values into a 128-bit product
+ */
+static struct u128 u128_mul64(uint64_t a, uint64_t b)
+{
+	uint64_t a_lo = (uint32_t)a;
+	uint64_t a_hi = a >> 32;
+	uint64_t b_lo = (uint32_t)b;
+	uint64_t b_hi = b >> 32;
+	uint64_t ll = a_lo * b_lo;
+	uint64_t lh = a_lo * b_hi;
+	uint64_t hl = a_hi * b_lo;
+	uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+	struct u128 r;
+
+	r.lo = (mid << 32) | (uint32_t)ll;
+	r.hi = a_hi * b_hi + (lh >> 32) + (hl >> 32) + (mid >> 32);
+
+	return r;
+}
+
+/**
+ * @brief Get @a a - @a b, or 0 if @a b is larger
+ */
+static struct u128 u128_sub_sat(struct u128 a, struct u128 b)
+{
+	struct u128 r = { 0, 0 };
+
+	if ((a.hi > b.hi) || ((a.hi == b.hi) && (a.lo >= b.lo))) {
+		r.lo = a.lo - b.lo;
+		r.hi = a.hi - b.hi - ((a.lo < b.lo) ? 1 : 0);
+	}
+
+	return r;
+}
+
+/**
+ * @brief Divide a 128-bit value by a 64-bit one, for a quotient below 2^64
+ */
+static uint64_t u128_div64(struct u128 n, uint64_t d)
+{
+	uint64_t rem = n.hi;
+	uint64_t quot = 0;
+	bool carry;
+	int i;
+
+	for (i = 63; i >= 0; i--) {
+		carry = (rem >> 63) != 0;
+		rem = (rem << 1) | ((n.lo >> i) & 1);
+		quot <<= 1;
+		if (carry || (rem >= d)) {
+			rem -= d;
+			quot |= 1;
+		}
+	}
+
+	return quot;
+}
+
+bench_time_t bench_stats_stddev(const struct bench_stats *stats)
+{
+	struct u128 n_sumsq;
+	struct u128 total_sq;
+	struct u128 scaled;
+	uint64_t count = stats->count;
+
+	if (count < 2) {
+		return 0;
+	}
+
+	/* count^2 * variance = count * sum(x^2) - sum(x)^2 */
+
+	n_sumsq = u128_mul64(stats->sumsq_lo, count);
+	n_sumsq.hi += stats->sumsq_hi * count;
+	total_sq = u128_mul64(stats->total, stats->total);
+
+	scaled = u128_sub_sat(n_sumsq, total_sq);
+
+	return (bench_time_t)isqrt64(u128_div64(scaled, count * count));
 }
 
 __weak void bench_collect_resources(void)
 {
 	// NO-Op
 }
+
+void bench_busy_wait_ns(uint32_t ns)
+{
+	bench_time_t start;
+	bench_time_t now;
+
+	start = bench_timing_counter_get();
+	do {
+		now = bench_timing_counter_get();
+	} while (bench_timing_cycles_to_ns(bench_timing_cycles_get(&start, &now)) <
+		 ns);
+}
+
+__weak int bench_cpu_count(void)
+{
+	return 1;
+}
+
+__weak int bench_thread_cpu_set(int thread_id, int cpu)
+{
+	ARG_UNUSED(thread_id);
+
+	/* Uniprocessor: every thread runs on CPU 0 */
+
+	return (cpu == 0) ? BENCH_SUCCESS : BENCH_ERROR;
+}
+
+__weak int bench_thread_runtime_get(int thread_id, uint64_t *ns)
+{
+	ARG_UNUSED(thread_id);
+	ARG_UNUSED(ns);
+
+	return BENCH_ERROR;
+}
+
+__weak int bench_heap_usage_get(size_t *used)
+{
+	ARG_UNUSED(used);
+
+	return BENCH_ERROR;
+}
+
+__weak int bench_timer_isr_periodic_set(uint32_t usec)
+{
+	ARG_UNUSED(usec);
+
+	return BENCH_ERROR;
+}
+
+__weak void bench_timer_isr_periodic_ack(void)
+{
+	/* Timer reloads by itself */
+}
+
+__weak int bench_soft_irq_connect(int irq_id, bench_isr_handler_t handler)
+{
+	ARG_UNUSED(irq_id);
+	ARG_UNUSED(handler);
+
+	return BENCH_ERROR;
+}
+
+__weak void bench_soft_irq_trigger(int irq_id)
+{
+	ARG_UNUSED(irq_id);
+}
+
+__weak void bench_soft_irq_disconnect(int irq_id)
+{
+	ARG_UNUSED(irq_id);
+}
+
+__weak int bench_irq_offload(bench_isr_handler_t handler, void *arg)
+{
+	ARG_UNUSED(handler);
+	ARG_UNUSED(arg);
+
+	return BENCH_ERROR;
+}
@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure work queue latency and throughput
+ *
+ * This file contains the test that submits work items to the work queue of
+ * the RTOS and to a work queue of higher priority than the submitting
+ * thread, and reports for each queue
+ *
+ *   - the time from submitting a work item until its handler runs, and
+ *   - the work items run per second when they are submitted in batches of
+ *     1, 8 and 64, each batch being submitted once the previous one ran.
+ *
+ * The work queue of the RTOS may have a lower priority than the submitting
+ * thread, in which case the handlers run once it waits for them. Ports
+ * whose RTOS has no work queue report n/a for it.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#define MAIN_PRIORITY   (BENCH_LAST_PRIORITY - 3)
+#define QUEUE_PRIORITY  (MAIN_PRIORITY - 1)
+
+#define NSEC_PER_SEC    1000000000ULL
+
+#define MAX_BATCH       64
+
+#define QUEUE_ID        0
+#define SEM_ID          0
+
+#define SYSTEM_QUEUE    0
+#define HIGH_QUEUE      1
+
+static const int queue_ids[] = {
+	BENCH_WORK_SYSTEM_QUEUE,
+	QUEUE_ID,
+};
+
+static const char *latency_strings[] = {
+	"Submit to handler (system queue)",
+	"Submit to handler (high priority queue)",
+};
+
+static const int batch_sizes[] = { 1, 8, MAX_BATCH };
+
+static const char *throughput_strings[][3] = {
+	{
+		"Throughput, batches of 1 (system queue)",
+		"Throughput, batches of 8 (system queue)",
+		"Throughput, batches of 64 (system queue)",
+	},
+	{
+		"Throughput, batches of 1 (high priority queue)",
+		"Throughput, batches of 8 (high priority queue)",
+		"Throughput, batches of 64 (high priority queue)",
+	},
+};
+
+#define NUM_BATCH_SIZES  (sizeof(batch_sizes) / sizeof(batch_sizes[0]))
+
+static bench_work work_items[MAX_BATCH];
+
+static volatile struct bench_stamp timestamp_handler;
+static volatile uint32_t work_remaining;
+
+static struct bench_stats latency_times;
+
+/**
+ * @brief Work handler that timestamps its run
+ */
+static void latency_handler(bench_work *work)
+{
+	ARG_UNUSED(work);
+
+	timestamp_handler = bench_stamp_get();
+	bench_sem_give(SEM_ID);
+}
+
+/**
+ * @brief Work handler that signals when the last item of a batch ran
+ */
+static void batch_handler(bench_work *work)
+{
+	ARG_UNUSED(work);
+
+	if (--work_remaining == 0) {
+		bench_sem_give(SEM_ID);
+	}
+}
+
+/**
+ * @brief Wait for the first @a submitted work items of a batch to run
+ *
+ * The rest of the batch was not accepted, so no handler gives the semaphore.
+ * This thread drops to the lowest priority until the pending items ran, so
+ * that they neither give the semaphore later nor get submitted again while
+ * still queued.
+ */
+static void batch_drain(int batch_size, int submitted)
+{
+	bench_thread_set_priority(BENCH_LAST_PRIORITY);
+
+	while (work_remaining != (uint32_t)(batch_size - submitted)) {
+		bench_yield();
+	}
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+}
+
+/**
+ * @brief Gather stats for the time from submitting work until it runs
+ *
+ * @return false if the queue does not accept work
+ */
+static bool gather_latency_stats(int queue)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	bench_work_init(&work_items[0], latency_handler);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		if (bench_work_submit(queue_ids[queue],
+				      &work_items[0]) != BENCH_SUCCESS) {
+			return false;
+		}
+		bench_sem_take(SEM_ID);
+
+		end = timestamp_handler;
+		bench_stats_update(&latency_times, &start, &end, i);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Report the work items run per second in batches of @a batch_size
+ *
+ * About ITERATIONS work items are run in all, whatever the batch size.
+ *
+ * @return false if the queue does not accept work
+ */
+static bool gather_throughput_stats(int queue, uint32_t level, int batch_size)
+{
+	bench_time_t start;
+	bench_time_t end;
+	uint64_t elapsed_ns;
+	uint64_t total = 0;
+	uint32_t num_batches;
+	uint32_t i;
+	int j;
+
+	num_batches = ITERATIONS / batch_size;
+	if (num_batches == 0) {
+		num_batches = 1;
+	}
+
+	for (j = 0; j < batch_size; j++) {
+		bench_work_init(&work_items[j], batch_handler);
+	}
+
+	start = bench_timing_counter_get();
+
+	for (i = 0; i < num_batches; i++) {
+		work_remaining = batch_size;
+
+		for (j = 0; j < batch_size; j++) {
+			if (bench_work_submit(queue_ids[queue],
+					      &work_items[j]) != BENCH_SUCCESS) {
+				/* The batch never completes, so do not wait */
+
+				batch_drain(batch_size, j);
+				return false;
+			}
+		}
+
+		bench_sem_take(SEM_ID);
+		total += batch_size;
+	}
+
+	end = bench_timing_counter_get();
+	elapsed_ns = bench_timing_cycles_to_ns(
+		bench_timing_cycles_get(&start, &end));
+
+	bench_stats_report_value(throughput_strings[queue][level],
+				 (elapsed_ns != 0) ?
+				 (total * NSEC_PER_SEC / elapsed_ns) : 0,
+				 "items/s");
+
+	return true;
+}
+
+/**
+ * @brief Gather and report the stats of one work queue
+ */
+static void gather_queue_stats(int queue, bool supported)
+{
+	uint32_t level;
+
+	bench_stats_reset(&latency_times);
+
+	if (supported) {
+		supported = gather_latency_stats(queue);
+	}
+
+	if (!supported) {
+		bench_stats_report_na(latency_strings[queue]);
+		for (level = 0; level < NUM_BATCH_SIZES; level++) {
+			bench_stats_report_na(throughput_strings[queue][level]);
+		}
+		return;
+	}
+
+	bench_stats_report_line(latency_strings[queue], &latency_times);
+
+	for (level = 0; level < NUM_BATCH_SIZES; level++) {
+		if (!supported ||
+		    !gather_throughput_stats(queue, level, batch_sizes[level])) {
+			supported = false;
+			bench_stats_report_na(throughput_strings[queue][level]);
+		}
+	}
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_work_queue_init(void *arg)
+{
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_stats_report_title("Work queue stats");
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	bench_sem_create(SEM_ID, 0, 1);
+
+	gather_queue_stats(SYSTEM_QUEUE, true);
+	gather_queue_stats(HIGH_QUEUE,
+			   bench_work_queue_create(QUEUE_ID, QUEUE_PRIORITY) ==
+			   BENCH_SUCCESS);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_WORK_QUEUE
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_work_queue_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
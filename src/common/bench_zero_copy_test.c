@@ -0,0 +1,397 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file Measure zero-copy channels against copying message queues
+ *
+ * This file contains the test that moves payloads of 16 B to 4 KB between
+ * threads in two ways:
+ *
+ *   - through a copying message queue: the sender fills its buffer and
+ *     sends it, and the receiver receives a copy into its own buffer, and
+ *   - through a zero-copy channel: the sender allocates a buffer from the
+ *     channel pool, fills it and sends its pointer, and the receiver
+ *     receives the pointer and releases the buffer.
+ *
+ * In both cases the receiver reads the whole payload, so the measured time
+ * covers the work an application does around the transfer. Each path is
+ * measured with the receiver in the same thread and with the receiver in a
+ * higher priority thread that is waiting for the payload. A final summary
+ * reports the smallest payload at which the zero-copy channel is no slower
+ * on average than the copying queue.
+ */
+
+#include "bench_api.h"
+#include "bench_utils.h"
+
+#include <string.h>
+
+#define MAIN_PRIORITY (BENCH_LAST_PRIORITY - 3)
+#define THREAD_HIGH   1
+
+#define MQ_NAME       "bench_zero_copy"
+#define MQ_ID         0
+#define CHANNEL_ID    0
+
+/* Number of messages or buffers that can be in flight at once */
+#define DEPTH         2
+
+#define MAX_PAYLOAD   4096
+
+/* Payload sizes (in bytes) that are measured */
+static const uint32_t payload_sizes[] = { 16, 64, 256, 1024, MAX_PAYLOAD };
+
+#define NUM_SIZES     (sizeof(payload_sizes) / sizeof(payload_sizes[0]))
+
+#define NO_SWITCH     0
+#define SWITCH        1
+
+#define NUM_MODES     2
+
+static const char *copy_strings[NUM_MODES] = {
+	"Copying queue (no context switch)",
+	"Copying queue (context switch)",
+};
+
+static const char *zero_copy_strings[NUM_MODES] = {
+	"Zero-copy channel (no context switch)",
+	"Zero-copy channel (context switch)",
+};
+
+static const char *crossover_strings[NUM_MODES] = {
+	"Crossover (no context switch)",
+	"Crossover (context switch)",
+};
+
+static char msg_send_buf[MAX_PAYLOAD];
+static char msg_rcv_buf[MAX_PAYLOAD];
+
+/* Title of the current payload size */
+static char title[64];
+
+static uint32_t payload_len;
+
+static volatile struct bench_stamp timestamp_end;
+static volatile uint32_t checksum;
+
+static struct bench_stats copy_times;
+static struct bench_stats zero_copy_times;
+
+/* Average times per payload size, or 0 where not measured */
+static bench_time_t copy_avgs[NUM_MODES][NUM_SIZES];
+static bench_time_t zero_copy_avgs[NUM_MODES][NUM_SIZES];
+
+/**
+ * @brief Write a payload as an application would produce it
+ */
+static void payload_fill(char *buf, uint32_t seq)
+{
+	uint32_t i;
+
+	for (i = 0; i < payload_len; i++) {
+		buf[i] = (char)(seq + i);
+	}
+}
+
+/**
+ * @brief Read a payload as an application would consume it
+ */
+static void payload_consume(const char *buf)
+{
+	uint32_t sum = 0;
+	uint32_t i;
+
+	for (i = 0; i < payload_len; i++) {
+		sum += (unsigned char)buf[i];
+	}
+
+	checksum = sum;
+}
+
+/**
+ * @brief Gather stats for the copying queue without a context switch
+ */
+static void gather_copy_no_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		payload_fill(msg_send_buf, i);
+		bench_message_queue_send(MQ_ID, msg_send_buf, payload_len);
+		bench_message_queue_receive(MQ_ID, msg_rcv_buf, payload_len);
+		payload_consume(msg_rcv_buf);
+		end = bench_stamp_get();
+
+		bench_stats_update(&copy_times, &start, &end, i);
+	}
+}
+
+/**
+ * @brief Gather stats for the zero-copy channel without a context switch
+ */
+static void gather_zero_copy_no_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	char *buf;
+	uint32_t i;
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		buf = bench_channel_alloc(CHANNEL_ID);
+		payload_fill(buf, i);
+		bench_channel_send(CHANNEL_ID, buf);
+		buf = bench_channel_receive(CHANNEL_ID);
+		payload_consume(buf);
+		bench_channel_release(CHANNEL_ID, buf);
+		end = bench_stamp_get();
+
+		bench_stats_update(&zero_copy_times, &start, &end, i);
+	}
+}
+
+/**
+ * @brief High priority thread that receives ITERATIONS copied payloads
+ */
+static void bench_copy_receiver(void *args)
+{
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		bench_message_queue_receive(MQ_ID, msg_rcv_buf, payload_len);
+		payload_consume(msg_rcv_buf);
+		timestamp_end = bench_stamp_get();
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief High priority thread that receives ITERATIONS zero-copy payloads
+ */
+static void bench_zero_copy_receiver(void *args)
+{
+	char *buf;
+	uint32_t i;
+
+	ARG_UNUSED(args);
+
+	for (i = 0; i < ITERATIONS; i++) {
+		buf = bench_channel_receive(CHANNEL_ID);
+		payload_consume(buf);
+		bench_channel_release(CHANNEL_ID, buf);
+		timestamp_end = bench_stamp_get();
+	}
+
+	bench_thread_exit();
+}
+
+/**
+ * @brief Gather stats for the copying queue with a context switch
+ *
+ * The receiver blocks on the empty queue and preempts the sender as soon
+ * as a payload is sent. It has consumed the payload by the time the
+ * sender runs again.
+ */
+static void gather_copy_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	uint32_t i;
+
+	bench_thread_create(THREAD_HIGH, "copy_receiver", MAIN_PRIORITY - 1,
+			    bench_copy_receiver, NULL);
+	bench_thread_start(THREAD_HIGH);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		payload_fill(msg_send_buf, i);
+		bench_message_queue_send(MQ_ID, msg_send_buf, payload_len);
+		end = timestamp_end;
+
+		bench_stats_update(&copy_times, &start, &end, i);
+	}
+
+	bench_collect_resources();
+}
+
+/**
+ * @brief Gather stats for the zero-copy channel with a context switch
+ *
+ * The receiver blocks on the empty channel and preempts the sender as soon
+ * as a buffer is sent. It has consumed and released the buffer by the time
+ * the sender runs again.
+ */
+static void gather_zero_copy_switch_stats(void)
+{
+	struct bench_stamp start;
+	struct bench_stamp end;
+	char *buf;
+	uint32_t i;
+
+	bench_thread_create(THREAD_HIGH, "zero_copy_receiver", MAIN_PRIORITY - 1,
+			    bench_zero_copy_receiver, NULL);
+	bench_thread_start(THREAD_HIGH);
+
+	for (i = 1; i <= ITERATIONS; i++) {
+		bench_iteration_start(i);
+
+		start = bench_stamp_get();
+		buf = bench_channel_alloc(CHANNEL_ID);
+		payload_fill(buf, i);
+		bench_channel_send(CHANNEL_ID, buf);
+		end = timestamp_end;
+
+		bench_stats_update(&zero_copy_times, &start, &end, i);
+	}
+
+	bench_collect_resources();
+}
+
+/**
+ * @brief Measure and report the copying queue for one payload size
+ */
+static void gather_copy_stats(uint32_t size_idx)
+{
+#if RTOS_HAS_MESSAGE_QUEUE
+	int mode;
+
+	if ((DEPTH * payload_len <= BENCH_MQ_MAX_SIZE) &&
+	    (bench_message_queue_create(MQ_ID, MQ_NAME, DEPTH,
+					payload_len) == BENCH_SUCCESS)) {
+		for (mode = NO_SWITCH; mode < NUM_MODES; mode++) {
+			bench_stats_reset(&copy_times);
+
+			if (mode == NO_SWITCH) {
+				gather_copy_no_switch_stats();
+			} else {
+				gather_copy_switch_stats();
+			}
+
+			bench_stats_report_line(copy_strings[mode], &copy_times);
+			copy_avgs[mode][size_idx] = copy_times.avg;
+		}
+
+		bench_message_queue_delete(MQ_ID, MQ_NAME);
+		return;
+	}
+#else
+	ARG_UNUSED(size_idx);
+#endif
+
+	bench_stats_report_na(copy_strings[NO_SWITCH]);
+	bench_stats_report_na(copy_strings[SWITCH]);
+}
+
+/**
+ * @brief Measure and report the zero-copy channel for one payload size
+ */
+static void gather_zero_copy_stats(uint32_t size_idx)
+{
+#if RTOS_HAS_CHANNEL
+	int mode;
+
+	if (bench_channel_create(CHANNEL_ID, DEPTH,
+				 payload_len) == BENCH_SUCCESS) {
+		for (mode = NO_SWITCH; mode < NUM_MODES; mode++) {
+			bench_stats_reset(&zero_copy_times);
+
+			if (mode == NO_SWITCH) {
+				gather_zero_copy_no_switch_stats();
+			} else {
+				gather_zero_copy_switch_stats();
+			}
+
+			bench_stats_report_line(zero_copy_strings[mode],
+						&zero_copy_times);
+			zero_copy_avgs[mode][size_idx] = zero_copy_times.avg;
+		}
+
+		bench_channel_delete(CHANNEL_ID);
+		return;
+	}
+#else
+	ARG_UNUSED(size_idx);
+#endif
+
+	bench_stats_report_na(zero_copy_strings[NO_SWITCH]);
+	bench_stats_report_na(zero_copy_strings[SWITCH]);
+}
+
+/**
+ * @brief Report the smallest payload at which zero-copy is no slower
+ */
+static void report_crossover(int mode)
+{
+	uint32_t i;
+
+	for (i = 0; i < NUM_SIZES; i++) {
+		if ((copy_avgs[mode][i] != 0) && (zero_copy_avgs[mode][i] != 0) &&
+		    (zero_copy_avgs[mode][i] <= copy_avgs[mode][i])) {
+			bench_stats_report_value(crossover_strings[mode],
+						 payload_sizes[i], "B");
+			return;
+		}
+	}
+
+	bench_stats_report_na(crossover_strings[mode]);
+}
+
+/**
+ * @brief Test setup function
+ */
+void bench_zero_copy_init(void *arg)
+{
+	uint32_t i;
+
+	bench_timing_init();
+	bench_timing_start();
+
+	bench_thread_set_priority(MAIN_PRIORITY);
+
+	memset(copy_avgs, 0, sizeof(copy_avgs));
+	memset(zero_copy_avgs, 0, sizeof(zero_copy_avgs));
+
+	for (i = 0; i < NUM_SIZES; i++) {
+		payload_len = payload_sizes[i];
+
+		snprintf(title, sizeof(title), "Zero-copy %u B stats",
+			 (unsigned int)payload_len);
+		bench_stats_report_title(title);
+
+		gather_copy_stats(i);
+		gather_zero_copy_stats(i);
+	}
+
+	bench_stats_report_title("Zero-copy crossover stats");
+
+	report_crossover(NO_SWITCH);
+	report_crossover(SWITCH);
+
+	bench_stats_report_runtime();
+
+	bench_timing_stop();
+}
+
+#ifdef RUN_ZERO_COPY
+int main(void)
+{
+	PRINTF("\n\r *** Starting! ***\n\n\r");
+
+	bench_test_init(bench_zero_copy_init);
+
+	PRINTF("\n\r *** Done! ***\n\r");
+
+	return 0;
+}
+#endif
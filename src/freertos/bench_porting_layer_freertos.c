@@ -1,4 +1,5 @@
 #include "bench_api.h"
+#include "bench_utils.h"
 #include "bench_porting_layer_freertos.h"
 
 /* FreeRTOS kernel includes. */
@@ -7,6 +8,7 @@
 #include "queue.h"
 #include "timers.h"
 #include "semphr.h"
+#include "event_groups.h"
 
 /* Freescale includes. */
 #include "fsl_device_registers.h"
@@ -21,11 +23,18 @@
 #include <assert.h>
 
 #define MAX_SEMAPHORES 5
-#define MAX_THREADS 10
+#define MAX_THREADS BENCH_THREAD_MAX_NUM
 #define STACK_SIZE (configMINIMAL_STACK_SIZE + 200)
 #define MAX_MUTEXES 5
+#define MAX_CONDVARS 1
+#define MAX_EVENTS 1
 #define MAX_QUEUES 1
-#define QUEUE_SIZE (1)
+#define QUEUE_SIZE BENCH_MQ_MAX_SIZE
+#define MAX_CHANNELS 1
+#define MAX_POOLS 1
+#define MAX_WORK_QUEUES 1
+#define WORK_QUEUE_LENGTH 16
+#define CHANNEL_QUEUE_SIZE (BENCH_CHANNEL_MAX_BUF_NUM * sizeof(void *))
 
 static SemaphoreHandle_t semaphores[MAX_SEMAPHORES];
 static StaticSemaphore_t semaphore_buffer[MAX_SEMAPHORES];
@@ -39,6 +48,32 @@ static StaticTask_t init_task_buffer;
 static SemaphoreHandle_t mutexes[MAX_MUTEXES];
 static StaticSemaphore_t mutex_buffers[MAX_MUTEXES];
 
+/*
+ * A condition variable is a FIFO of the tasks waiting on it, protected by
+ * the mutex that they wait with. Signaling removes a task from the list and
+ * gives it a task notification.
+ */
+struct condvar_waiter {
+	struct condvar_waiter *next;
+	TaskHandle_t task;
+};
+
+struct condvar {
+	struct condvar_waiter *head;
+	struct condvar_waiter **tail;
+};
+
+static struct condvar condvars[MAX_CONDVARS];
+
+static EventGroupHandle_t events[MAX_EVENTS];
+static StaticEventGroup_t event_buffers[MAX_EVENTS];
+
+#if RUNTIME_STATS
+/* Run time of earlier threads created with each ID */
+static bool thread_used[MAX_THREADS];
+static uint64_t thread_runtime_exited[MAX_THREADS];
+#endif
+
 static TaskHandle_t threads_to_remove[MAX_THREADS];
 static int threads_to_remove_idx;
 static SemaphoreHandle_t to_remove_sem;
@@ -48,8 +83,56 @@ static QueueHandle_t queues[MAX_QUEUES];
 static uint8_t queue_storage[MAX_QUEUES][QUEUE_SIZE];
 static StaticQueue_t queue_buffer[MAX_QUEUES];
 
+/*
+ * A pool is a list of free blocks, linked through their first word, with a
+ * counting semaphore tracking how many there are.
+ */
+static SemaphoreHandle_t pool_sems[MAX_POOLS];
+static StaticSemaphore_t pool_sem_buffers[MAX_POOLS];
+static void *pool_free_lists[MAX_POOLS];
+static uint8_t pool_buffers[MAX_POOLS][BENCH_POOL_MAX_SIZE]
+	__attribute__((aligned(sizeof(void *))));
+
+/*
+ * A zero-copy channel is a queue of buffer pointers. Its pool is a second
+ * queue holding pointers to the free buffers.
+ */
+static QueueHandle_t channel_queues[MAX_CHANNELS];
+static uint8_t channel_queue_storage[MAX_CHANNELS][CHANNEL_QUEUE_SIZE];
+static StaticQueue_t channel_queue_buffer[MAX_CHANNELS];
+static QueueHandle_t channel_free_queues[MAX_CHANNELS];
+static uint8_t channel_free_queue_storage[MAX_CHANNELS][CHANNEL_QUEUE_SIZE];
+static StaticQueue_t channel_free_queue_buffer[MAX_CHANNELS];
+static uint8_t channel_buffers[MAX_CHANNELS]
+	[BENCH_CHANNEL_MAX_BUF_NUM * BENCH_CHANNEL_MAX_BUF_SIZE]
+	__attribute__((aligned(sizeof(void *))));
+
+/*
+ * A work queue is a queue of work item pointers and a task that receives
+ * them and runs their handlers.
+ */
+static QueueHandle_t work_queues[MAX_WORK_QUEUES];
+static uint8_t work_queue_storage[MAX_WORK_QUEUES]
+				 [WORK_QUEUE_LENGTH * sizeof(bench_work *)];
+static StaticQueue_t work_queue_buffers[MAX_WORK_QUEUES];
+static StackType_t work_queue_stacks[MAX_WORK_QUEUES][STACK_SIZE];
+static StaticTask_t work_queue_tasks[MAX_WORK_QUEUES];
+
 #define benchmark_task_PRIORITY (configMAX_PRIORITIES - 1)
 
+static void (*benchmark_entry)(void *);
+
+/**
+ * @brief Entry point of the benchmark task
+ *
+ * The timer overhead is calibrated once the scheduler runs, before the test.
+ */
+static void benchmark_task(void *arg)
+{
+	bench_timing_overhead_calibrate();
+	benchmark_entry(arg);
+}
+
 void bench_test_init(void (*test_init_function)(void *))
 {
 	TaskHandle_t  handle;
@@ -61,7 +144,8 @@ void bench_test_init(void (*test_init_function)(void *))
 
 	to_remove_sem = xSemaphoreCreateCountingStatic(1, 0,
 						       &to_remove_sem_buf);
-	handle = xTaskCreateStatic(test_init_function, "benchmark", STACK_SIZE,
+	benchmark_entry = test_init_function;
+	handle = xTaskCreateStatic(benchmark_task, "benchmark", STACK_SIZE,
 				   NULL, benchmark_task_PRIORITY,
 				   init_stack_buffer, &init_task_buffer);
 	if (handle == NULL) {
@@ -146,6 +230,67 @@ void bench_free(void *ptr)
 	return;        /* Routine not expected to be used */
 }
 
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size)
+{
+	size_t size = (block_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	void *block;
+	size_t i;
+
+	if ((pool_id < 0) || (pool_id >= MAX_POOLS) || (block_num == 0) ||
+	    (block_num * size > BENCH_POOL_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	pool_free_lists[pool_id] = NULL;
+	for (i = block_num; i > 0; i--) {
+		block = &pool_buffers[pool_id][(i - 1) * size];
+		*(void **)block = pool_free_lists[pool_id];
+		pool_free_lists[pool_id] = block;
+	}
+
+	pool_sems[pool_id] = xSemaphoreCreateCountingStatic(block_num,
+		block_num, &pool_sem_buffers[pool_id]);
+
+	if (pool_sems[pool_id] == NULL) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	void *block;
+
+	if (xSemaphoreTake(pool_sems[pool_id], portMAX_DELAY) != pdPASS) {
+		return NULL;
+	}
+
+	taskENTER_CRITICAL();
+	block = pool_free_lists[pool_id];
+	pool_free_lists[pool_id] = *(void **)block;
+	taskEXIT_CRITICAL();
+
+	return block;
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	taskENTER_CRITICAL();
+	*(void **)block = pool_free_lists[pool_id];
+	pool_free_lists[pool_id] = block;
+	taskEXIT_CRITICAL();
+
+	xSemaphoreGive(pool_sems[pool_id]);
+}
+
+int bench_pool_delete(int pool_id)
+{
+	vSemaphoreDelete(pool_sems[pool_id]);
+
+	return BENCH_SUCCESS;
+}
+
 void bench_thread_start(int thread_id)
 {
 	ARG_UNUSED(thread_id);
@@ -164,6 +309,39 @@ static UBaseType_t map_prio(int prio)
 	return configMAX_PRIORITIES - prio;
 }
 
+#if RUNTIME_STATS
+/**
+ * @brief Get the run time counter of a task
+ */
+static uint32_t task_runtime_get(TaskHandle_t handle)
+{
+	TaskStatus_t status;
+
+	vTaskGetInfo(handle, &status, pdFALSE, eRunning);
+	return status.ulRunTimeCounter;
+}
+#endif
+
+/**
+ * @brief Retire the run time of a task that is about to be deleted
+ */
+static void thread_runtime_retire(TaskHandle_t handle)
+{
+#if RUNTIME_STATS
+	int i;
+
+	for (i = 0; i < MAX_THREADS; i++) {
+		if (threads[i] == handle) {
+			thread_runtime_exited[i] += task_runtime_get(handle);
+			threads[i] = NULL;
+			return;
+		}
+	}
+#else
+	ARG_UNUSED(handle);
+#endif
+}
+
 void bench_thread_set_priority(int priority)
 {
 	vTaskPrioritySet(NULL, map_prio(priority));
@@ -175,7 +353,7 @@ int bench_thread_create(int thread_id, const char *thread_name, int priority,
 	BaseType_t ret;
 	TaskHandle_t  handle;
 
-	if (thread_id < 0 || thread_id > MAX_THREADS)
+	if (thread_id < 0 || thread_id >= MAX_THREADS)
 		return BENCH_ERROR;
 
 	handle = xTaskCreateStatic(entry_function, thread_name, STACK_SIZE,
@@ -184,6 +362,9 @@ int bench_thread_create(int thread_id, const char *thread_name, int priority,
 				   &task_buffer[thread_id]);
 
 	threads[thread_id] = handle;
+#if RUNTIME_STATS
+	thread_used[thread_id] = true;
+#endif
 
 	if (handle == NULL) {
 		return BENCH_ERROR;
@@ -204,7 +385,7 @@ int bench_thread_spawn(int thread_id, const char *thread_name, int priority,
 	BaseType_t ret;
 	TaskHandle_t  handle;
 
-	if (thread_id < 0 || thread_id > MAX_THREADS)
+	if (thread_id < 0 || thread_id >= MAX_THREADS)
 		return BENCH_ERROR;
 
 	handle = xTaskCreateStatic(entry_function, thread_name, STACK_SIZE,
@@ -213,6 +394,9 @@ int bench_thread_spawn(int thread_id, const char *thread_name, int priority,
 				   &task_buffer[thread_id]);
 
 	threads[thread_id] = handle;
+#if RUNTIME_STATS
+	thread_used[thread_id] = true;
+#endif
 
 	if (handle == NULL) {
 		return BENCH_ERROR;
@@ -233,7 +417,10 @@ void bench_thread_suspend(int thread_id)
 
 void bench_thread_abort(int thread_id)
 {
-	vTaskDelete(threads[thread_id]);
+	TaskHandle_t handle = threads[thread_id];
+
+	thread_runtime_retire(handle);
+	vTaskDelete(handle);
 }
 
 void bench_yield(void)
@@ -259,10 +446,135 @@ int bench_mutex_unlock(int mutex_id)
 	xSemaphoreGiveRecursive(mutexes[mutex_id]);
 }
 
+int bench_condvar_create(int condvar_id)
+{
+	assert(condvar_id < MAX_CONDVARS);
+
+	condvars[condvar_id].head = NULL;
+	condvars[condvar_id].tail = &condvars[condvar_id].head;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id, int mutex_id)
+{
+	struct condvar *condvar = &condvars[condvar_id];
+	struct condvar_waiter waiter;
+
+	waiter.task = xTaskGetCurrentTaskHandle();
+	waiter.next = NULL;
+	*condvar->tail = &waiter;
+	condvar->tail = &waiter.next;
+
+	xSemaphoreGiveRecursive(mutexes[mutex_id]);
+
+	/* A signal before the task waits leaves the notification pending */
+
+	ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+	xSemaphoreTakeRecursive(mutexes[mutex_id], portMAX_DELAY);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_signal(int condvar_id)
+{
+	struct condvar *condvar = &condvars[condvar_id];
+	struct condvar_waiter *waiter = condvar->head;
+
+	if (waiter == NULL) {
+		return BENCH_SUCCESS;
+	}
+
+	condvar->head = waiter->next;
+	if (condvar->head == NULL) {
+		condvar->tail = &condvar->head;
+	}
+
+	xTaskNotifyGive(waiter->task);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	struct condvar *condvar = &condvars[condvar_id];
+	struct condvar_waiter *waiter = condvar->head;
+	struct condvar_waiter *next;
+
+	condvar->head = NULL;
+	condvar->tail = &condvar->head;
+
+	while (waiter != NULL) {
+		next = waiter->next;
+		xTaskNotifyGive(waiter->task);
+		waiter = next;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_delete(int condvar_id)
+{
+	return (condvars[condvar_id].head == NULL) ? BENCH_SUCCESS : BENCH_ERROR;
+}
+
+int bench_event_create(int event_id)
+{
+	assert(event_id < MAX_EVENTS);
+
+	events[event_id] = xEventGroupCreateStatic(&event_buffers[event_id]);
+
+	return (events[event_id] != NULL) ? BENCH_SUCCESS : BENCH_ERROR;
+}
+
+int bench_event_post(int event_id, uint32_t flags)
+{
+	xEventGroupSetBits(events[event_id], (EventBits_t)flags);
+	return BENCH_SUCCESS;
+}
+
+uint32_t bench_event_wait_any(int event_id, uint32_t flags)
+{
+	EventBits_t bits;
+
+	bits = xEventGroupWaitBits(events[event_id], (EventBits_t)flags,
+				   pdFALSE, pdFALSE, portMAX_DELAY);
+	return (uint32_t)bits & flags;
+}
+
+uint32_t bench_event_wait_all(int event_id, uint32_t flags)
+{
+	EventBits_t bits;
+
+	bits = xEventGroupWaitBits(events[event_id], (EventBits_t)flags,
+				   pdFALSE, pdTRUE, portMAX_DELAY);
+	return (uint32_t)bits & flags;
+}
+
+int bench_event_clear(int event_id, uint32_t flags)
+{
+	xEventGroupClearBits(events[event_id], (EventBits_t)flags);
+	return BENCH_SUCCESS;
+}
+
+int bench_event_delete(int event_id)
+{
+	vEventGroupDelete(events[event_id]);
+	return BENCH_SUCCESS;
+}
+
 void bench_sync_ticks(void)
 {
 }
 
+uint64_t bench_tick_count_get(void)
+{
+	/* A 32-bit tick count is read atomically, also from an ISR */
+
+	return xTaskGetTickCount();
+}
+
 void bench_thread_exit(void)
 {
 	threads_to_remove[threads_to_remove_idx++] = xTaskGetCurrentTaskHandle();
@@ -271,15 +583,45 @@ void bench_thread_exit(void)
 
 void bench_collect_resources(void)
 {
+	TaskHandle_t handle;
+
 	while (threads_to_remove_idx) {
-		vTaskDelete(threads_to_remove[--threads_to_remove_idx]);
+		handle = threads_to_remove[--threads_to_remove_idx];
+		thread_runtime_retire(handle);
+		vTaskDelete(handle);
 	}
 }
 
+#if RUNTIME_STATS
+int bench_thread_runtime_get(int thread_id, uint64_t *ns)
+{
+	uint64_t cycles;
+
+	if (thread_id == BENCH_THREAD_SELF) {
+		cycles = task_runtime_get(xTaskGetCurrentTaskHandle());
+	} else if (thread_id == BENCH_THREAD_IDLE) {
+		cycles = task_runtime_get(xTaskGetIdleTaskHandle());
+	} else if ((thread_id >= 0) && (thread_id < MAX_THREADS) &&
+		   thread_used[thread_id]) {
+		cycles = thread_runtime_exited[thread_id];
+		if (threads[thread_id] != NULL) {
+			cycles += task_runtime_get(threads[thread_id]);
+		}
+	} else {
+		return BENCH_ERROR;
+	}
+
+	*ns = bench_timing_cycles_to_ns(cycles);
+	return BENCH_SUCCESS;
+}
+#endif
+
 int bench_message_queue_create(int mq_id, const char *mq_name,
 	size_t msg_max_num, size_t msg_max_len)
 {
-	configASSERT(msg_max_len <= QUEUE_SIZE);
+	if (msg_max_num * msg_max_len > QUEUE_SIZE) {
+		return BENCH_ERROR;
+	}
 
 	queues[mq_id] = xQueueCreateStatic(msg_max_num, msg_max_len,
 		queue_storage[mq_id], &queue_buffer[mq_id]);
@@ -324,6 +666,228 @@ int bench_message_queue_delete(int mq_id, const char *mq_name)
 	return BENCH_SUCCESS;
 }
 
+int bench_channel_create(int ch_id, size_t buf_num, size_t buf_size)
+{
+	void *buf;
+	size_t i;
+
+	if ((ch_id < 0) || (ch_id >= MAX_CHANNELS) ||
+	    (buf_num == 0) || (buf_num > BENCH_CHANNEL_MAX_BUF_NUM) ||
+	    (buf_size == 0) || (buf_size > BENCH_CHANNEL_MAX_BUF_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	channel_queues[ch_id] = xQueueCreateStatic(buf_num, sizeof(void *),
+		channel_queue_storage[ch_id], &channel_queue_buffer[ch_id]);
+	channel_free_queues[ch_id] = xQueueCreateStatic(buf_num, sizeof(void *),
+		channel_free_queue_storage[ch_id],
+		&channel_free_queue_buffer[ch_id]);
+
+	if ((channel_queues[ch_id] == NULL) ||
+	    (channel_free_queues[ch_id] == NULL)) {
+		return BENCH_ERROR;
+	}
+
+	for (i = 0; i < buf_num; i++) {
+		buf = &channel_buffers[ch_id][i * buf_size];
+		xQueueSend(channel_free_queues[ch_id], &buf, 0);
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_channel_alloc(int ch_id)
+{
+	void *buf;
+
+	if (xQueueReceive(channel_free_queues[ch_id], &buf,
+			  portMAX_DELAY) != pdPASS) {
+		return NULL;
+	}
+
+	return buf;
+}
+
+int bench_channel_send(int ch_id, void *buf)
+{
+	if (xQueueSend(channel_queues[ch_id], &buf, portMAX_DELAY) != pdPASS) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_channel_receive(int ch_id)
+{
+	void *buf;
+
+	if (xQueueReceive(channel_queues[ch_id], &buf,
+			  portMAX_DELAY) != pdPASS) {
+		return NULL;
+	}
+
+	return buf;
+}
+
+void bench_channel_release(int ch_id, void *buf)
+{
+	xQueueSend(channel_free_queues[ch_id], &buf, portMAX_DELAY);
+}
+
+int bench_channel_delete(int ch_id)
+{
+	vQueueDelete(channel_queues[ch_id]);
+	vQueueDelete(channel_free_queues[ch_id]);
+
+	return BENCH_SUCCESS;
+}
+
+static TimerHandle_t soft_timers[BENCH_SOFT_TIMER_MAX_NUM];
+static StaticTimer_t soft_timer_buffers[BENCH_SOFT_TIMER_MAX_NUM];
+static bench_soft_timer_handler_t soft_timer_handlers[BENCH_SOFT_TIMER_MAX_NUM];
+static void *soft_timer_args[BENCH_SOFT_TIMER_MAX_NUM];
+
+/**
+ * @brief Callback run by the timer service task for all software timers
+ */
+static void soft_timer_callback(TimerHandle_t timer)
+{
+	int timer_id = (int)(uintptr_t)pvTimerGetTimerID(timer);
+
+	soft_timer_handlers[timer_id](soft_timer_args[timer_id]);
+}
+
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg)
+{
+	if ((timer_id < 0) || (timer_id >= BENCH_SOFT_TIMER_MAX_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	soft_timer_handlers[timer_id] = handler;
+	soft_timer_args[timer_id] = arg;
+
+	/* The period is set when the timer is started */
+
+	soft_timers[timer_id] = xTimerCreateStatic("bench_timer", 1, pdFALSE,
+						   (void *)(uintptr_t)timer_id,
+						   soft_timer_callback,
+						   &soft_timer_buffers[timer_id]);
+	if (soft_timers[timer_id] == NULL) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic)
+{
+	TickType_t ticks = ((uint64_t)usec * configTICK_RATE_HZ + 999999) /
+			   1000000;
+
+	vTimerSetReloadMode(soft_timers[timer_id],
+			    periodic ? pdTRUE : pdFALSE);
+
+	/* Changing the period also starts the timer */
+
+	if (xTimerChangePeriod(soft_timers[timer_id], ticks,
+			       portMAX_DELAY) != pdPASS) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_stop(int timer_id)
+{
+	if (xTimerStop(soft_timers[timer_id], portMAX_DELAY) != pdPASS) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_delete(int timer_id)
+{
+	if (xTimerDelete(soft_timers[timer_id], portMAX_DELAY) != pdPASS) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+static void work_queue_task(void *arg)
+{
+	QueueHandle_t queue = arg;
+	bench_work *work;
+
+	for (;;) {
+		if (xQueueReceive(queue, &work, portMAX_DELAY) == pdPASS) {
+			work->handler(work);
+		}
+	}
+}
+
+/**
+ * @brief Function pended to the timer service task to run a work item
+ */
+static void work_pended_function(void *work, uint32_t unused)
+{
+	ARG_UNUSED(unused);
+
+	((bench_work *)work)->handler(work);
+}
+
+int bench_work_queue_create(int queue_id, int priority)
+{
+	TaskHandle_t handle;
+
+	if ((queue_id < 0) || (queue_id >= MAX_WORK_QUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	work_queues[queue_id] = xQueueCreateStatic(WORK_QUEUE_LENGTH,
+						   sizeof(bench_work *),
+						   work_queue_storage[queue_id],
+						   &work_queue_buffers[queue_id]);
+	if (work_queues[queue_id] == NULL) {
+		return BENCH_ERROR;
+	}
+
+	handle = xTaskCreateStatic(work_queue_task, "bench_work", STACK_SIZE,
+				   work_queues[queue_id], map_prio(priority),
+				   work_queue_stacks[queue_id],
+				   &work_queue_tasks[queue_id]);
+	if (handle == NULL) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_init(bench_work *work, bench_work_handler_t handler)
+{
+	work->handler = handler;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_submit(int queue_id, bench_work *work)
+{
+	BaseType_t ret;
+
+	/* The timer service task is the work queue of FreeRTOS */
+
+	if (queue_id == BENCH_WORK_SYSTEM_QUEUE) {
+		ret = xTimerPendFunctionCall(work_pended_function, work, 0,
+					     portMAX_DELAY);
+	} else {
+		ret = xQueueSend(work_queues[queue_id], &work, portMAX_DELAY);
+	}
+
+	return (ret != pdPASS) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
 /*
  * The following items are necessary as SUPPORT_STATIC_ALLOCATION is 1.
  * This means that the application must define the necessary task
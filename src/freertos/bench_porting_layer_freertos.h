@@ -6,7 +6,11 @@
 #include "FreeRTOS.h"
 
 typedef uint64_t bench_time_t;
-typedef void * bench_work;
+
+/* A work item is queued by its address */
+typedef struct bench_work {
+	void (*handler)(struct bench_work *work);
+} bench_work;
 
 #define TICK_SYNCH()  k_sleep(K_TICKS(1))
 
@@ -29,5 +33,7 @@ typedef void * bench_work;
 #define RTOS_HAS_THREAD_CREATE_START  0
 #define RTOS_HAS_SUSPEND_RESUME       1
 #define RTOS_HAS_MAIN_ENTRY_POINT     1
+#define RTOS_HAS_MESSAGE_QUEUE        1
+#define RTOS_HAS_CHANNEL              1
 
 #endif /* PORTING_LAYER_FREERTOS_H_ */
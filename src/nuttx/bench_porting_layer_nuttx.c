@@ -5,18 +5,65 @@
  */
 
 #include "bench_api.h"
+#include "bench_utils.h"
 #include <errno.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sched.h>
+#include <nuttx/clock.h>
+#include <nuttx/wdog.h>
+
+#define MAX_CONDVARS 1
+#define MAX_EVENTS 1
+#define MAX_POOLS 1
 
 static pthread_t g_bench_threads[CONFIG_RTOS_BENCHMARK_MAXTHREADS];
 static sem_t g_bench_semaphores[CONFIG_RTOS_BENCHMARK_MAXSEMAPHORES];
 static pthread_mutex_t g_bench_mutex[CONFIG_RTOS_BENCHMARK_MAXMUTEXES];
+static pthread_cond_t g_bench_condvars[MAX_CONDVARS];
+
+/*
+ * An event object is a set of flags protected by a mutex. Waiters sleep on
+ * a condition variable that is broadcast whenever flags are posted.
+ */
+struct bench_event {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t flags;
+};
+
+static struct bench_event g_bench_events[MAX_EVENTS];
+
+/*
+ * A software timer is a watchdog, which calls its handler from the timer
+ * interrupt. Watchdogs are one-shot, so a periodic one is restarted before
+ * its handler is called.
+ */
+struct bench_soft_timer {
+	struct wdog_s wdog;
+	bench_soft_timer_handler_t handler;
+	void *arg;
+	sclock_t period;
+};
+
+static struct bench_soft_timer g_bench_soft_timers[BENCH_SOFT_TIMER_MAX_NUM];
+
+/*
+ * A pool is a list of free blocks, linked through their first word, with a
+ * semaphore counting them.
+ */
+static sem_t g_bench_pool_sems[MAX_POOLS];
+static pthread_mutex_t g_bench_pool_locks[MAX_POOLS];
+static void *g_bench_pool_free_lists[MAX_POOLS];
+static char g_bench_pool_buffers[MAX_POOLS][BENCH_POOL_MAX_SIZE]
+	__attribute__((__aligned__(sizeof(void *))));
 
 void bench_test_init(void (*test_init_function)(void *))
 {
+	bench_timing_overhead_calibrate();
 	test_init_function(NULL);
 }
 
@@ -138,6 +185,140 @@ int bench_mutex_unlock(int mutex_id)
 	return -pthread_mutex_unlock(&g_bench_mutex[mutex_id]);
 }
 
+int bench_condvar_create(int condvar_id)
+{
+	if (pthread_cond_init(&g_bench_condvars[condvar_id], NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id, int mutex_id)
+{
+	if (pthread_cond_wait(&g_bench_condvars[condvar_id], &g_bench_mutex[mutex_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_signal(int condvar_id)
+{
+	if (pthread_cond_signal(&g_bench_condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	if (pthread_cond_broadcast(&g_bench_condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_delete(int condvar_id)
+{
+	if (pthread_cond_destroy(&g_bench_condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_create(int event_id)
+{
+	pthread_mutexattr_t attr;
+	int ret;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	ret = pthread_mutex_init(&g_bench_events[event_id].lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	if (pthread_cond_init(&g_bench_events[event_id].cond, NULL) != 0) {
+		pthread_mutex_destroy(&g_bench_events[event_id].lock);
+		return BENCH_ERROR;
+	}
+
+	g_bench_events[event_id].flags = 0;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_post(int event_id, uint32_t flags)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+
+	pthread_mutex_lock(&event->lock);
+	event->flags |= flags;
+	pthread_cond_broadcast(&event->cond);
+	pthread_mutex_unlock(&event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+static uint32_t event_wait(int event_id, uint32_t flags, bool all)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+	uint32_t set;
+
+	pthread_mutex_lock(&event->lock);
+	for (;;) {
+		set = event->flags & flags;
+		if (all ? (set == flags) : (set != 0)) {
+			break;
+		}
+		pthread_cond_wait(&event->cond, &event->lock);
+	}
+	pthread_mutex_unlock(&event->lock);
+
+	return set;
+}
+
+uint32_t bench_event_wait_any(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, false);
+}
+
+uint32_t bench_event_wait_all(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, true);
+}
+
+int bench_event_clear(int event_id, uint32_t flags)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+
+	pthread_mutex_lock(&event->lock);
+	event->flags &= ~flags;
+	pthread_mutex_unlock(&event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_delete(int event_id)
+{
+	int ret;
+
+	ret = pthread_cond_destroy(&g_bench_events[event_id].cond);
+	ret |= pthread_mutex_destroy(&g_bench_events[event_id].lock);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
 void *bench_malloc(size_t size)
 {
 	return malloc(size);
@@ -146,4 +327,193 @@ void *bench_malloc(size_t size)
 void bench_free(void *ptr)
 {
 	free(ptr);
-}
\ No newline at end of file
+}
+
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size)
+{
+	size_t size = (block_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	void *block;
+	size_t i;
+
+	if ((pool_id < 0) || (pool_id >= MAX_POOLS) || (block_num == 0) ||
+	    (block_num * size > BENCH_POOL_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	g_bench_pool_free_lists[pool_id] = NULL;
+	for (i = block_num; i > 0; i--) {
+		block = &g_bench_pool_buffers[pool_id][(i - 1) * size];
+		*(void **)block = g_bench_pool_free_lists[pool_id];
+		g_bench_pool_free_lists[pool_id] = block;
+	}
+
+	if (pthread_mutex_init(&g_bench_pool_locks[pool_id], NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	if (sem_init(&g_bench_pool_sems[pool_id], 0, block_num) != 0) {
+		pthread_mutex_destroy(&g_bench_pool_locks[pool_id]);
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	void *block;
+
+	if (sem_wait(&g_bench_pool_sems[pool_id]) != 0) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_bench_pool_locks[pool_id]);
+	block = g_bench_pool_free_lists[pool_id];
+	g_bench_pool_free_lists[pool_id] = *(void **)block;
+	pthread_mutex_unlock(&g_bench_pool_locks[pool_id]);
+
+	return block;
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	pthread_mutex_lock(&g_bench_pool_locks[pool_id]);
+	*(void **)block = g_bench_pool_free_lists[pool_id];
+	g_bench_pool_free_lists[pool_id] = block;
+	pthread_mutex_unlock(&g_bench_pool_locks[pool_id]);
+
+	sem_post(&g_bench_pool_sems[pool_id]);
+}
+
+int bench_pool_delete(int pool_id)
+{
+	int ret;
+
+	ret = sem_destroy(&g_bench_pool_sems[pool_id]);
+	ret |= pthread_mutex_destroy(&g_bench_pool_locks[pool_id]);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+static void soft_timer_expiry(wdparm_t arg)
+{
+	struct bench_soft_timer *timer = (struct bench_soft_timer *)arg;
+
+	if (timer->period != 0) {
+		wd_start(&timer->wdog, timer->period, soft_timer_expiry, arg);
+	}
+
+	timer->handler(timer->arg);
+}
+
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg)
+{
+	if ((timer_id < 0) || (timer_id >= BENCH_SOFT_TIMER_MAX_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	g_bench_soft_timers[timer_id].handler = handler;
+	g_bench_soft_timers[timer_id].arg = arg;
+	g_bench_soft_timers[timer_id].period = 0;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic)
+{
+	struct bench_soft_timer *timer = &g_bench_soft_timers[timer_id];
+	sclock_t ticks = USEC2TICK(usec);
+
+	if (ticks == 0) {
+		ticks = 1;
+	}
+
+	timer->period = periodic ? ticks : 0;
+
+	if (wd_start(&timer->wdog, ticks, soft_timer_expiry,
+		     (wdparm_t)timer) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_stop(int timer_id)
+{
+	g_bench_soft_timers[timer_id].period = 0;
+
+	if (wd_cancel(&g_bench_soft_timers[timer_id].wdog) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_delete(int timer_id)
+{
+	return bench_soft_timer_stop(timer_id);
+}
+
+/*
+ * The low priority kernel work queue serves as the system work queue, and
+ * the high priority one as the work queue that the test creates. The
+ * priority of the latter is set by CONFIG_SCHED_HPWORKPRIORITY.
+ */
+
+static void work_trampoline(void *arg)
+{
+	bench_work *work = arg;
+
+	work->handler(work);
+}
+
+int bench_work_queue_create(int queue_id, int priority)
+{
+	UNUSED(priority);
+
+#ifdef CONFIG_SCHED_HPWORK
+	return (queue_id == 0) ? BENCH_SUCCESS : BENCH_ERROR;
+#else
+	UNUSED(queue_id);
+
+	return BENCH_ERROR;
+#endif
+}
+
+int bench_work_init(bench_work *work, bench_work_handler_t handler)
+{
+	memset(&work->work, 0, sizeof(work->work));
+	work->handler = handler;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_submit(int queue_id, bench_work *work)
+{
+	int qid;
+
+	if (queue_id == BENCH_WORK_SYSTEM_QUEUE) {
+#ifdef CONFIG_SCHED_LPWORK
+		qid = LPWORK;
+#else
+		return BENCH_ERROR;
+#endif
+	} else {
+#ifdef CONFIG_SCHED_HPWORK
+		qid = HPWORK;
+#else
+		return BENCH_ERROR;
+#endif
+	}
+
+	if (work_queue(qid, &work->work, work_trampoline, work, 0) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
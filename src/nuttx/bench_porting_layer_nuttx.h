@@ -9,6 +9,7 @@
 
 #include <nuttx/config.h>
 #include <nuttx/compiler.h>
+#include <nuttx/wqueue.h>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -19,7 +20,11 @@
 #define PRINTF(fmt, ...) printf(fmt, ##__VA_ARGS__)
 
 typedef uint64_t bench_time_t;
-typedef void * bench_work;
+
+typedef struct bench_work {
+	struct work_s work;
+	void (*handler)(struct bench_work *work);
+} bench_work;
 
 /*
  * Not all RTOSes support the same features. To help simplify the common code
@@ -20,6 +20,11 @@ void bench_sync_ticks(void)
 {
 }
 
+uint64_t bench_tick_count_get(void)
+{
+	return clock_systime_ticks();
+}
+
 void bench_timing_start(void)
 {
 }
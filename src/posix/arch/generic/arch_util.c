@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "arch_api.h"
+
+#include <time.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+
+void arch_timing_init(void)
+{
+}
+
+/**
+ * @brief Read CLOCK_MONOTONIC_RAW in nanoseconds
+ */
+bench_time_t arch_timing_counter_get(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+
+	return (bench_time_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+uint64_t arch_timing_freq_get(void)
+{
+	return NSEC_PER_SEC;
+}
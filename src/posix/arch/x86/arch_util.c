@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "arch_api.h"
+
+#include <time.h>
+#include <x86intrin.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+
+/* Duration of the TSC calibration against CLOCK_MONOTONIC_RAW */
+#define CALIBRATION_NSEC 100000000ULL
+
+static uint64_t tsc_freq;
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/**
+ * @brief Determine the TSC frequency
+ *
+ * This assumes an invariant TSC, as found on all recent x86 processors.
+ */
+void arch_timing_init(void)
+{
+	struct timespec delay = { 0, CALIBRATION_NSEC };
+	uint64_t ns_start;
+	uint64_t ns_end;
+	uint64_t tsc_start;
+	uint64_t tsc_end;
+
+	if (tsc_freq != 0) {
+		return;
+	}
+
+	ns_start = monotonic_ns();
+	tsc_start = __rdtsc();
+	nanosleep(&delay, NULL);
+	ns_end = monotonic_ns();
+	tsc_end = __rdtsc();
+
+	tsc_freq = ((tsc_end - tsc_start) * NSEC_PER_SEC) /
+		   (ns_end - ns_start);
+}
+
+bench_time_t arch_timing_counter_get(void)
+{
+	return (bench_time_t)__rdtsc();
+}
+
+uint64_t arch_timing_freq_get(void)
+{
+	return tsc_freq;
+}
@@ -0,0 +1,5 @@
+#include "bench_api.h"
+
+void arch_timing_init(void);
+bench_time_t arch_timing_counter_get(void);
+uint64_t arch_timing_freq_get(void);
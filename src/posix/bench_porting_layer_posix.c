@@ -0,0 +1,1483 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "bench_api.h"
+#include "bench_utils.h"
+#include "bench_porting_layer_posix.h"
+#include "arch_api.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <mqueue.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Constants.
+ */
+#define MAX_THREADS BENCH_THREAD_MAX_NUM
+#define STACK_SIZE (64 * 1024)
+#define MAX_SEMAPHORES 3
+#define MAX_MUTEXES 1
+#define MAX_CONDVARS 1
+#define MAX_EVENTS 1
+#define MAX_QUEUES 1
+#define MAX_CHANNELS 1
+#define MAX_POOLS 1
+#define MAX_WORK_QUEUES 1
+#define MQ_NAME_LEN 64
+
+/*
+ * Storage for data structures to be declared and used.
+ *
+ * For our implementation, the ID of a data structure is its position
+ * in the array where it is stored.
+ */
+static pthread_t threads[MAX_THREADS];
+static bool thread_joinable[MAX_THREADS];   /* Created and not yet joined */
+static sem_t semaphores[MAX_SEMAPHORES];
+static pthread_mutex_t mutexes[MAX_MUTEXES];
+static pthread_cond_t condvars[MAX_CONDVARS];
+
+/*
+ * An event object is a set of flags protected by a mutex. Waiters sleep on
+ * a condition variable that is broadcast whenever flags are posted.
+ */
+struct event {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t flags;
+};
+
+static struct event events[MAX_EVENTS];
+
+/*
+ * A message queue is a POSIX message queue, unless the host refuses its size
+ * (fs.mqueue.msg_max, fs.mqueue.msgsize_max or RLIMIT_MSGQUEUE). It is then
+ * a ring of messages in process memory protected by a mutex, with condition
+ * variables for blocked senders and receivers.
+ */
+struct local_queue {
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+	size_t msg_max_num;
+	size_t msg_max_len;
+	size_t head;
+	size_t count;
+	size_t lens[BENCH_MQ_MAX_MSG_NUM];
+	char buffer[BENCH_MQ_MAX_SIZE];
+};
+
+static mqd_t queues[MAX_QUEUES];
+static bool queue_local[MAX_QUEUES];
+static struct local_queue local_queues[MAX_QUEUES];
+
+/*
+ * A zero-copy channel is a message queue of buffer pointers. Its pool is a
+ * second message queue holding pointers to the free buffers.
+ */
+static mqd_t channel_queues[MAX_CHANNELS];
+static mqd_t channel_free_queues[MAX_CHANNELS];
+static char channel_buffers[MAX_CHANNELS]
+			  [BENCH_CHANNEL_MAX_BUF_NUM * BENCH_CHANNEL_MAX_BUF_SIZE]
+	__attribute__((__aligned__(sizeof(void *))));
+
+/*
+ * A pool is a list of free blocks, linked through their first word, with a
+ * semaphore counting them.
+ */
+static sem_t pool_sems[MAX_POOLS];
+static pthread_mutex_t pool_locks[MAX_POOLS];
+static void *pool_free_lists[MAX_POOLS];
+static char pool_buffers[MAX_POOLS][BENCH_POOL_MAX_SIZE]
+	__attribute__((__aligned__(sizeof(void *))));
+
+/*
+ * A work queue is a list of pending work items protected by a mutex, with a
+ * semaphore counting them, and a thread that runs them.
+ */
+struct work_queue {
+	pthread_mutex_t lock;
+	sem_t count;
+	bench_work *head;
+	bench_work **tail;
+};
+
+static struct work_queue work_queues[MAX_WORK_QUEUES];
+
+/*
+ * Linux has no work queue for user space, so the port provides the system
+ * work queue itself, at the lowest benchmark priority.
+ */
+static struct work_queue system_work_queue;
+
+static int work_queue_start(struct work_queue *queue, int priority);
+
+/*
+ * Host CPUs available to the process at startup. Benchmark CPU n is the
+ * n-th CPU in this set.
+ */
+static cpu_set_t available_cpus;
+
+/* Pending CPU of each thread, applied when the thread is next created */
+static bool thread_pinned[MAX_THREADS];
+static int thread_cpus[MAX_THREADS];
+
+/* Entry point of each thread, called by thread_entry() */
+static void (*thread_entries[MAX_THREADS])(void *);
+static void *thread_args[MAX_THREADS];
+
+#ifndef RUNTIME_STATS
+#define RUNTIME_STATS 0
+#endif
+
+#if RUNTIME_STATS
+/*
+ * Run time accounting. The thread wrapper records the kernel thread ID, so
+ * that the run time of threads can be read from /proc while they run. Their
+ * run time is added to that of their thread ID when they exit.
+ */
+static __thread int current_thread_id = BENCH_THREAD_SELF;
+static pid_t thread_tids[MAX_THREADS];
+static volatile bool thread_running[MAX_THREADS];
+static bool thread_used[MAX_THREADS];
+static uint64_t thread_runtime_exited[MAX_THREADS];
+#endif
+
+static int map_prio(int prio)
+{
+	/*
+	 * SCHED_FIFO priorities have larger numbers for higher priorities.
+	 * So we need to remap a small number to a big one, and vice versa.
+	 */
+
+	return sched_get_priority_min(SCHED_FIFO) + BENCH_LAST_PRIORITY - prio;
+}
+
+/**
+ * @brief Get the host CPU of benchmark CPU @a cpu
+ *
+ * @return Host CPU number, or -1 if there is no such CPU
+ */
+static int host_cpu_get(int cpu)
+{
+	int i;
+
+	for (i = 0; i < CPU_SETSIZE; i++) {
+		if (CPU_ISSET(i, &available_cpus) && (cpu-- == 0)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void bench_test_init(void (*test_init_function)(void *))
+{
+	struct sched_param param;
+	cpu_set_t cpus;
+	int ret;
+
+	if (sched_getaffinity(0, sizeof(available_cpus), &available_cpus) != 0) {
+		PRINTF("Failed to get CPU affinity: %s\n", strerror(errno));
+		return;
+	}
+
+	/*
+	 * The common tests assume a uniprocessor system where a higher
+	 * priority thread preempts the current thread as soon as it becomes
+	 * ready. Emulate that by binding the whole process (and thus every
+	 * thread it creates that is not explicitly pinned elsewhere) to
+	 * benchmark CPU 0 and running it under SCHED_FIFO.
+	 */
+
+	CPU_ZERO(&cpus);
+	CPU_SET(host_cpu_get(0), &cpus);
+	if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+		PRINTF("Failed to bind to CPU %d: %s\n", host_cpu_get(0),
+		       strerror(errno));
+		return;
+	}
+
+	param.sched_priority = map_prio(0);
+	ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if (ret != 0) {
+		PRINTF("Failed to set SCHED_FIFO (%s); "
+		       "run as root or grant CAP_SYS_NICE\n", strerror(ret));
+		return;
+	}
+
+	/* Avoid page faults during the measurements */
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+		PRINTF("Warning: mlockall() failed: %s\n", strerror(errno));
+	}
+
+	if (work_queue_start(&system_work_queue,
+			     BENCH_LAST_PRIORITY) != BENCH_SUCCESS) {
+		PRINTF("Warning: failed to start the system work queue\n");
+	}
+
+	arch_timing_init();
+
+	bench_timing_overhead_calibrate();
+	test_init_function(NULL);
+}
+
+#if RUNTIME_STATS
+/**
+ * @brief Get the CPU time of the calling thread in nanoseconds
+ */
+static uint64_t thread_self_runtime_get(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * @brief Add the run time of the calling thread to that of its thread ID
+ */
+static void thread_runtime_retire(void)
+{
+	int thread_id = current_thread_id;
+
+	if (thread_id >= 0) {
+		thread_runtime_exited[thread_id] += thread_self_runtime_get();
+		thread_running[thread_id] = false;
+	}
+}
+
+#endif
+
+/**
+ * @brief Run the entry point of thread @a arg with the pthread signature
+ */
+static void *thread_entry(void *arg)
+{
+	int thread_id = (int)(uintptr_t)arg;
+
+#if RUNTIME_STATS
+	current_thread_id = thread_id;
+	thread_tids[thread_id] = syscall(SYS_gettid);
+	thread_running[thread_id] = true;
+#endif
+
+	thread_entries[thread_id](thread_args[thread_id]);
+
+#if RUNTIME_STATS
+	thread_runtime_retire();
+#endif
+
+	return NULL;
+}
+
+void bench_thread_set_priority(int priority)
+{
+	pthread_setschedprio(pthread_self(), map_prio(priority));
+}
+
+int bench_thread_create(int thread_id, const char *thread_name, int priority,
+	void (*entry_function)(void *), void *args)
+{
+	/*
+	 * POSIX has no concept of creating a thread without starting it.
+	 * Spawn it instead, which does not impact the logic of the tests.
+	 */
+
+	return bench_thread_spawn(thread_id, thread_name,
+			priority, entry_function, args);
+}
+
+int bench_thread_spawn(int thread_id, const char *thread_name, int priority,
+	void (*entry_function)(void *), void *args)
+{
+	struct sched_param param;
+	pthread_attr_t attr;
+	cpu_set_t cpus;
+	int ret;
+
+	/*
+	 * The thread is not named. Threads are joinable, so that their handle
+	 * stays valid after they exit, until they are joined: when their ID
+	 * is aborted or reused, or by bench_collect_resources().
+	 */
+
+	ARG_UNUSED(thread_name);
+
+	if ((thread_id < 0) || (thread_id >= MAX_THREADS)) {
+		return BENCH_ERROR;
+	}
+
+	if (thread_joinable[thread_id]) {
+		pthread_join(threads[thread_id], NULL);
+		thread_joinable[thread_id] = false;
+	}
+
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, STACK_SIZE);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	param.sched_priority = map_prio(priority);
+	pthread_attr_setschedparam(&attr, &param);
+
+	if (thread_pinned[thread_id]) {
+		CPU_ZERO(&cpus);
+		CPU_SET(host_cpu_get(thread_cpus[thread_id]), &cpus);
+		pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+		thread_pinned[thread_id] = false;
+	}
+
+	thread_entries[thread_id] = entry_function;
+	thread_args[thread_id] = args;
+#if RUNTIME_STATS
+	thread_used[thread_id] = true;
+#endif
+
+	ret = pthread_create(&threads[thread_id], &attr, thread_entry,
+			     (void *)(uintptr_t)thread_id);
+
+	pthread_attr_destroy(&attr);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	thread_joinable[thread_id] = true;
+
+	return BENCH_SUCCESS;
+}
+
+void bench_thread_start(int thread_id)
+{
+	ARG_UNUSED(thread_id);
+
+	/* Threads are started when they are created */
+}
+
+void bench_thread_resume(int thread_id)
+{
+	ARG_UNUSED(thread_id);
+}
+
+void bench_thread_suspend(int thread_id)
+{
+	ARG_UNUSED(thread_id);
+}
+
+void bench_thread_abort(int thread_id)
+{
+	/*
+	 * The thread may already have exited, but its handle is valid until
+	 * it is joined. Cancellation is deferred, so the thread stops at its
+	 * next cancellation point (or exit), and joining it waits for that.
+	 */
+
+	if ((thread_id < 0) || (thread_id >= MAX_THREADS) ||
+	    !thread_joinable[thread_id]) {
+		return;
+	}
+
+	pthread_cancel(threads[thread_id]);
+	pthread_join(threads[thread_id], NULL);
+	thread_joinable[thread_id] = false;
+
+#if RUNTIME_STATS
+	/* The run time of an aborted thread is lost */
+
+	thread_running[thread_id] = false;
+#endif
+}
+
+void bench_thread_exit(void)
+{
+#if RUNTIME_STATS
+	thread_runtime_retire();
+#endif
+
+	pthread_exit(NULL);
+}
+
+void bench_yield(void)
+{
+	sched_yield();
+}
+
+void bench_collect_resources(void)
+{
+	int i;
+
+	/* Release the threads that have exited */
+
+	for (i = 0; i < MAX_THREADS; i++) {
+		if (thread_joinable[i] &&
+		    (pthread_tryjoin_np(threads[i], NULL) == 0)) {
+			thread_joinable[i] = false;
+		}
+	}
+}
+
+int bench_cpu_count(void)
+{
+	return CPU_COUNT(&available_cpus);
+}
+
+int bench_thread_cpu_set(int thread_id, int cpu)
+{
+	if ((thread_id < 0) || (thread_id >= MAX_THREADS) ||
+	    (cpu < 0) || (cpu >= bench_cpu_count())) {
+		return BENCH_ERROR;
+	}
+
+	thread_cpus[thread_id] = cpu;
+	thread_pinned[thread_id] = true;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_sem_create(int sem_id, int initial_count, int maximum_count)
+{
+	ARG_UNUSED(maximum_count);
+
+	if (sem_init(&semaphores[sem_id], 0, initial_count) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void bench_sem_give(int sem_id)
+{
+	sem_post(&semaphores[sem_id]);
+}
+
+void bench_sem_give_from_isr(int sem_id)
+{
+	/* sem_post() is async-signal-safe */
+
+	sem_post(&semaphores[sem_id]);
+}
+
+int bench_sem_take(int sem_id)
+{
+	int ret;
+
+	/* The timer "ISR" is a signal handler that may interrupt the wait */
+
+	do {
+		ret = sem_wait(&semaphores[sem_id]);
+	} while ((ret != 0) && (errno == EINTR));
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_mutex_create(int mutex_id)
+{
+	pthread_mutexattr_t attr;
+	int ret;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	ret = pthread_mutex_init(&mutexes[mutex_id], &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_mutex_lock(int mutex_id)
+{
+	if (pthread_mutex_lock(&mutexes[mutex_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_mutex_unlock(int mutex_id)
+{
+	if (pthread_mutex_unlock(&mutexes[mutex_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Unlock the mutex @a arg when a thread is canceled while waiting
+ *
+ * pthread_cond_wait() is a cancellation point, and a thread aborted there
+ * holds the mutex again, which would block every other thread using it.
+ */
+static void mutex_unlock_cleanup(void *arg)
+{
+	pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+int bench_condvar_create(int condvar_id)
+{
+	if (pthread_cond_init(&condvars[condvar_id], NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id, int mutex_id)
+{
+	int ret;
+
+	pthread_cleanup_push(mutex_unlock_cleanup, &mutexes[mutex_id]);
+	ret = pthread_cond_wait(&condvars[condvar_id], &mutexes[mutex_id]);
+	pthread_cleanup_pop(0);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_signal(int condvar_id)
+{
+	if (pthread_cond_signal(&condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	if (pthread_cond_broadcast(&condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_delete(int condvar_id)
+{
+	if (pthread_cond_destroy(&condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_create(int event_id)
+{
+	pthread_mutexattr_t attr;
+	int ret;
+
+	if ((event_id < 0) || (event_id >= MAX_EVENTS)) {
+		return BENCH_ERROR;
+	}
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	ret = pthread_mutex_init(&events[event_id].lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	if (pthread_cond_init(&events[event_id].cond, NULL) != 0) {
+		pthread_mutex_destroy(&events[event_id].lock);
+		return BENCH_ERROR;
+	}
+
+	events[event_id].flags = 0;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_post(int event_id, uint32_t flags)
+{
+	struct event *event = &events[event_id];
+
+	pthread_mutex_lock(&event->lock);
+	event->flags |= flags;
+	pthread_cond_broadcast(&event->cond);
+	pthread_mutex_unlock(&event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+static uint32_t event_wait(int event_id, uint32_t flags, bool all)
+{
+	struct event *event = &events[event_id];
+	uint32_t set;
+
+	pthread_mutex_lock(&event->lock);
+	pthread_cleanup_push(mutex_unlock_cleanup, &event->lock);
+
+	for (;;) {
+		set = event->flags & flags;
+		if (all ? (set == flags) : (set != 0)) {
+			break;
+		}
+		pthread_cond_wait(&event->cond, &event->lock);
+	}
+
+	pthread_cleanup_pop(1);
+
+	return set;
+}
+
+uint32_t bench_event_wait_any(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, false);
+}
+
+uint32_t bench_event_wait_all(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, true);
+}
+
+int bench_event_clear(int event_id, uint32_t flags)
+{
+	struct event *event = &events[event_id];
+
+	pthread_mutex_lock(&event->lock);
+	event->flags &= ~flags;
+	pthread_mutex_unlock(&event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_delete(int event_id)
+{
+	int ret;
+
+	ret = pthread_cond_destroy(&events[event_id].cond);
+	ret |= pthread_mutex_destroy(&events[event_id].lock);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+void bench_free(void *ptr)
+{
+	free(ptr);
+}
+
+int bench_heap_usage_get(size_t *used)
+{
+	struct mallinfo2 info = mallinfo2();
+
+	*used = info.uordblks + info.hblkhd;
+	return BENCH_SUCCESS;
+}
+
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size)
+{
+	size_t size = (block_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	void *block;
+	size_t i;
+
+	if ((pool_id < 0) || (pool_id >= MAX_POOLS) || (block_num == 0) ||
+	    (block_num * size > BENCH_POOL_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	pool_free_lists[pool_id] = NULL;
+	for (i = block_num; i > 0; i--) {
+		block = &pool_buffers[pool_id][(i - 1) * size];
+		*(void **)block = pool_free_lists[pool_id];
+		pool_free_lists[pool_id] = block;
+	}
+
+	if (pthread_mutex_init(&pool_locks[pool_id], NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	if (sem_init(&pool_sems[pool_id], 0, block_num) != 0) {
+		pthread_mutex_destroy(&pool_locks[pool_id]);
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	void *block;
+	int ret;
+
+	do {
+		ret = sem_wait(&pool_sems[pool_id]);
+	} while ((ret != 0) && (errno == EINTR));
+
+	if (ret != 0) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&pool_locks[pool_id]);
+	block = pool_free_lists[pool_id];
+	pool_free_lists[pool_id] = *(void **)block;
+	pthread_mutex_unlock(&pool_locks[pool_id]);
+
+	return block;
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	pthread_mutex_lock(&pool_locks[pool_id]);
+	*(void **)block = pool_free_lists[pool_id];
+	pool_free_lists[pool_id] = block;
+	pthread_mutex_unlock(&pool_locks[pool_id]);
+
+	sem_post(&pool_sems[pool_id]);
+}
+
+int bench_pool_delete(int pool_id)
+{
+	int ret;
+
+	ret = sem_destroy(&pool_sems[pool_id]);
+	ret |= pthread_mutex_destroy(&pool_locks[pool_id]);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Build a valid POSIX message queue name
+ *
+ * Linux requires message queue names to begin with a slash.
+ */
+static void mq_name_get(char *buf, const char *mq_name)
+{
+	snprintf(buf, MQ_NAME_LEN, "/%s", mq_name);
+}
+
+/**
+ * @brief Create the port-internal queue @a mq_id
+ */
+static int local_queue_create(int mq_id, size_t msg_max_num,
+			      size_t msg_max_len)
+{
+	struct local_queue *queue = &local_queues[mq_id];
+
+	if ((msg_max_num > BENCH_MQ_MAX_MSG_NUM) ||
+	    (msg_max_num * msg_max_len > BENCH_MQ_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	if (pthread_mutex_init(&queue->lock, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+	pthread_cond_init(&queue->not_empty, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+
+	queue->msg_max_num = msg_max_num;
+	queue->msg_max_len = msg_max_len;
+	queue->head = 0;
+	queue->count = 0;
+
+	queue_local[mq_id] = true;
+
+	return BENCH_SUCCESS;
+}
+
+static int local_queue_send(int mq_id, const char *msg_ptr, size_t msg_len)
+{
+	struct local_queue *queue = &local_queues[mq_id];
+	size_t slot;
+
+	if (msg_len > queue->msg_max_len) {
+		return BENCH_ERROR;
+	}
+
+	pthread_mutex_lock(&queue->lock);
+	pthread_cleanup_push(mutex_unlock_cleanup, &queue->lock);
+
+	while (queue->count == queue->msg_max_num) {
+		pthread_cond_wait(&queue->not_full, &queue->lock);
+	}
+
+	slot = (queue->head + queue->count) % queue->msg_max_num;
+	memcpy(&queue->buffer[slot * queue->msg_max_len], msg_ptr, msg_len);
+	queue->lens[slot] = msg_len;
+	queue->count++;
+	pthread_cond_signal(&queue->not_empty);
+
+	pthread_cleanup_pop(1);
+
+	return BENCH_SUCCESS;
+}
+
+static int local_queue_receive(int mq_id, char *msg_ptr, size_t msg_len)
+{
+	struct local_queue *queue = &local_queues[mq_id];
+	size_t slot;
+
+	if (msg_len < queue->msg_max_len) {
+		return BENCH_ERROR;
+	}
+
+	pthread_mutex_lock(&queue->lock);
+	pthread_cleanup_push(mutex_unlock_cleanup, &queue->lock);
+
+	while (queue->count == 0) {
+		pthread_cond_wait(&queue->not_empty, &queue->lock);
+	}
+
+	slot = queue->head;
+	memcpy(msg_ptr, &queue->buffer[slot * queue->msg_max_len],
+	       queue->lens[slot]);
+	queue->head = (slot + 1) % queue->msg_max_num;
+	queue->count--;
+	pthread_cond_signal(&queue->not_full);
+
+	pthread_cleanup_pop(1);
+
+	return BENCH_SUCCESS;
+}
+
+static void local_queue_delete(int mq_id)
+{
+	struct local_queue *queue = &local_queues[mq_id];
+
+	pthread_cond_destroy(&queue->not_full);
+	pthread_cond_destroy(&queue->not_empty);
+	pthread_mutex_destroy(&queue->lock);
+
+	queue_local[mq_id] = false;
+}
+
+int bench_message_queue_create(int mq_id, const char *mq_name,
+	size_t msg_max_num, size_t msg_max_len)
+{
+	struct mq_attr attr;
+	char name[MQ_NAME_LEN];
+
+	attr.mq_flags = 0;
+	attr.mq_maxmsg = msg_max_num;
+	attr.mq_msgsize = msg_max_len;
+	attr.mq_curmsgs = 0;
+
+	mq_name_get(name, mq_name);
+	queues[mq_id] = mq_open(name, O_RDWR | O_CREAT, 0600, &attr);
+
+	if (queues[mq_id] == (mqd_t)-1) {
+		/* Fall back to a port-internal queue if the host limits refuse it */
+
+		if ((errno == EINVAL) || (errno == EMFILE)) {
+			return local_queue_create(mq_id, msg_max_num,
+						  msg_max_len);
+		}
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_send(int mq_id, char *msg_ptr, size_t msg_len)
+{
+	int ret;
+
+	if (queue_local[mq_id]) {
+		return local_queue_send(mq_id, msg_ptr, msg_len);
+	}
+
+	do {
+		ret = mq_send(queues[mq_id], msg_ptr, msg_len, 0);
+	} while ((ret != 0) && (errno == EINTR));
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_receive(int mq_id, char *msg_ptr, size_t msg_len)
+{
+	ssize_t ret;
+
+	if (queue_local[mq_id]) {
+		return local_queue_receive(mq_id, msg_ptr, msg_len);
+	}
+
+	do {
+		ret = mq_receive(queues[mq_id], msg_ptr, msg_len, NULL);
+	} while ((ret < 0) && (errno == EINTR));
+
+	if (ret < 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_delete(int mq_id, const char *mq_name)
+{
+	char name[MQ_NAME_LEN];
+	int ret;
+
+	if (queue_local[mq_id]) {
+		local_queue_delete(mq_id);
+		return BENCH_SUCCESS;
+	}
+
+	mq_name_get(name, mq_name);
+	ret = mq_close(queues[mq_id]);
+	ret |= mq_unlink(name);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Open a message queue of @a num pointers named after a channel
+ *
+ * Any queue left behind by an earlier run is removed first.
+ */
+static mqd_t channel_mq_open(int ch_id, const char *prefix, size_t num)
+{
+	struct mq_attr attr;
+	char name[MQ_NAME_LEN];
+
+	attr.mq_flags = 0;
+	attr.mq_maxmsg = num;
+	attr.mq_msgsize = sizeof(void *);
+	attr.mq_curmsgs = 0;
+
+	snprintf(name, sizeof(name), "/bench_%s_%d", prefix, ch_id);
+	mq_unlink(name);
+
+	return mq_open(name, O_RDWR | O_CREAT, 0600, &attr);
+}
+
+/**
+ * @brief Close and remove a message queue named after a channel
+ */
+static int channel_mq_close(int ch_id, const char *prefix, mqd_t mq)
+{
+	char name[MQ_NAME_LEN];
+	int ret;
+
+	snprintf(name, sizeof(name), "/bench_%s_%d", prefix, ch_id);
+	ret = mq_close(mq);
+	ret |= mq_unlink(name);
+
+	return ret;
+}
+
+static int channel_mq_put(mqd_t mq, void *buf)
+{
+	int ret;
+
+	do {
+		ret = mq_send(mq, (const char *)&buf, sizeof(buf), 0);
+	} while ((ret != 0) && (errno == EINTR));
+
+	return ret;
+}
+
+static void *channel_mq_get(mqd_t mq)
+{
+	void *buf;
+	ssize_t ret;
+
+	do {
+		ret = mq_receive(mq, (char *)&buf, sizeof(buf), NULL);
+	} while ((ret < 0) && (errno == EINTR));
+
+	return (ret == sizeof(buf)) ? buf : NULL;
+}
+
+int bench_channel_create(int ch_id, size_t buf_num, size_t buf_size)
+{
+	size_t i;
+
+	if ((ch_id < 0) || (ch_id >= MAX_CHANNELS) ||
+	    (buf_num == 0) || (buf_num > BENCH_CHANNEL_MAX_BUF_NUM) ||
+	    (buf_size == 0) || (buf_size > BENCH_CHANNEL_MAX_BUF_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	channel_queues[ch_id] = channel_mq_open(ch_id, "channel", buf_num);
+	if (channel_queues[ch_id] == (mqd_t)-1) {
+		return BENCH_ERROR;
+	}
+
+	channel_free_queues[ch_id] = channel_mq_open(ch_id, "channel_free",
+						     buf_num);
+	if (channel_free_queues[ch_id] == (mqd_t)-1) {
+		channel_mq_close(ch_id, "channel", channel_queues[ch_id]);
+		return BENCH_ERROR;
+	}
+
+	for (i = 0; i < buf_num; i++) {
+		channel_mq_put(channel_free_queues[ch_id],
+			       &channel_buffers[ch_id][i * buf_size]);
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_channel_alloc(int ch_id)
+{
+	return channel_mq_get(channel_free_queues[ch_id]);
+}
+
+int bench_channel_send(int ch_id, void *buf)
+{
+	if (channel_mq_put(channel_queues[ch_id], buf) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_channel_receive(int ch_id)
+{
+	return channel_mq_get(channel_queues[ch_id]);
+}
+
+void bench_channel_release(int ch_id, void *buf)
+{
+	channel_mq_put(channel_free_queues[ch_id], buf);
+}
+
+int bench_channel_delete(int ch_id)
+{
+	int ret;
+
+	ret = channel_mq_close(ch_id, "channel", channel_queues[ch_id]);
+	ret |= channel_mq_close(ch_id, "channel_free",
+				channel_free_queues[ch_id]);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+/*
+ * Software interrupts are emulated with real-time signals sent to the
+ * calling thread. A signal is blocked while its own handler runs, and the
+ * high priority handler also blocks the low priority signal. A blocked
+ * signal stays pending and is delivered as soon as it is unblocked.
+ */
+
+#define SOFT_IRQ_SIGNAL(irq_id)  (SIGRTMIN + (irq_id))
+
+static bench_isr_handler_t soft_irq_handlers[BENCH_SOFT_IRQ_NUM];
+
+static void soft_irq_signal_handler(int signo)
+{
+	soft_irq_handlers[signo - SIGRTMIN](NULL);
+}
+
+int bench_soft_irq_connect(int irq_id, bench_isr_handler_t handler)
+{
+	struct sigaction sa;
+	int i;
+
+	if ((irq_id < 0) || (irq_id >= BENCH_SOFT_IRQ_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	soft_irq_handlers[irq_id] = handler;
+
+	sa.sa_handler = soft_irq_signal_handler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	for (i = irq_id; i < BENCH_SOFT_IRQ_NUM; i++) {
+		sigaddset(&sa.sa_mask, SOFT_IRQ_SIGNAL(i));
+	}
+
+	if (sigaction(SOFT_IRQ_SIGNAL(irq_id), &sa, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void bench_soft_irq_trigger(int irq_id)
+{
+	pthread_kill(pthread_self(), SOFT_IRQ_SIGNAL(irq_id));
+}
+
+void bench_soft_irq_disconnect(int irq_id)
+{
+	struct sigaction sa;
+
+	sa.sa_handler = SIG_IGN;
+	sa.sa_flags = 0;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SOFT_IRQ_SIGNAL(irq_id), &sa, NULL);
+}
+
+/*
+ * The offloaded routine runs in the handler of the next real-time signal
+ * after those of the software interrupts.
+ */
+
+#define OFFLOAD_SIGNAL  SOFT_IRQ_SIGNAL(BENCH_SOFT_IRQ_NUM)
+
+static bench_isr_handler_t offload_handler;
+static void *offload_arg;
+static bool offload_connected;
+
+static void offload_signal_handler(int signo)
+{
+	ARG_UNUSED(signo);
+
+	offload_handler(offload_arg);
+}
+
+int bench_irq_offload(bench_isr_handler_t handler, void *arg)
+{
+	struct sigaction sa;
+
+	if (!offload_connected) {
+		sa.sa_handler = offload_signal_handler;
+		sa.sa_flags = SA_RESTART;
+		sigemptyset(&sa.sa_mask);
+
+		if (sigaction(OFFLOAD_SIGNAL, &sa, NULL) != 0) {
+			return BENCH_ERROR;
+		}
+
+		offload_connected = true;
+	}
+
+	offload_handler = handler;
+	offload_arg = arg;
+
+	/* A signal sent to the calling thread is delivered before returning */
+
+	if (pthread_kill(pthread_self(), OFFLOAD_SIGNAL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+/*
+ * Software timers are POSIX timers that raise the real-time signal after
+ * the offload one. The signal carries the ID of the timer, whose handler
+ * the signal handler then calls.
+ */
+
+#define SOFT_TIMER_SIGNAL  SOFT_IRQ_SIGNAL(BENCH_SOFT_IRQ_NUM + 1)
+
+static timer_t soft_timers[BENCH_SOFT_TIMER_MAX_NUM];
+static bench_soft_timer_handler_t soft_timer_handlers[BENCH_SOFT_TIMER_MAX_NUM];
+static void *soft_timer_args[BENCH_SOFT_TIMER_MAX_NUM];
+static bool soft_timer_connected;
+
+static void soft_timer_signal_handler(int signo, siginfo_t *info, void *context)
+{
+	int timer_id = info->si_value.sival_int;
+
+	ARG_UNUSED(signo);
+	ARG_UNUSED(context);
+
+	soft_timer_handlers[timer_id](soft_timer_args[timer_id]);
+}
+
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg)
+{
+	struct sigaction sa;
+	struct sigevent sev;
+
+	if ((timer_id < 0) || (timer_id >= BENCH_SOFT_TIMER_MAX_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	if (!soft_timer_connected) {
+		sa.sa_sigaction = soft_timer_signal_handler;
+		sa.sa_flags = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&sa.sa_mask);
+
+		if (sigaction(SOFT_TIMER_SIGNAL, &sa, NULL) != 0) {
+			return BENCH_ERROR;
+		}
+
+		soft_timer_connected = true;
+	}
+
+	soft_timer_handlers[timer_id] = handler;
+	soft_timer_args[timer_id] = arg;
+
+	memset(&sev, 0, sizeof(sev));
+	sev.sigev_notify = SIGEV_SIGNAL;
+	sev.sigev_signo = SOFT_TIMER_SIGNAL;
+	sev.sigev_value.sival_int = timer_id;
+
+	if (timer_create(CLOCK_MONOTONIC, &sev, &soft_timers[timer_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic)
+{
+	struct itimerspec its = { 0 };
+
+	its.it_value.tv_sec = usec / 1000000;
+	its.it_value.tv_nsec = (usec % 1000000) * 1000;
+	if (periodic) {
+		its.it_interval = its.it_value;
+	}
+
+	if (timer_settime(soft_timers[timer_id], 0, &its, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_stop(int timer_id)
+{
+	struct itimerspec its = { 0 };
+
+	if (timer_settime(soft_timers[timer_id], 0, &its, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_delete(int timer_id)
+{
+	if (timer_delete(soft_timers[timer_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+static void *work_queue_thread(void *arg)
+{
+	struct work_queue *queue = arg;
+	bench_work *work;
+	int ret;
+
+	for (;;) {
+		do {
+			ret = sem_wait(&queue->count);
+		} while ((ret != 0) && (errno == EINTR));
+
+		pthread_mutex_lock(&queue->lock);
+		work = queue->head;
+		queue->head = work->next;
+		if (queue->head == NULL) {
+			queue->tail = &queue->head;
+		}
+		pthread_mutex_unlock(&queue->lock);
+
+		work->handler(work);
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Start the thread of work queue @a queue at @a priority
+ */
+static int work_queue_start(struct work_queue *queue, int priority)
+{
+	struct sched_param param;
+	pthread_attr_t attr;
+	pthread_t thread;
+	int ret;
+
+	queue->head = NULL;
+	queue->tail = &queue->head;
+
+	if ((pthread_mutex_init(&queue->lock, NULL) != 0) ||
+	    (sem_init(&queue->count, 0, 0) != 0)) {
+		return BENCH_ERROR;
+	}
+
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, STACK_SIZE);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	param.sched_priority = map_prio(priority);
+	pthread_attr_setschedparam(&attr, &param);
+
+	ret = pthread_create(&thread, &attr, work_queue_thread, queue);
+
+	pthread_attr_destroy(&attr);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_queue_create(int queue_id, int priority)
+{
+	if ((queue_id < 0) || (queue_id >= MAX_WORK_QUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	return work_queue_start(&work_queues[queue_id], priority);
+}
+
+int bench_work_init(bench_work *work, bench_work_handler_t handler)
+{
+	work->next = NULL;
+	work->handler = handler;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_submit(int queue_id, bench_work *work)
+{
+	struct work_queue *queue;
+
+	if (queue_id == BENCH_WORK_SYSTEM_QUEUE) {
+		queue = &system_work_queue;
+	} else if ((queue_id >= 0) && (queue_id < MAX_WORK_QUEUES)) {
+		queue = &work_queues[queue_id];
+	} else {
+		return BENCH_ERROR;
+	}
+
+	pthread_mutex_lock(&queue->lock);
+	work->next = NULL;
+	*queue->tail = work;
+	queue->tail = &work->next;
+	pthread_mutex_unlock(&queue->lock);
+
+	sem_post(&queue->count);
+
+	return BENCH_SUCCESS;
+}
+
+#if RUNTIME_STATS
+/**
+ * @brief Read the first number of a file under /proc
+ *
+ * @return true if the file could be read
+ */
+static bool proc_read_u64(const char *path, uint64_t *value)
+{
+	unsigned long long val = 0;
+	FILE *file;
+	int ret;
+
+	file = fopen(path, "r");
+	if (file == NULL) {
+		return false;
+	}
+
+	ret = fscanf(file, "%llu", &val);
+	fclose(file);
+
+	*value = val;
+	return (ret == 1);
+}
+
+/**
+ * @brief Get the time that the CPU of the benchmark was idle
+ *
+ * The kernel accounts idle time in clock ticks (USER_HZ).
+ */
+static bool cpu_idle_get(uint64_t *ns)
+{
+	unsigned long long idle = 0;
+	char line[256];
+	char name[16];
+	bool found = false;
+	FILE *file;
+
+	snprintf(name, sizeof(name), "cpu%d ", host_cpu_get(0));
+
+	file = fopen("/proc/stat", "r");
+	if (file == NULL) {
+		return false;
+	}
+
+	while (fgets(line, sizeof(line), file) != NULL) {
+		if (strncmp(line, name, strlen(name)) == 0) {
+			found = (sscanf(line + strlen(name),
+					"%*u %*u %*u %llu", &idle) == 1);
+			break;
+		}
+	}
+	fclose(file);
+
+	*ns = (uint64_t)idle * 1000000000 / sysconf(_SC_CLK_TCK);
+	return found;
+}
+
+int bench_thread_runtime_get(int thread_id, uint64_t *ns)
+{
+	char path[64];
+	uint64_t running_ns = 0;
+
+	if (thread_id == BENCH_THREAD_SELF) {
+		*ns = thread_self_runtime_get();
+		return BENCH_SUCCESS;
+	}
+
+	if (thread_id == BENCH_THREAD_IDLE) {
+		return cpu_idle_get(ns) ? BENCH_SUCCESS : BENCH_ERROR;
+	}
+
+	if ((thread_id < 0) || (thread_id >= MAX_THREADS) ||
+	    !thread_used[thread_id]) {
+		return BENCH_ERROR;
+	}
+
+	/* The first number of schedstat is the time on the CPU in ns */
+
+	if (thread_running[thread_id]) {
+		snprintf(path, sizeof(path), "/proc/self/task/%d/schedstat",
+			 (int)thread_tids[thread_id]);
+		proc_read_u64(path, &running_ns);
+	}
+
+	*ns = thread_runtime_exited[thread_id] + running_ns;
+	return BENCH_SUCCESS;
+}
+#endif
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#ifndef PORTING_LAYER_POSIX_H_
+#define PORTING_LAYER_POSIX_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef unsigned long long bench_time_t;
+
+/*
+ * A work item is linked into the list of its work queue while it is
+ * pending.
+ */
+typedef struct bench_work {
+	struct bench_work *next;
+	void (*handler)(struct bench_work *work);
+} bench_work;
+
+#define PRINTF(FMT, ...) printf(FMT, ##__VA_ARGS__)
+
+/*
+ * Benchmark priorities 0 .. BENCH_LAST_PRIORITY are mapped onto the lowest
+ * SCHED_FIFO priorities so that the benchmark stays below the threaded IRQ
+ * handlers (priority 50) of a PREEMPT_RT kernel.
+ */
+
+#define BENCH_LAST_PRIORITY 40
+#define BENCH_IDLE_TIME     0
+
+/* The host has the memory to run every level of the tests */
+
+#ifndef BENCH_THREAD_MAX_NUM
+#define BENCH_THREAD_MAX_NUM        202
+#endif
+
+#ifndef BENCH_SOFT_TIMER_MAX_NUM
+#define BENCH_SOFT_TIMER_MAX_NUM    1000
+#endif
+
+#ifndef BENCH_MQ_MAX_SIZE
+#define BENCH_MQ_MAX_SIZE           32768
+#endif
+
+#ifndef BENCH_CHANNEL_MAX_BUF_SIZE
+#define BENCH_CHANNEL_MAX_BUF_SIZE  4096
+#endif
+
+#define __weak __attribute__((__weak__))
+
+#define ARG_UNUSED(x) (void)(x)
+
+/*
+ * Not all RTOSes support the same features. To help simplify the common code
+ * as much as possible, where there are known differences in support, various
+ * aspects of the benchmarking can be enabled/disabled as needed.
+ */
+
+#define RTOS_HAS_THREAD_SPAWN         1
+#define RTOS_HAS_THREAD_CREATE_START  0
+#define RTOS_HAS_SUSPEND_RESUME       0
+#define RTOS_HAS_MAIN_ENTRY_POINT     1
+#define RTOS_HAS_MESSAGE_QUEUE        1
+#define RTOS_HAS_CHANNEL              1
+
+#endif /* PORTING_LAYER_POSIX_H_ */
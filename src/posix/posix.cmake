@@ -0,0 +1,19 @@
+# This file is included by "../../CMakeLists.txt".
+# Therefore any specified relative paths are relative to "../../".
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DPOSIX -D_GNU_SOURCE")
+
+enable_language(C)
+
+if (NOT BOARD)
+    set(BOARD native_${CMAKE_SYSTEM_PROCESSOR})
+endif()
+
+find_package(Threads REQUIRED)
+
+include_directories(src/posix)
+
+add_executable(app src/posix/bench_porting_layer_posix.c)
+
+target_link_libraries(app PRIVATE Threads::Threads)
+target_link_libraries(app PRIVATE rt)
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * On a POSIX host the "system timer interrupt" is emulated with a POSIX
+ * timer whose expiry raises SIGALRM. The benchmark's timer ISR is invoked
+ * from the signal handler. Timer cycles use the same counter as the timing
+ * routines so that latencies can be converted with
+ * bench_timing_cycles_to_ns().
+ */
+
+#include "bench_api.h"
+#include "arch_api.h"
+
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NSEC_PER_SEC  1000000000ULL
+#define USEC_PER_SEC  1000000ULL
+
+/* Nominal rate of the emulated system tick */
+#define TICKS_PER_SEC 1000
+
+#define TIMER_SIGNAL  SIGALRM
+
+static timer_t bench_timer;
+static bool bench_timer_created;
+static volatile bench_isr_handler_t bench_timer_handler;
+
+void bench_timing_init(void)
+{
+}
+
+void bench_sync_ticks(void)
+{
+	usleep(USEC_PER_SEC / TICKS_PER_SEC);
+}
+
+uint64_t bench_tick_count_get(void)
+{
+	static uint64_t coarse_ns;
+	struct timespec ts;
+
+	/*
+	 * The coarse clock is only updated by the kernel's tick, so its
+	 * resolution is the tick period.
+	 */
+
+	if (coarse_ns == 0) {
+		clock_getres(CLOCK_MONOTONIC_COARSE, &ts);
+		coarse_ns = ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+
+	return (ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec) / coarse_ns;
+}
+
+void bench_timing_start(void)
+{
+}
+
+void bench_timing_stop(void)
+{
+}
+
+bench_time_t bench_timing_counter_get(void)
+{
+	return arch_timing_counter_get();
+}
+
+bench_time_t bench_timing_cycles_get(bench_time_t *time_start,
+	bench_time_t *time_end)
+{
+	return *time_end - *time_start;
+}
+
+bench_time_t bench_timing_cycles_to_ns(bench_time_t cycles)
+{
+	return (cycles * NSEC_PER_SEC) / arch_timing_freq_get();
+}
+
+static void dummy_isr(void *arg)
+{
+	ARG_UNUSED(arg);
+}
+
+static void timer_signal_handler(int signo)
+{
+	ARG_UNUSED(signo);
+
+	bench_timer_handler(NULL);
+}
+
+bench_isr_handler_t bench_timer_isr_get(void)
+{
+	return dummy_isr;
+}
+
+void bench_timer_isr_set(bench_isr_handler_t handler)
+{
+	struct sigaction sa;
+	struct sigevent sev;
+
+	bench_timer_handler = handler;
+
+	if (bench_timer_created) {
+		return;
+	}
+
+	sa.sa_handler = timer_signal_handler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(TIMER_SIGNAL, &sa, NULL);
+
+	/*
+	 * Deliver the signal to the calling (test) thread only. Otherwise it
+	 * may be taken by any thread, and a handler run in a higher priority
+	 * thread may preempt one still running in another, unlike an ISR.
+	 */
+
+	sev.sigev_notify = SIGEV_THREAD_ID;
+	sev.sigev_signo = TIMER_SIGNAL;
+	sev.sigev_value.sival_ptr = NULL;
+	sev._sigev_un._tid = syscall(SYS_gettid);
+
+	if (timer_create(CLOCK_MONOTONIC, &sev, &bench_timer) != 0) {
+		PRINTF("Failed to create timer\n");
+		return;
+	}
+
+	bench_timer_created = true;
+}
+
+void bench_timer_isr_restore(bench_isr_handler_t handler)
+{
+	struct itimerspec its = { 0 };
+
+	if (bench_timer_created) {
+		timer_settime(bench_timer, 0, &its, NULL);
+	}
+
+	bench_timer_handler = handler;
+}
+
+/**
+ * @brief Sets the timer ISR to trigger in @a usec microseconds
+ *
+ * The timer is armed with an absolute expiry time. The returned trigger
+ * point is that expiry time translated into counter cycles.
+ */
+bench_time_t bench_timer_isr_expiry_set(uint32_t usec)
+{
+	struct itimerspec its = { 0 };
+	struct timespec now;
+	bench_time_t cycles;
+	uint64_t expiry;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	cycles = arch_timing_counter_get();
+
+	expiry = (uint64_t)now.tv_sec * NSEC_PER_SEC + now.tv_nsec +
+		 (uint64_t)usec * 1000;
+	its.it_value.tv_sec = expiry / NSEC_PER_SEC;
+	its.it_value.tv_nsec = expiry % NSEC_PER_SEC;
+
+	timer_settime(bench_timer, TIMER_ABSTIME, &its, NULL);
+
+	return cycles + (usec * arch_timing_freq_get()) / USEC_PER_SEC;
+}
+
+/**
+ * @brief Sets the timer ISR to trigger every @a usec microseconds
+ *
+ * The POSIX timer reloads by itself. Expiries that occur while the signal
+ * is still pending are merged into a single signal.
+ */
+int bench_timer_isr_periodic_set(uint32_t usec)
+{
+	struct itimerspec its;
+
+	if (!bench_timer_created || (usec == 0)) {
+		return BENCH_ERROR;
+	}
+
+	its.it_value.tv_sec = usec / USEC_PER_SEC;
+	its.it_value.tv_nsec = (usec % USEC_PER_SEC) * 1000;
+	its.it_interval = its.it_value;
+
+	return (timer_settime(bench_timer, 0, &its, NULL) == 0) ?
+	       BENCH_SUCCESS : BENCH_ERROR;
+}
+
+bench_time_t bench_timer_cycles_diff(bench_time_t trigger,
+	bench_time_t sample)
+{
+	return sample - trigger;
+}
+
+bench_time_t bench_timer_cycles_get(void)
+{
+	return arch_timing_counter_get();
+}
+
+uint32_t bench_timer_cycles_per_second(void)
+{
+	return (uint32_t)arch_timing_freq_get();
+}
+
+uint32_t bench_timer_cycles_per_tick(void)
+{
+	return (uint32_t)(arch_timing_freq_get() / TICKS_PER_SEC);
+}
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "bench_api.h"
+#include "bench_utils.h"
 #include "bench_porting_layer_rtems.h"
 
 #include <rtems.h>
@@ -12,9 +13,14 @@
  * Constants.
  */
 
-#define MAX_THREADS 10
+#define MAX_THREADS BENCH_THREAD_MAX_NUM
 #define MAX_SEMAPHORES 2
 #define MAX_MUTEXES 1
+#define MAX_CONDVARS 1
+#define MAX_EVENTS 1
+#define MAX_POOLS 1
+#define MAX_WORK_QUEUES 1
+#define WORK_QUEUE_LENGTH 64
 
 #define BASE_PRIORITY 200
 
@@ -30,6 +36,87 @@ static rtems_id  semaphores[MAX_SEMAPHORES];
 static rtems_id  mutexes[MAX_MUTEXES];
 static rtems_id  threads[MAX_THREADS];
 static rtems_task_entry  entries[MAX_THREADS];
+static rtems_task_argument  arguments[MAX_THREADS];
+
+/*
+ * A condition variable is a FIFO of the tasks waiting on it, protected by
+ * the mutex that they wait with. Signaling removes a task from the list and
+ * sends it RTEMS_EVENT_1.
+ */
+struct condvar_waiter {
+	struct condvar_waiter  *next;
+	rtems_id  task;
+};
+
+struct condvar {
+	struct condvar_waiter  *head;
+	struct condvar_waiter  **tail;
+};
+
+static struct condvar  condvars[MAX_CONDVARS];
+
+/*
+ * RTEMS events belong to tasks, so an event object is a set of flags and a
+ * list of the tasks waiting on it, protected by a mutex. Posting removes
+ * each task whose wait is satisfied from the list and sends it
+ * RTEMS_EVENT_0.
+ */
+struct event_waiter {
+	struct event_waiter  *next;
+	rtems_id  task;
+	uint32_t  flags;
+	bool  all;
+	uint32_t  result;
+};
+
+struct event {
+	rtems_id  lock;
+	uint32_t  flags;
+	struct event_waiter  *waiters;
+};
+
+static struct event  events[MAX_EVENTS];
+
+/*
+ * A work queue is a message queue of work item pointers and a task that
+ * receives them and runs their handlers. Sending to a full message queue
+ * fails rather than blocks, so it holds as many items as may be pending.
+ */
+static rtems_id  work_queues[MAX_WORK_QUEUES];
+static rtems_id  work_queue_tasks[MAX_WORK_QUEUES];
+
+/*
+ * Software timers fire from the timer server task, which is started along
+ * with the first timer. RTEMS timers are one-shot, so the routine of a
+ * periodic timer rearms it before calling the handler.
+ */
+static bool  timer_server_started;
+static rtems_id  soft_timers[BENCH_SOFT_TIMER_MAX_NUM];
+static bench_soft_timer_handler_t  soft_timer_handlers[BENCH_SOFT_TIMER_MAX_NUM];
+static void  *soft_timer_args[BENCH_SOFT_TIMER_MAX_NUM];
+static bool  soft_timer_periodic[BENCH_SOFT_TIMER_MAX_NUM];
+
+/*
+ * Partitions do not block when exhausted, so each pool is paired with a
+ * counting semaphore of its free buffers.
+ */
+static rtems_id  pools[MAX_POOLS];
+static rtems_id  pool_sems[MAX_POOLS];
+static char  pool_buffers[MAX_POOLS][BENCH_POOL_MAX_SIZE]
+	RTEMS_ALIGNED(CPU_PARTITION_ALIGNMENT);
+
+static void (*test_entry)(void *);
+
+/**
+ * @brief Entry point of the test thread
+ *
+ * The timer overhead is calibrated in the test thread, before the test.
+ */
+static rtems_task test_thread_entry(rtems_task_argument arg)
+{
+	bench_timing_overhead_calibrate();
+	test_entry((void *)arg);
+}
 
 void bench_test_init(void (*test_init_function)(void *))
 {
@@ -67,8 +154,8 @@ void bench_test_init(void (*test_init_function)(void *))
 		printf(" **** Failed to start main thread ****\n");
 	}
 
-	status = rtems_task_start(main_thread_id,
-				  (rtems_task_entry)test_init_function, 0);
+	test_entry = test_init_function;
+	status = rtems_task_start(main_thread_id, test_thread_entry, 0);
 
 	/* Ensure that we switch to test_init_function()'s thread */
 
@@ -100,6 +187,7 @@ int bench_thread_create(int thread_id, const char *thread_name, int priority,
 	rtems_status_code  status;
 
 	entries[thread_id] = (rtems_task_entry)entry_function;
+	arguments[thread_id] = (rtems_task_argument)args;
 	name++;
 
 	status = rtems_task_create(name, map_prio(priority),
@@ -123,7 +211,8 @@ int bench_thread_spawn(int thread_id, const char *thread_name, int priority,
 void bench_thread_start(int thread_id)
 {
 	rtems_task_start(threads[thread_id],
-			 (rtems_task_entry)entries[thread_id], 0);
+			 (rtems_task_entry)entries[thread_id],
+			 arguments[thread_id]);
 }
 
 void bench_thread_resume(int thread_id)
@@ -156,6 +245,11 @@ void bench_sync_ticks(void)
 	usleep(1000000);
 }
 
+uint64_t bench_tick_count_get(void)
+{
+	return rtems_clock_get_ticks_since_boot();
+}
+
 void bench_timing_start(void)
 {
 	/* Nothing to do. */
@@ -258,6 +352,199 @@ int bench_mutex_unlock(int mutex_id)
 	return (status == 0) ? BENCH_SUCCESS : BENCH_ERROR;
 }
 
+int bench_condvar_create(int condvar_id)
+{
+	condvars[condvar_id].head = NULL;
+	condvars[condvar_id].tail = &condvars[condvar_id].head;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id, int mutex_id)
+{
+	struct condvar  *condvar = &condvars[condvar_id];
+	struct condvar_waiter  waiter;
+	rtems_event_set  received;
+	rtems_status_code  status;
+
+	waiter.task = rtems_task_self();
+	waiter.next = NULL;
+	*condvar->tail = &waiter;
+	condvar->tail = &waiter.next;
+
+	rtems_semaphore_release(mutexes[mutex_id]);
+
+	/* A signal before the task waits leaves the event pending */
+
+	status = rtems_event_receive(RTEMS_EVENT_1,
+				     RTEMS_WAIT | RTEMS_EVENT_ANY,
+				     RTEMS_NO_TIMEOUT, &received);
+
+	rtems_semaphore_obtain(mutexes[mutex_id], RTEMS_WAIT,
+			       RTEMS_NO_TIMEOUT);
+
+	return (status == 0) ? BENCH_SUCCESS : BENCH_ERROR;
+}
+
+int bench_condvar_signal(int condvar_id)
+{
+	struct condvar  *condvar = &condvars[condvar_id];
+	struct condvar_waiter  *waiter = condvar->head;
+
+	if (waiter == NULL) {
+		return BENCH_SUCCESS;
+	}
+
+	condvar->head = waiter->next;
+	if (condvar->head == NULL) {
+		condvar->tail = &condvar->head;
+	}
+
+	rtems_event_send(waiter->task, RTEMS_EVENT_1);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	struct condvar  *condvar = &condvars[condvar_id];
+	struct condvar_waiter  *waiter = condvar->head;
+	struct condvar_waiter  *next;
+
+	condvar->head = NULL;
+	condvar->tail = &condvar->head;
+
+	while (waiter != NULL) {
+		next = waiter->next;
+		rtems_event_send(waiter->task, RTEMS_EVENT_1);
+		waiter = next;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_delete(int condvar_id)
+{
+	return (condvars[condvar_id].head == NULL) ? BENCH_SUCCESS : BENCH_ERROR;
+}
+
+int bench_event_create(int event_id)
+{
+	rtems_status_code  status;
+
+	rtems_name lock_name;
+	lock_name = rtems_build_name( 'e', 'v', 'n', 't' );
+
+	status = rtems_semaphore_create(lock_name, 1,
+					RTEMS_BINARY_SEMAPHORE | RTEMS_LOCAL |
+					RTEMS_PRIORITY | RTEMS_INHERIT_PRIORITY,
+					0,
+					&events[event_id].lock);
+
+	events[event_id].flags = 0;
+	events[event_id].waiters = NULL;
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
+static bool event_satisfied(uint32_t set, uint32_t flags, bool all)
+{
+	return all ? (set == flags) : (set != 0);
+}
+
+int bench_event_post(int event_id, uint32_t flags)
+{
+	struct event  *event = &events[event_id];
+	struct event_waiter  **prev;
+	struct event_waiter  *waiter;
+	uint32_t  set;
+
+	rtems_semaphore_obtain(event->lock, RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+
+	event->flags |= flags;
+
+	prev = &event->waiters;
+	while ((waiter = *prev) != NULL) {
+		set = event->flags & waiter->flags;
+		if (event_satisfied(set, waiter->flags, waiter->all)) {
+			/* The woken task may run (and return) at once */
+
+			*prev = waiter->next;
+			waiter->result = set;
+			rtems_event_send(waiter->task, RTEMS_EVENT_0);
+		} else {
+			prev = &waiter->next;
+		}
+	}
+
+	rtems_semaphore_release(event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+static uint32_t event_wait(int event_id, uint32_t flags, bool all)
+{
+	struct event  *event = &events[event_id];
+	struct event_waiter  waiter;
+	rtems_event_set  received;
+	rtems_status_code  status;
+	uint32_t  set;
+
+	rtems_semaphore_obtain(event->lock, RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+
+	set = event->flags & flags;
+	if (event_satisfied(set, flags, all)) {
+		rtems_semaphore_release(event->lock);
+		return set;
+	}
+
+	waiter.task = rtems_task_self();
+	waiter.flags = flags;
+	waiter.all = all;
+	waiter.next = event->waiters;
+	event->waiters = &waiter;
+
+	rtems_semaphore_release(event->lock);
+
+	/* A post between releasing the lock and here leaves the event pending */
+
+	status = rtems_event_receive(RTEMS_EVENT_0,
+				     RTEMS_WAIT | RTEMS_EVENT_ANY,
+				     RTEMS_NO_TIMEOUT, &received);
+
+	return (status == 0) ? waiter.result : 0;
+}
+
+uint32_t bench_event_wait_any(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, false);
+}
+
+uint32_t bench_event_wait_all(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, true);
+}
+
+int bench_event_clear(int event_id, uint32_t flags)
+{
+	struct event  *event = &events[event_id];
+
+	rtems_semaphore_obtain(event->lock, RTEMS_WAIT, RTEMS_NO_TIMEOUT);
+	event->flags &= ~flags;
+	rtems_semaphore_release(event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_delete(int event_id)
+{
+	rtems_status_code  status;
+
+	status = rtems_semaphore_delete(events[event_id].lock);
+
+	return (status == 0) ? BENCH_SUCCESS : BENCH_ERROR;
+}
+
 void *bench_malloc(size_t size)
 {
 	return malloc(size);
@@ -268,7 +555,215 @@ void bench_free(void *ptr)
 	free(ptr);
 }
 
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size)
+{
+	rtems_status_code  status;
+	size_t  size = RTEMS_ALIGN_UP(block_size, CPU_PARTITION_ALIGNMENT);
+
+	if ((pool_id < 0) || (pool_id >= MAX_POOLS) || (block_num == 0) ||
+	    (block_num * size > BENCH_POOL_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	status = rtems_partition_create(rtems_build_name('p', 'o', 'o', 'l'),
+					pool_buffers[pool_id],
+					block_num * size, size, RTEMS_LOCAL,
+					&pools[pool_id]);
+	if (status != 0) {
+		return BENCH_ERROR;
+	}
+
+	status = rtems_semaphore_create(rtems_build_name('p', 'o', 'o', 's'),
+					(uint32_t)block_num,
+					RTEMS_COUNTING_SEMAPHORE | RTEMS_LOCAL |
+					RTEMS_PRIORITY,
+					0,
+					&pool_sems[pool_id]);
+	if (status != 0) {
+		rtems_partition_delete(pools[pool_id]);
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	void *block;
+
+	rtems_semaphore_obtain(pool_sems[pool_id],
+			       RTEMS_DEFAULT_OPTIONS,
+			       RTEMS_NO_TIMEOUT);
+
+	if (rtems_partition_get_buffer(pools[pool_id], &block) != 0) {
+		return NULL;
+	}
+
+	return block;
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	rtems_partition_return_buffer(pools[pool_id], block);
+	rtems_semaphore_release(pool_sems[pool_id]);
+}
+
+int bench_pool_delete(int pool_id)
+{
+	rtems_status_code  status;
+
+	status = rtems_semaphore_delete(pool_sems[pool_id]);
+	status |= rtems_partition_delete(pools[pool_id]);
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
+static rtems_timer_service_routine soft_timer_routine(rtems_id id,
+						      void *user_data)
+{
+	int timer_id = (int)(uintptr_t)user_data;
+
+	if (soft_timer_periodic[timer_id]) {
+		rtems_timer_reset(id);
+	}
+
+	soft_timer_handlers[timer_id](soft_timer_args[timer_id]);
+}
+
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg)
+{
+	rtems_status_code  status;
+
+	if ((timer_id < 0) || (timer_id >= BENCH_SOFT_TIMER_MAX_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	if (!timer_server_started) {
+		status = rtems_timer_initiate_server(
+				RTEMS_TIMER_SERVER_DEFAULT_PRIORITY,
+				RTEMS_MINIMUM_STACK_SIZE,
+				RTEMS_DEFAULT_ATTRIBUTES);
+		if (status != 0) {
+			return BENCH_ERROR;
+		}
+
+		timer_server_started = true;
+	}
+
+	soft_timer_handlers[timer_id] = handler;
+	soft_timer_args[timer_id] = arg;
+
+	status = rtems_timer_create(rtems_build_name('t', 'i', 'm', 'r'),
+				    &soft_timers[timer_id]);
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic)
+{
+	rtems_status_code  status;
+	uint32_t  us_per_tick = rtems_configuration_get_microseconds_per_tick();
+	rtems_interval  ticks = ((uint64_t)usec + us_per_tick - 1) / us_per_tick;
+
+	soft_timer_periodic[timer_id] = periodic;
+
+	status = rtems_timer_server_fire_after(soft_timers[timer_id], ticks,
+					       soft_timer_routine,
+					       (void *)(uintptr_t)timer_id);
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
+int bench_soft_timer_stop(int timer_id)
+{
+	rtems_status_code  status;
+
+	status = rtems_timer_cancel(soft_timers[timer_id]);
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
+int bench_soft_timer_delete(int timer_id)
+{
+	rtems_status_code  status;
+
+	status = rtems_timer_delete(soft_timers[timer_id]);
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
 void bench_thread_exit(void)
 {
 	rtems_task_delete(RTEMS_SELF);
 }
+
+static rtems_task work_queue_task(rtems_task_argument queue_id)
+{
+	bench_work  *work;
+	size_t  size;
+
+	for (;;) {
+		if (rtems_message_queue_receive(work_queues[queue_id], &work,
+						&size, RTEMS_WAIT,
+						RTEMS_NO_TIMEOUT) == 0) {
+			work->handler(work);
+		}
+	}
+}
+
+int bench_work_queue_create(int queue_id, int priority)
+{
+	rtems_status_code  status;
+
+	if ((queue_id < 0) || (queue_id >= MAX_WORK_QUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	status = rtems_message_queue_create(rtems_build_name('w', 'o', 'r', 'k'),
+					    WORK_QUEUE_LENGTH,
+					    sizeof(bench_work *),
+					    RTEMS_FIFO | RTEMS_LOCAL,
+					    &work_queues[queue_id]);
+	if (status != 0) {
+		return BENCH_ERROR;
+	}
+
+	status = rtems_task_create(rtems_build_name('w', 'o', 'r', 'k'),
+				   map_prio(priority),
+				   RTEMS_CONFIGURED_MINIMUM_STACK_SIZE,
+				   RTEMS_PREEMPT | RTEMS_NO_TIMESLICE,
+				   RTEMS_LOCAL | RTEMS_NO_FLOATING_POINT,
+				   &work_queue_tasks[queue_id]);
+	if (status != 0) {
+		return BENCH_ERROR;
+	}
+
+	status = rtems_task_start(work_queue_tasks[queue_id], work_queue_task,
+				  (rtems_task_argument)queue_id);
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
+
+int bench_work_init(bench_work *work, bench_work_handler_t handler)
+{
+	work->handler = handler;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_submit(int queue_id, bench_work *work)
+{
+	rtems_status_code  status;
+
+	/* RTEMS has no work queue of its own */
+
+	if ((queue_id < 0) || (queue_id >= MAX_WORK_QUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	status = rtems_message_queue_send(work_queues[queue_id], &work,
+					  sizeof(work));
+
+	return (status != 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
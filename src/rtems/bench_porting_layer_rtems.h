@@ -15,6 +15,11 @@
 
 typedef uint64_t bench_time_t;
 
+/* A work item is queued by its address */
+typedef struct bench_work {
+	void (*handler)(struct bench_work *work);
+} bench_work;
+
 /* defines */
 
 #define PRINTF(FMT, ...)    printf(FMT, ##__VA_ARGS__)
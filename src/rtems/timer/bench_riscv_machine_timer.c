@@ -114,10 +114,62 @@ bench_time_t bench_timer_isr_expiry_set(uint32_t usec)
 	return (bench_time_t) next;
 }
 
+/* Period and next expiry of the periodic mode (0 if not active) */
+static uint64_t periodic_cycles;
+static uint64_t periodic_next;
+
+/**
+ * @brief Sets the timer ISR to trigger every @a usec microseconds
+ *
+ * MTIMECMP has no reload, so bench_timer_isr_periodic_ack() advances it
+ * by one period from the ISR.
+ */
+int bench_timer_isr_periodic_set(uint32_t usec)
+{
+	uint64_t cyc_per_sec;
+
+	cyc_per_sec = (uint64_t) bench_timer_cycles_per_second();
+	cyc_per_sec >>= CONFIG_RISCV_MACHINE_TIMER_SYSTEM_CLOCK_DIVIDER;
+	periodic_cycles = (cyc_per_sec * usec) / 1000000ULL;
+
+	if (periodic_cycles == 0) {
+		return BENCH_ERROR;
+	}
+
+	periodic_next = mtime() + periodic_cycles;
+
+	set_mtimecmp(periodic_next);
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Program MTIMECMP for the next period
+ *
+ * The interrupt stays pending while MTIME is at or past MTIMECMP, so
+ * expiries that have already passed are skipped rather than taken back
+ * to back.
+ */
+void bench_timer_isr_periodic_ack(void)
+{
+	uint64_t now = mtime();
+
+	if (periodic_cycles == 0) {
+		return;
+	}
+
+	do {
+		periodic_next += periodic_cycles;
+	} while ((int64_t)(periodic_next - now) <= 0);
+
+	set_mtimecmp(periodic_next);
+}
+
 /**
  * @brief Restore both the old timer ISR handler and its tick rate
  */
 void bench_timer_isr_restore(bench_isr_handler_t handler)
 {
+	periodic_cycles = 0;
 	bench_timer_isr_set(handler);
 }
@@ -6,14 +6,81 @@
 
 
 #include "bench_api.h"
+#include "bench_utils.h"
 
 static TASK_ID   g_bench_tIds[CONFIG_RTOS_BENCHMARK_MAXTHREADS];
 static SEM_ID    g_bench_semaphores[CONFIG_RTOS_BENCHMARK_MAXSEMAPHORES];
 static SEM_ID    g_bench_mutex[CONFIG_RTOS_BENCHMARK_MAXMUTEXES];
 static MSG_Q_ID  g_bench_msgQ[CONFIG_RTOS_BENCHMARK_MAXMSGQS];
 
+/*
+ * A condition variable is a FIFO of the tasks waiting on it, protected by
+ * the mutex that they wait with. Signaling removes a task from the list and
+ * sends it VXEV02.
+ */
+struct bench_condvar_waiter {
+	struct bench_condvar_waiter *next;
+	TASK_ID   tid;
+};
+
+struct bench_condvar {
+	struct bench_condvar_waiter  *head;
+	struct bench_condvar_waiter **tail;
+};
+
+static struct bench_condvar g_bench_condvars[CONFIG_RTOS_BENCHMARK_MAXCONDVARS];
+
+/*
+ * VxWorks events are sent to tasks, so an event object is a set of flags
+ * and a list of the tasks waiting on it, protected by a mutex. Posting
+ * removes each task whose wait is satisfied from the list and sends it
+ * VXEV01.
+ */
+struct bench_event_waiter {
+	struct bench_event_waiter *next;
+	TASK_ID   tid;
+	uint32_t  flags;
+	bool      all;
+	uint32_t  result;
+};
+
+struct bench_event {
+	SEM_ID    lock;
+	uint32_t  flags;
+	struct bench_event_waiter *waiters;
+};
+
+static struct bench_event g_bench_events[CONFIG_RTOS_BENCHMARK_MAXEVENTS];
+
+/*
+ * A work queue is a list of pending work items protected by a mutex, with a
+ * counting semaphore of them, and a task that runs them.
+ */
+struct bench_work_queue {
+	SEM_ID lock;
+	SEM_ID count;
+	bench_work *head;
+	bench_work **tail;
+};
+
+static struct bench_work_queue
+	g_bench_work_queues[CONFIG_RTOS_BENCHMARK_MAXWORKQUEUES];
+
+/*
+ * A pool is a memory partition holding its blocks, paired with a counting
+ * semaphore of the free blocks so that allocation blocks when exhausted.
+ */
+#define POOL_BLOCK_OVERHEAD  64
+#define POOL_PART_OVERHEAD   1024
+
+static PART_ID   g_bench_pools[CONFIG_RTOS_BENCHMARK_MAXPOOLS];
+static SEM_ID    g_bench_pool_sems[CONFIG_RTOS_BENCHMARK_MAXPOOLS];
+static size_t    g_bench_pool_block_sizes[CONFIG_RTOS_BENCHMARK_MAXPOOLS];
+static char     *g_bench_pool_buffers[CONFIG_RTOS_BENCHMARK_MAXPOOLS];
+
 void bench_test_init(void (*test_init_function)(void *))
 {
+	bench_timing_overhead_calibrate();
 	test_init_function(NULL);
 }
 
@@ -152,6 +219,207 @@ int bench_mutex_unlock(int mutex_id)
 	return BENCH_SUCCESS;
 }
 
+int bench_condvar_create(int condvar_id)
+{
+	g_bench_condvars[condvar_id].head = NULL;
+	g_bench_condvars[condvar_id].tail = &g_bench_condvars[condvar_id].head;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id, int mutex_id)
+{
+	struct bench_condvar *condvar = &g_bench_condvars[condvar_id];
+	struct bench_condvar_waiter waiter;
+	UINT32 received;
+	STATUS ret;
+
+	waiter.tid = taskIdSelf();
+	waiter.next = NULL;
+	*condvar->tail = &waiter;
+	condvar->tail = &waiter.next;
+
+	semGive(g_bench_mutex[mutex_id]);
+
+	/* A signal before the task waits leaves VXEV02 pending */
+
+	ret = eventReceive(VXEV02, EVENTS_WAIT_ANY, WAIT_FOREVER, &received);
+
+	semTake(g_bench_mutex[mutex_id], WAIT_FOREVER);
+
+	if (ret == ERROR) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_signal(int condvar_id)
+{
+	struct bench_condvar *condvar = &g_bench_condvars[condvar_id];
+	struct bench_condvar_waiter *waiter = condvar->head;
+
+	if (waiter == NULL) {
+		return BENCH_SUCCESS;
+	}
+
+	condvar->head = waiter->next;
+	if (condvar->head == NULL) {
+		condvar->tail = &condvar->head;
+	}
+
+	eventSend(waiter->tid, VXEV02);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	struct bench_condvar *condvar = &g_bench_condvars[condvar_id];
+	struct bench_condvar_waiter *waiter = condvar->head;
+	struct bench_condvar_waiter *next;
+
+	condvar->head = NULL;
+	condvar->tail = &condvar->head;
+
+	while (waiter != NULL) {
+		next = waiter->next;
+		eventSend(waiter->tid, VXEV02);
+		waiter = next;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_delete(int condvar_id)
+{
+	if (g_bench_condvars[condvar_id].head != NULL) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_create(int event_id)
+{
+	g_bench_events[event_id].lock = semMCreate(SEM_Q_PRIORITY |
+		SEM_INVERSION_SAFE);
+
+	if (g_bench_events[event_id].lock == SEM_ID_NULL) {
+		return BENCH_ERROR;
+	}
+
+	g_bench_events[event_id].flags = 0;
+	g_bench_events[event_id].waiters = NULL;
+
+	return BENCH_SUCCESS;
+}
+
+static bool event_satisfied(uint32_t set, uint32_t flags, bool all)
+{
+	return all ? (set == flags) : (set != 0);
+}
+
+int bench_event_post(int event_id, uint32_t flags)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+	struct bench_event_waiter **prev;
+	struct bench_event_waiter *waiter;
+	uint32_t set;
+
+	if (semTake(event->lock, WAIT_FOREVER) == ERROR) {
+		return BENCH_ERROR;
+	}
+
+	event->flags |= flags;
+
+	prev = &event->waiters;
+	while ((waiter = *prev) != NULL) {
+		set = event->flags & waiter->flags;
+		if (event_satisfied(set, waiter->flags, waiter->all)) {
+			/* The woken task may run (and return) at once */
+
+			*prev = waiter->next;
+			waiter->result = set;
+			eventSend(waiter->tid, VXEV01);
+		} else {
+			prev = &waiter->next;
+		}
+	}
+
+	semGive(event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+static uint32_t event_wait(int event_id, uint32_t flags, bool all)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+	struct bench_event_waiter waiter;
+	UINT32 received;
+	uint32_t set;
+
+	if (semTake(event->lock, WAIT_FOREVER) == ERROR) {
+		return 0;
+	}
+
+	set = event->flags & flags;
+	if (event_satisfied(set, flags, all)) {
+		semGive(event->lock);
+		return set;
+	}
+
+	waiter.tid = taskIdSelf();
+	waiter.flags = flags;
+	waiter.all = all;
+	waiter.next = event->waiters;
+	event->waiters = &waiter;
+
+	semGive(event->lock);
+
+	/* A post between releasing the lock and here leaves VXEV01 pending */
+
+	if (eventReceive(VXEV01, EVENTS_WAIT_ANY, WAIT_FOREVER,
+			 &received) == ERROR) {
+		return 0;
+	}
+
+	return waiter.result;
+}
+
+uint32_t bench_event_wait_any(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, false);
+}
+
+uint32_t bench_event_wait_all(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, true);
+}
+
+int bench_event_clear(int event_id, uint32_t flags)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+
+	if (semTake(event->lock, WAIT_FOREVER) == ERROR) {
+		return BENCH_ERROR;
+	}
+
+	event->flags &= ~flags;
+	semGive(event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_delete(int event_id)
+{
+	if (semDelete(g_bench_events[event_id].lock) == ERROR) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
 void * bench_malloc(size_t size)
 {
 	return malloc(size);
@@ -162,6 +430,66 @@ void bench_free(void *ptr)
 	free(ptr);
 }
 
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size)
+{
+	size_t size = block_num * (block_size + POOL_BLOCK_OVERHEAD) +
+		POOL_PART_OVERHEAD;
+
+	if ((pool_id < 0) || (pool_id >= CONFIG_RTOS_BENCHMARK_MAXPOOLS) ||
+	    (block_num == 0)) {
+		return BENCH_ERROR;
+	}
+
+	g_bench_pool_buffers[pool_id] = malloc(size);
+	if (g_bench_pool_buffers[pool_id] == NULL) {
+		return BENCH_ERROR;
+	}
+
+	g_bench_pools[pool_id] = memPartCreate(g_bench_pool_buffers[pool_id],
+		size);
+	g_bench_pool_sems[pool_id] = semCCreate(SEM_INTERRUPTIBLE |
+		SEM_Q_PRIORITY, block_num);
+	g_bench_pool_block_sizes[pool_id] = block_size;
+
+	if ((g_bench_pools[pool_id] == NULL) ||
+	    (g_bench_pool_sems[pool_id] == SEM_ID_NULL)) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	if (semTake(g_bench_pool_sems[pool_id], WAIT_FOREVER) == ERROR) {
+		return NULL;
+	}
+
+	return memPartAlloc(g_bench_pools[pool_id],
+		g_bench_pool_block_sizes[pool_id]);
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	(void)memPartFree(g_bench_pools[pool_id], block);
+	(void)semGive(g_bench_pool_sems[pool_id]);
+}
+
+int bench_pool_delete(int pool_id)
+{
+	STATUS ret;
+
+	ret = semDelete(g_bench_pool_sems[pool_id]);
+	ret |= memPartDelete(g_bench_pools[pool_id]);
+	free(g_bench_pool_buffers[pool_id]);
+
+	if (ret == ERROR) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
 int bench_message_queue_create(int mq_id, const char *mq_name,
 	size_t msg_max_num, size_t msg_max_len)
 {
@@ -215,3 +543,181 @@ int bench_message_queue_delete(int mq_id, const char *mq_name)
 	return BENCH_SUCCESS;
 }
 
+/*
+ * Software timers are POSIX timers that raise SIGRTMIN, whose value is the
+ * ID of the timer. The signal handler then calls the handler of the timer.
+ */
+
+static timer_t g_bench_soft_timers[BENCH_SOFT_TIMER_MAX_NUM];
+static bench_soft_timer_handler_t
+	g_bench_soft_timer_handlers[BENCH_SOFT_TIMER_MAX_NUM];
+static void *g_bench_soft_timer_args[BENCH_SOFT_TIMER_MAX_NUM];
+static bool g_bench_soft_timer_connected;
+
+static void soft_timer_signal_handler(int signo, siginfo_t *info,
+				      void *context)
+{
+	int timer_id = info->si_value.sival_int;
+
+	g_bench_soft_timer_handlers[timer_id](g_bench_soft_timer_args[timer_id]);
+}
+
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg)
+{
+	struct sigaction sa;
+	struct sigevent sev;
+
+	if ((timer_id < 0) || (timer_id >= BENCH_SOFT_TIMER_MAX_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	if (!g_bench_soft_timer_connected) {
+		sa.sa_sigaction = soft_timer_signal_handler;
+		sa.sa_flags = SA_SIGINFO;
+		sigemptyset(&sa.sa_mask);
+
+		if (sigaction(SIGRTMIN, &sa, NULL) != 0) {
+			return BENCH_ERROR;
+		}
+
+		g_bench_soft_timer_connected = true;
+	}
+
+	g_bench_soft_timer_handlers[timer_id] = handler;
+	g_bench_soft_timer_args[timer_id] = arg;
+
+	memset(&sev, 0, sizeof(sev));
+	sev.sigev_notify = SIGEV_SIGNAL;
+	sev.sigev_signo = SIGRTMIN;
+	sev.sigev_value.sival_int = timer_id;
+
+	if (timer_create(CLOCK_MONOTONIC, &sev,
+			 &g_bench_soft_timers[timer_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = usec / 1000000;
+	its.it_value.tv_nsec = (usec % 1000000) * 1000;
+	if (periodic) {
+		its.it_interval = its.it_value;
+	}
+
+	if (timer_settime(g_bench_soft_timers[timer_id], 0, &its, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_stop(int timer_id)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+
+	if (timer_settime(g_bench_soft_timers[timer_id], 0, &its, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_delete(int timer_id)
+{
+	if (timer_delete(g_bench_soft_timers[timer_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+static void work_queue_task(struct bench_work_queue *queue)
+{
+	bench_work *work;
+
+	for (;;) {
+		semTake(queue->count, WAIT_FOREVER);
+
+		semTake(queue->lock, WAIT_FOREVER);
+		work = queue->head;
+		queue->head = work->next;
+		if (queue->head == NULL) {
+			queue->tail = &queue->head;
+		}
+		semGive(queue->lock);
+
+		work->handler(work);
+	}
+}
+
+int bench_work_queue_create(int queue_id, int priority)
+{
+	struct bench_work_queue *queue;
+	TASK_ID tid;
+
+	if ((queue_id < 0) ||
+	    (queue_id >= CONFIG_RTOS_BENCHMARK_MAXWORKQUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	queue = &g_bench_work_queues[queue_id];
+	queue->head = NULL;
+	queue->tail = &queue->head;
+	queue->lock = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+	queue->count = semCCreate(SEM_Q_PRIORITY, 0);
+
+	if ((queue->lock == SEM_ID_NULL) || (queue->count == SEM_ID_NULL)) {
+		return BENCH_ERROR;
+	}
+
+	tid = taskSpawn("bench_work", priority, VX_NO_STACK_FILL,
+		TASK_STACK_SIZE, (FUNCPTR)work_queue_task,
+		(_Vx_usr_arg_t)queue, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L);
+
+	if (tid == TASK_ID_ERROR) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_init(bench_work *work, bench_work_handler_t handler)
+{
+	work->next = NULL;
+	work->handler = handler;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_submit(int queue_id, bench_work *work)
+{
+	struct bench_work_queue *queue;
+
+	/* VxWorks has no work queue for RTPs */
+
+	if ((queue_id < 0) ||
+	    (queue_id >= CONFIG_RTOS_BENCHMARK_MAXWORKQUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	queue = &g_bench_work_queues[queue_id];
+
+	semTake(queue->lock, WAIT_FOREVER);
+	work->next = NULL;
+	*queue->tail = work;
+	queue->tail = &work->next;
+	semGive(queue->lock);
+
+	semGive(queue->count);
+
+	return BENCH_SUCCESS;
+}
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sched.h>
+#include <signal.h>
 #include <time.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -24,16 +25,22 @@
 #include <sysLib.h>
 #include <taskLib.h>
 #include <semLib.h>
+#include <eventLib.h>
 #include <msgQLib.h>
+#include <memPartLib.h>
 #include <private/schedP.h>
 #include <private/clockLibP.h>
 
 #define CONFIG_RTOS_BENCHMARK_PRIORITY      rtpMainPri
 #define CONFIG_RTOS_BENCHMARK_ITERATIONS    1000
-#define CONFIG_RTOS_BENCHMARK_MAXTHREADS    20
+#define CONFIG_RTOS_BENCHMARK_MAXTHREADS    BENCH_THREAD_MAX_NUM
 #define CONFIG_RTOS_BENCHMARK_MAXSEMAPHORES 20
 #define CONFIG_RTOS_BENCHMARK_MAXMUTEXES    10
+#define CONFIG_RTOS_BENCHMARK_MAXCONDVARS   1
+#define CONFIG_RTOS_BENCHMARK_MAXEVENTS     1
 #define CONFIG_RTOS_BENCHMARK_MAXMSGQS      20
+#define CONFIG_RTOS_BENCHMARK_MAXPOOLS      1
+#define CONFIG_RTOS_BENCHMARK_MAXWORKQUEUES 1
 
 #define BENCH_LAST_PRIORITY CONFIG_RTOS_BENCHMARK_PRIORITY
 #define ITERATIONS          CONFIG_RTOS_BENCHMARK_ITERATIONS
@@ -66,7 +73,15 @@
 #define TASK_STACK_SIZE  (size_t) 10000
 
 typedef uint64_t bench_time_t;
-typedef void * bench_work;
+
+/*
+ * A work item is linked into the list of its work queue while it is
+ * pending.
+ */
+typedef struct bench_work {
+	struct bench_work *next;
+	void (*handler)(struct bench_work *work);
+} bench_work;
 
 typedef enum       /* TIMER_TYPE - timer used for timestamping */
     {
@@ -6,14 +6,53 @@
 
 
 #include "bench_api.h"
+#include "bench_utils.h"
 
 static pthread_t       g_bench_threads[CONFIG_RTOS_BENCHMARK_MAXTHREADS];
 static sem_t           g_bench_semaphores[CONFIG_RTOS_BENCHMARK_MAXSEMAPHORES];
 static pthread_mutex_t g_bench_mutex[CONFIG_RTOS_BENCHMARK_MAXMUTEXES];
+static pthread_cond_t  g_bench_condvars[CONFIG_RTOS_BENCHMARK_MAXCONDVARS];
 static mqd_t           g_bench_msgQ[CONFIG_RTOS_BENCHMARK_MAXMSGQS];
 
+/*
+ * An event object is a set of flags protected by a mutex. Waiters sleep on
+ * a condition variable that is broadcast whenever flags are posted.
+ */
+struct bench_event {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	uint32_t flags;
+};
+
+static struct bench_event g_bench_events[CONFIG_RTOS_BENCHMARK_MAXEVENTS];
+
+/*
+ * A work queue is a list of pending work items protected by a mutex, with a
+ * semaphore counting them, and a thread that runs them.
+ */
+struct bench_work_queue {
+	pthread_mutex_t lock;
+	sem_t count;
+	bench_work *head;
+	bench_work **tail;
+};
+
+static struct bench_work_queue
+	g_bench_work_queues[CONFIG_RTOS_BENCHMARK_MAXWORKQUEUES];
+
+/*
+ * A pool is a list of free blocks, linked through their first word, with a
+ * semaphore counting them.
+ */
+static sem_t g_bench_pool_sems[CONFIG_RTOS_BENCHMARK_MAXPOOLS];
+static pthread_mutex_t g_bench_pool_locks[CONFIG_RTOS_BENCHMARK_MAXPOOLS];
+static void *g_bench_pool_free_lists[CONFIG_RTOS_BENCHMARK_MAXPOOLS];
+static char g_bench_pool_buffers[CONFIG_RTOS_BENCHMARK_MAXPOOLS][BENCH_POOL_MAX_SIZE]
+	__attribute__((__aligned__(sizeof(void *))));
+
 void bench_test_init(void (*test_init_function)(void *))
 {
+	bench_timing_overhead_calibrate();
 	test_init_function(NULL);
 }
 
@@ -183,6 +222,140 @@ int bench_mutex_unlock(int mutex_id)
 	return BENCH_SUCCESS;
 }
 
+int bench_condvar_create(int condvar_id)
+{
+	if (pthread_cond_init(&g_bench_condvars[condvar_id], NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id, int mutex_id)
+{
+	if (pthread_cond_wait(&g_bench_condvars[condvar_id], &g_bench_mutex[mutex_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_signal(int condvar_id)
+{
+	if (pthread_cond_signal(&g_bench_condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	if (pthread_cond_broadcast(&g_bench_condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_delete(int condvar_id)
+{
+	if (pthread_cond_destroy(&g_bench_condvars[condvar_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_create(int event_id)
+{
+	pthread_mutexattr_t attr;
+	int ret;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	ret = pthread_mutex_init(&g_bench_events[event_id].lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	if (pthread_cond_init(&g_bench_events[event_id].cond, NULL) != 0) {
+		pthread_mutex_destroy(&g_bench_events[event_id].lock);
+		return BENCH_ERROR;
+	}
+
+	g_bench_events[event_id].flags = 0;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_post(int event_id, uint32_t flags)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+
+	pthread_mutex_lock(&event->lock);
+	event->flags |= flags;
+	pthread_cond_broadcast(&event->cond);
+	pthread_mutex_unlock(&event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+static uint32_t event_wait(int event_id, uint32_t flags, bool all)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+	uint32_t set;
+
+	pthread_mutex_lock(&event->lock);
+	for (;;) {
+		set = event->flags & flags;
+		if (all ? (set == flags) : (set != 0)) {
+			break;
+		}
+		pthread_cond_wait(&event->cond, &event->lock);
+	}
+	pthread_mutex_unlock(&event->lock);
+
+	return set;
+}
+
+uint32_t bench_event_wait_any(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, false);
+}
+
+uint32_t bench_event_wait_all(int event_id, uint32_t flags)
+{
+	return event_wait(event_id, flags, true);
+}
+
+int bench_event_clear(int event_id, uint32_t flags)
+{
+	struct bench_event *event = &g_bench_events[event_id];
+
+	pthread_mutex_lock(&event->lock);
+	event->flags &= ~flags;
+	pthread_mutex_unlock(&event->lock);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_delete(int event_id)
+{
+	int ret;
+
+	ret = pthread_cond_destroy(&g_bench_events[event_id].cond);
+	ret |= pthread_mutex_destroy(&g_bench_events[event_id].lock);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
 void * bench_malloc(size_t size)
 {
 	return malloc(size);
@@ -193,6 +366,76 @@ void bench_free(void * ptr)
 	free(ptr);
 }
 
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size)
+{
+	size_t size = (block_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	void *block;
+	size_t i;
+
+	if ((pool_id < 0) || (pool_id >= CONFIG_RTOS_BENCHMARK_MAXPOOLS) || (block_num == 0) ||
+	    (block_num * size > BENCH_POOL_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	g_bench_pool_free_lists[pool_id] = NULL;
+	for (i = block_num; i > 0; i--) {
+		block = &g_bench_pool_buffers[pool_id][(i - 1) * size];
+		*(void **)block = g_bench_pool_free_lists[pool_id];
+		g_bench_pool_free_lists[pool_id] = block;
+	}
+
+	if (pthread_mutex_init(&g_bench_pool_locks[pool_id], NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	if (sem_init(&g_bench_pool_sems[pool_id], 0, block_num) != 0) {
+		pthread_mutex_destroy(&g_bench_pool_locks[pool_id]);
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	void *block;
+
+	if (sem_wait(&g_bench_pool_sems[pool_id]) != 0) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_bench_pool_locks[pool_id]);
+	block = g_bench_pool_free_lists[pool_id];
+	g_bench_pool_free_lists[pool_id] = *(void **)block;
+	pthread_mutex_unlock(&g_bench_pool_locks[pool_id]);
+
+	return block;
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	pthread_mutex_lock(&g_bench_pool_locks[pool_id]);
+	*(void **)block = g_bench_pool_free_lists[pool_id];
+	g_bench_pool_free_lists[pool_id] = block;
+	pthread_mutex_unlock(&g_bench_pool_locks[pool_id]);
+
+	sem_post(&g_bench_pool_sems[pool_id]);
+}
+
+int bench_pool_delete(int pool_id)
+{
+	int ret;
+
+	ret = sem_destroy(&g_bench_pool_sems[pool_id]);
+	ret |= pthread_mutex_destroy(&g_bench_pool_locks[pool_id]);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
 int bench_message_queue_create(int mq_id, const char *mq_name,
 	size_t msg_max_num, size_t msg_max_len)
 {
@@ -251,3 +494,194 @@ int bench_message_queue_delete(int mq_id, const char *mq_name)
 	return BENCH_SUCCESS;
 }
 
+/*
+ * Software timers are POSIX timers that raise SIGRTMIN, whose value is the
+ * ID of the timer. The signal handler then calls the handler of the timer.
+ */
+
+static timer_t g_bench_soft_timers[BENCH_SOFT_TIMER_MAX_NUM];
+static bench_soft_timer_handler_t
+	g_bench_soft_timer_handlers[BENCH_SOFT_TIMER_MAX_NUM];
+static void *g_bench_soft_timer_args[BENCH_SOFT_TIMER_MAX_NUM];
+static bool g_bench_soft_timer_connected;
+
+static void soft_timer_signal_handler(int signo, siginfo_t *info,
+				      void *context)
+{
+	int timer_id = info->si_value.sival_int;
+
+	g_bench_soft_timer_handlers[timer_id](g_bench_soft_timer_args[timer_id]);
+}
+
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg)
+{
+	struct sigaction sa;
+	struct sigevent sev;
+
+	if ((timer_id < 0) || (timer_id >= BENCH_SOFT_TIMER_MAX_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	if (!g_bench_soft_timer_connected) {
+		sa.sa_sigaction = soft_timer_signal_handler;
+		sa.sa_flags = SA_SIGINFO;
+		sigemptyset(&sa.sa_mask);
+
+		if (sigaction(SIGRTMIN, &sa, NULL) != 0) {
+			return BENCH_ERROR;
+		}
+
+		g_bench_soft_timer_connected = true;
+	}
+
+	g_bench_soft_timer_handlers[timer_id] = handler;
+	g_bench_soft_timer_args[timer_id] = arg;
+
+	memset(&sev, 0, sizeof(sev));
+	sev.sigev_notify = SIGEV_SIGNAL;
+	sev.sigev_signo = SIGRTMIN;
+	sev.sigev_value.sival_int = timer_id;
+
+	if (timer_create(CLOCK_MONOTONIC, &sev,
+			 &g_bench_soft_timers[timer_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = usec / 1000000;
+	its.it_value.tv_nsec = (usec % 1000000) * 1000;
+	if (periodic) {
+		its.it_interval = its.it_value;
+	}
+
+	if (timer_settime(g_bench_soft_timers[timer_id], 0, &its, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_stop(int timer_id)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+
+	if (timer_settime(g_bench_soft_timers[timer_id], 0, &its, NULL) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_delete(int timer_id)
+{
+	if (timer_delete(g_bench_soft_timers[timer_id]) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+static void *work_queue_thread(void *arg)
+{
+	struct bench_work_queue *queue = arg;
+	bench_work *work;
+
+	for (;;) {
+		sem_wait(&queue->count);
+
+		pthread_mutex_lock(&queue->lock);
+		work = queue->head;
+		queue->head = work->next;
+		if (queue->head == NULL) {
+			queue->tail = &queue->head;
+		}
+		pthread_mutex_unlock(&queue->lock);
+
+		work->handler(work);
+	}
+
+	return NULL;
+}
+
+int bench_work_queue_create(int queue_id, int priority)
+{
+	struct bench_work_queue *queue;
+	struct sched_param param;
+	pthread_attr_t     attr;
+	pthread_t          thread;
+	int                ret;
+
+	if ((queue_id < 0) ||
+	    (queue_id >= CONFIG_RTOS_BENCHMARK_MAXWORKQUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	queue = &g_bench_work_queues[queue_id];
+	queue->head = NULL;
+	queue->tail = &queue->head;
+
+	if ((pthread_mutex_init(&queue->lock, NULL) != 0) ||
+	    (sem_init(&queue->count, 0, 0) != 0)) {
+		return BENCH_ERROR;
+	}
+
+	pthread_attr_init(&attr);
+	param.sched_priority = map_prio(priority);
+	pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+	pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	pthread_attr_setname(&attr, "bench_work");
+	pthread_attr_setschedparam(&attr, &param);
+
+	ret = pthread_create(&thread, &attr, work_queue_thread, queue);
+
+	pthread_attr_destroy(&attr);
+
+	if (ret != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_init(bench_work *work, bench_work_handler_t handler)
+{
+	work->next = NULL;
+	work->handler = handler;
+
+	return BENCH_SUCCESS;
+}
+
+int bench_work_submit(int queue_id, bench_work *work)
+{
+	struct bench_work_queue *queue;
+
+	/* VxWorks has no work queue for RTPs */
+
+	if ((queue_id < 0) ||
+	    (queue_id >= CONFIG_RTOS_BENCHMARK_MAXWORKQUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	queue = &g_bench_work_queues[queue_id];
+
+	pthread_mutex_lock(&queue->lock);
+	work->next = NULL;
+	*queue->tail = work;
+	queue->tail = &work->next;
+	pthread_mutex_unlock(&queue->lock);
+
+	sem_post(&queue->count);
+
+	return BENCH_SUCCESS;
+}
@@ -15,6 +15,11 @@ void bench_sync_ticks(void)
 	taskDelay(1);
 }
 
+uint64_t bench_tick_count_get(void)
+{
+	return tick64Get();
+}
+
 void bench_timing_start(void)
 {
 }
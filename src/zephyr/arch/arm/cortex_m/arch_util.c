@@ -59,3 +59,46 @@ void bench_timer_isr_set(bench_isr_handler_t  isr)
 #error "Unable to set ISR handler for Cortex-M"
 #endif
 }
+
+/*
+ * Software interrupts use the last NVIC lines, which are set pending by
+ * software. They must not be used by a peripheral on the board.
+ */
+
+#ifndef BENCH_SOFT_IRQ_LINE
+#define BENCH_SOFT_IRQ_LINE  (CONFIG_NUM_IRQS - BENCH_SOFT_IRQ_NUM)
+#endif
+
+/* Zephyr priorities of the software interrupts (lower preempts higher) */
+static const unsigned int soft_irq_priorities[BENCH_SOFT_IRQ_NUM] = { 1, 2 };
+
+int bench_soft_irq_connect(int irq_id, bench_isr_handler_t handler)
+{
+#ifdef CONFIG_DYNAMIC_INTERRUPTS
+	unsigned int irq = BENCH_SOFT_IRQ_LINE + irq_id;
+
+	irq_connect_dynamic(irq, soft_irq_priorities[irq_id],
+			    (void (*)(const void *))handler, NULL, 0);
+	irq_enable(irq);
+
+	return BENCH_SUCCESS;
+#else
+	ARG_UNUSED(irq_id);
+	ARG_UNUSED(handler);
+
+	return BENCH_ERROR;
+#endif
+}
+
+void bench_soft_irq_trigger(int irq_id)
+{
+	NVIC_SetPendingIRQ((IRQn_Type)(BENCH_SOFT_IRQ_LINE + irq_id));
+
+	__DSB();
+	__ISB();
+}
+
+void bench_soft_irq_disconnect(int irq_id)
+{
+	irq_disable(BENCH_SOFT_IRQ_LINE + irq_id);
+}
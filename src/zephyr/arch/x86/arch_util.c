@@ -53,3 +53,52 @@ void bench_timer_isr_set(bench_isr_handler_t  isr)
 #endif
 	return;
 }
+
+/*
+ * Software interrupts are self-IPIs sent through the local APIC. Each is
+ * connected to an otherwise unused IRQ line so that Zephyr allocates it a
+ * vector. The local APIC only delivers a vector while no vector of the same
+ * or a higher priority class (vector / 16) is in service.
+ */
+
+#include <zephyr/drivers/interrupt_controller/loapic.h>
+
+#ifndef BENCH_SOFT_IRQ_LINE
+#define BENCH_SOFT_IRQ_LINE  20
+#endif
+
+/* Fixed delivery to this CPU only */
+#define SOFT_IRQ_ICR_SELF  0x00044000U
+
+/* Zephyr priorities of the software interrupts (higher preempts lower) */
+static const unsigned int soft_irq_priorities[BENCH_SOFT_IRQ_NUM] = { 3, 2 };
+
+static uint8_t soft_irq_vectors[BENCH_SOFT_IRQ_NUM];
+
+int bench_soft_irq_connect(int irq_id, bench_isr_handler_t handler)
+{
+#ifdef CONFIG_DYNAMIC_INTERRUPTS
+	unsigned int irq = BENCH_SOFT_IRQ_LINE + irq_id;
+
+	irq_connect_dynamic(irq, soft_irq_priorities[irq_id],
+			    (void (*)(const void *))handler, NULL, 0);
+	soft_irq_vectors[irq_id] = Z_IRQ_TO_INTERRUPT_VECTOR(irq);
+
+	return BENCH_SUCCESS;
+#else
+	ARG_UNUSED(irq_id);
+	ARG_UNUSED(handler);
+
+	return BENCH_ERROR;
+#endif
+}
+
+void bench_soft_irq_trigger(int irq_id)
+{
+	z_loapic_ipi(0, SOFT_IRQ_ICR_SELF, soft_irq_vectors[irq_id]);
+}
+
+void bench_soft_irq_disconnect(int irq_id)
+{
+	ARG_UNUSED(irq_id);
+}
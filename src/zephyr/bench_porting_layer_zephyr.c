@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "bench_api.h"
+#include "bench_utils.h"
 #include "bench_porting_layer_zephyr.h"
 #include <zephyr/kernel.h>
 #include <zephyr/timing/timing.h>
@@ -9,10 +10,24 @@
 /*
  * Constants.
  */
-#define MAX_THREADS 10
+#define MAX_THREADS BENCH_THREAD_MAX_NUM
 #define STACK_SIZE 512
-#define MAX_SEMAPHORES 2
+#define MAX_SEMAPHORES 3
 #define MAX_MUTEXES 1
+#define MAX_CONDVARS 1
+#define MAX_EVENTS 1
+#define MAX_QUEUES 1
+#define MAX_CHANNELS 1
+#define MAX_POOLS 1
+#define MAX_WORK_QUEUES 1
+
+/*
+ * Each channel buffer is preceded by the word that k_fifo uses to link it
+ * while it is queued.
+ */
+#define CHANNEL_HDR_SIZE sizeof(void *)
+#define CHANNEL_BLOCK_SIZE \
+	ROUND_UP(BENCH_CHANNEL_MAX_BUF_SIZE + CHANNEL_HDR_SIZE, sizeof(void *))
 
 /*
  * Storage for data structures to be declared and used.
@@ -24,10 +39,74 @@ static K_THREAD_STACK_ARRAY_DEFINE(stacks, MAX_THREADS, STACK_SIZE);
 static struct k_thread threads[MAX_THREADS];
 static struct k_sem semaphores[MAX_SEMAPHORES];
 static struct k_mutex mutexes[MAX_MUTEXES];
+static struct k_condvar condvars[MAX_CONDVARS];
+static struct k_event events[MAX_EVENTS];
+static struct k_mem_slab pools[MAX_POOLS];
+static char __aligned(sizeof(void *))
+	pool_buffers[MAX_POOLS][BENCH_POOL_MAX_SIZE];
+static struct k_msgq queues[MAX_QUEUES];
+static char __aligned(sizeof(void *))
+	queue_buffers[MAX_QUEUES][BENCH_MQ_MAX_SIZE];
+static struct k_fifo channel_fifos[MAX_CHANNELS];
+static struct k_mem_slab channel_slabs[MAX_CHANNELS];
+static char __aligned(sizeof(void *))
+	channel_buffers[MAX_CHANNELS]
+		       [BENCH_CHANNEL_MAX_BUF_NUM * CHANNEL_BLOCK_SIZE];
+static K_THREAD_STACK_ARRAY_DEFINE(work_queue_stacks, MAX_WORK_QUEUES,
+				   STACK_SIZE);
+static struct k_work_q work_queues[MAX_WORK_QUEUES];
+
+#ifdef CONFIG_SCHED_CPU_MASK
+/* Pending CPU of each thread, applied when the thread is next created */
+static bool thread_pinned[MAX_THREADS];
+static int thread_cpus[MAX_THREADS];
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/* Cycles used by earlier threads created with each ID */
+static bool thread_used[MAX_THREADS];
+static uint64_t thread_cycles_exited[MAX_THREADS];
+#endif
+
+/**
+ * @brief Retire the run time of the previous thread created with an ID
+ */
+static void thread_runtime_retire(int thread_id)
+{
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	k_thread_runtime_stats_t stats;
+
+	if (thread_used[thread_id] &&
+	    (k_thread_runtime_stats_get(&threads[thread_id], &stats) == 0)) {
+		thread_cycles_exited[thread_id] += stats.execution_cycles;
+	}
+
+	thread_used[thread_id] = true;
+#else
+	ARG_UNUSED(thread_id);
+#endif
+}
+
+/**
+ * @brief Apply the pending CPU of a created but unstarted thread
+ */
+static void thread_cpu_apply(int thread_id)
+{
+#ifdef CONFIG_SCHED_CPU_MASK
+	if (thread_pinned[thread_id]) {
+		thread_pinned[thread_id] = false;
+		k_thread_cpu_pin(&threads[thread_id], thread_cpus[thread_id]);
+	}
+#else
+	ARG_UNUSED(thread_id);
+#endif
+}
 
 void bench_test_init(void (*test_init_function)(void *))
 {
 	void *param = NULL;
+
+	bench_timing_overhead_calibrate();
 	(test_init_function)(param);
 }
 
@@ -39,14 +118,14 @@ void bench_thread_set_priority(int priority)
 int bench_thread_create(int thread_id, const char *thread_name, int priority,
 	void (*entry_function)(void *), void *args)
 {
-	ARG_UNUSED(args);
-
 	if (thread_id >= 0 && thread_id < MAX_THREADS) {
+		thread_runtime_retire(thread_id);
 		k_thread_create(&threads[thread_id], stacks[thread_id],
 				STACK_SIZE,	(k_thread_entry_t) entry_function,
-				NULL, NULL, NULL,
+				args, NULL, NULL,
 				priority, 0, K_FOREVER);
 		k_thread_name_set(&threads[thread_id], thread_name);
+		thread_cpu_apply(thread_id);
 		return BENCH_SUCCESS;
 	} else {
 		return BENCH_ERROR;
@@ -56,14 +135,27 @@ int bench_thread_create(int thread_id, const char *thread_name, int priority,
 int bench_thread_spawn(int thread_id, const char *thread_name, int priority,
 	void (*entry_function)(void *), void *args)
 {
-	ARG_UNUSED(args);
-
 	if ((thread_id < 0) || (thread_id >= MAX_THREADS)) {
 		return BENCH_ERROR;
 	}
 
+	thread_runtime_retire(thread_id);
+
+#ifdef CONFIG_SCHED_CPU_MASK
+	if (thread_pinned[thread_id]) {
+		/* A thread may only be pinned before it is started */
+
+		k_thread_create(&threads[thread_id], stacks[thread_id],
+				STACK_SIZE, (k_thread_entry_t) entry_function,
+				args, NULL, NULL, priority, 0, K_FOREVER);
+		thread_cpu_apply(thread_id);
+		k_thread_start(&threads[thread_id]);
+		return BENCH_SUCCESS;
+	}
+#endif
+
 	k_thread_create(&threads[thread_id], stacks[thread_id], STACK_SIZE,
-			(k_thread_entry_t) entry_function, NULL, NULL, NULL,
+			(k_thread_entry_t) entry_function, args, NULL, NULL,
 			priority, 0, K_NO_WAIT);
 
 	return BENCH_SUCCESS;
@@ -94,6 +186,67 @@ void bench_yield(void)
 	k_yield();
 }
 
+int bench_cpu_count(void)
+{
+	return arch_num_cpus();
+}
+
+int bench_thread_cpu_set(int thread_id, int cpu)
+{
+	if ((thread_id < 0) || (thread_id >= MAX_THREADS) ||
+	    (cpu < 0) || (cpu >= bench_cpu_count())) {
+		return BENCH_ERROR;
+	}
+
+#ifdef CONFIG_SCHED_CPU_MASK
+	thread_cpus[thread_id] = cpu;
+	thread_pinned[thread_id] = true;
+
+	return BENCH_SUCCESS;
+#else
+	/* Without CONFIG_SCHED_CPU_MASK threads may run on any CPU */
+
+	return (bench_cpu_count() == 1) ? BENCH_SUCCESS : BENCH_ERROR;
+#endif
+}
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+int bench_thread_runtime_get(int thread_id, uint64_t *ns)
+{
+	k_thread_runtime_stats_t stats;
+	uint64_t cycles;
+
+	if (thread_id == BENCH_THREAD_SELF) {
+		if (k_thread_runtime_stats_get(k_current_get(), &stats) != 0) {
+			return BENCH_ERROR;
+		}
+		cycles = stats.execution_cycles;
+	} else if (thread_id == BENCH_THREAD_IDLE) {
+#ifdef CONFIG_SCHED_THREAD_USAGE_ALL
+		if (k_thread_runtime_stats_all_get(&stats) != 0) {
+			return BENCH_ERROR;
+		}
+		cycles = stats.idle_cycles;
+#else
+		return BENCH_ERROR;
+#endif
+	} else if ((thread_id >= 0) && (thread_id < MAX_THREADS) &&
+		   thread_used[thread_id]) {
+		if (k_thread_runtime_stats_get(&threads[thread_id],
+					       &stats) != 0) {
+			return BENCH_ERROR;
+		}
+		cycles = thread_cycles_exited[thread_id] +
+			 stats.execution_cycles;
+	} else {
+		return BENCH_ERROR;
+	}
+
+	*ns = k_cyc_to_ns_floor64(cycles);
+	return BENCH_SUCCESS;
+}
+#endif
+
 void bench_timing_init(void)
 {
 	timing_init();
@@ -104,6 +257,11 @@ void bench_sync_ticks(void)
 	k_sleep(K_TICKS(1));
 }
 
+uint64_t bench_tick_count_get(void)
+{
+	return k_uptime_ticks();
+}
+
 void bench_timing_start(void)
 {
 	timing_start();
@@ -169,6 +327,76 @@ int bench_mutex_unlock(int mutex_id)
 	return BENCH_SUCCESS;
 }
 
+int bench_condvar_create(int condvar_id)
+{
+	k_condvar_init(&condvars[condvar_id]);
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_wait(int condvar_id, int mutex_id)
+{
+	if (k_condvar_wait(&condvars[condvar_id], &mutexes[mutex_id],
+			   K_FOREVER) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_signal(int condvar_id)
+{
+	k_condvar_signal(&condvars[condvar_id]);
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_broadcast(int condvar_id)
+{
+	k_condvar_broadcast(&condvars[condvar_id]);
+	return BENCH_SUCCESS;
+}
+
+int bench_condvar_delete(int condvar_id)
+{
+	ARG_UNUSED(condvar_id);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_event_create(int event_id)
+{
+	k_event_init(&events[event_id]);
+	return BENCH_SUCCESS;
+}
+
+int bench_event_post(int event_id, uint32_t flags)
+{
+	k_event_post(&events[event_id], flags);
+	return BENCH_SUCCESS;
+}
+
+uint32_t bench_event_wait_any(int event_id, uint32_t flags)
+{
+	return k_event_wait(&events[event_id], flags, false, K_FOREVER);
+}
+
+uint32_t bench_event_wait_all(int event_id, uint32_t flags)
+{
+	return k_event_wait_all(&events[event_id], flags, false, K_FOREVER);
+}
+
+int bench_event_clear(int event_id, uint32_t flags)
+{
+	k_event_clear(&events[event_id], flags);
+	return BENCH_SUCCESS;
+}
+
+int bench_event_delete(int event_id)
+{
+	ARG_UNUSED(event_id);
+
+	return BENCH_SUCCESS;
+}
+
 void *bench_malloc(size_t size)
 {
 	return k_malloc(size);
@@ -179,7 +407,245 @@ void bench_free(void *ptr)
 	k_free(ptr);
 }
 
+#ifdef CONFIG_SYS_HEAP_RUNTIME_STATS
+int bench_heap_usage_get(size_t *used)
+{
+	extern struct k_heap _system_heap;
+	struct sys_memory_stats stats;
+
+	if (sys_heap_runtime_stats_get(&_system_heap.heap, &stats) != 0) {
+		return BENCH_ERROR;
+	}
+
+	*used = stats.allocated_bytes;
+	return BENCH_SUCCESS;
+}
+#endif
+
+int bench_pool_create(int pool_id, size_t block_num, size_t block_size)
+{
+	size_t size = ROUND_UP(block_size, sizeof(void *));
+
+	if ((pool_id < 0) || (pool_id >= MAX_POOLS) || (block_num == 0) ||
+	    (block_num * size > BENCH_POOL_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	if (k_mem_slab_init(&pools[pool_id], pool_buffers[pool_id], size,
+			    block_num) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+void *bench_pool_alloc(int pool_id)
+{
+	void *block;
+
+	if (k_mem_slab_alloc(&pools[pool_id], &block, K_FOREVER) != 0) {
+		return NULL;
+	}
+
+	return block;
+}
+
+void bench_pool_free(int pool_id, void *block)
+{
+	k_mem_slab_free(&pools[pool_id], block);
+}
+
+int bench_pool_delete(int pool_id)
+{
+	ARG_UNUSED(pool_id);
+
+	return BENCH_SUCCESS;
+}
+
 void bench_thread_exit(void)
 {
 	// NO-op on Zephyr
 }
+
+int bench_message_queue_create(int mq_id, const char *mq_name,
+	size_t msg_max_num, size_t msg_max_len)
+{
+	ARG_UNUSED(mq_name);
+
+	if ((mq_id < 0) || (mq_id >= MAX_QUEUES) ||
+	    (msg_max_num * msg_max_len > BENCH_MQ_MAX_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	k_msgq_init(&queues[mq_id], queue_buffers[mq_id], msg_max_len,
+		    msg_max_num);
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_send(int mq_id, char *msg_ptr, size_t msg_len)
+{
+	ARG_UNUSED(msg_len);
+
+	if (k_msgq_put(&queues[mq_id], msg_ptr, K_FOREVER) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_receive(int mq_id, char *msg_ptr, size_t msg_len)
+{
+	ARG_UNUSED(msg_len);
+
+	if (k_msgq_get(&queues[mq_id], msg_ptr, K_FOREVER) != 0) {
+		return BENCH_ERROR;
+	}
+
+	return BENCH_SUCCESS;
+}
+
+int bench_message_queue_delete(int mq_id, const char *mq_name)
+{
+	ARG_UNUSED(mq_name);
+
+	k_msgq_purge(&queues[mq_id]);
+	return BENCH_SUCCESS;
+}
+
+int bench_channel_create(int ch_id, size_t buf_num, size_t buf_size)
+{
+	size_t block_size = ROUND_UP(buf_size + CHANNEL_HDR_SIZE,
+				     sizeof(void *));
+
+	if ((ch_id < 0) || (ch_id >= MAX_CHANNELS) ||
+	    (buf_num == 0) || (buf_num > BENCH_CHANNEL_MAX_BUF_NUM) ||
+	    (buf_size == 0) || (buf_size > BENCH_CHANNEL_MAX_BUF_SIZE)) {
+		return BENCH_ERROR;
+	}
+
+	if (k_mem_slab_init(&channel_slabs[ch_id], channel_buffers[ch_id],
+			    block_size, buf_num) != 0) {
+		return BENCH_ERROR;
+	}
+
+	k_fifo_init(&channel_fifos[ch_id]);
+	return BENCH_SUCCESS;
+}
+
+void *bench_channel_alloc(int ch_id)
+{
+	void *block;
+
+	if (k_mem_slab_alloc(&channel_slabs[ch_id], &block, K_FOREVER) != 0) {
+		return NULL;
+	}
+
+	return (char *)block + CHANNEL_HDR_SIZE;
+}
+
+int bench_channel_send(int ch_id, void *buf)
+{
+	k_fifo_put(&channel_fifos[ch_id], (char *)buf - CHANNEL_HDR_SIZE);
+	return BENCH_SUCCESS;
+}
+
+void *bench_channel_receive(int ch_id)
+{
+	char *block = k_fifo_get(&channel_fifos[ch_id], K_FOREVER);
+
+	return (block != NULL) ? block + CHANNEL_HDR_SIZE : NULL;
+}
+
+void bench_channel_release(int ch_id, void *buf)
+{
+	k_mem_slab_free(&channel_slabs[ch_id], (char *)buf - CHANNEL_HDR_SIZE);
+}
+
+int bench_channel_delete(int ch_id)
+{
+	ARG_UNUSED(ch_id);
+
+	return BENCH_SUCCESS;
+}
+
+#ifdef CONFIG_IRQ_OFFLOAD
+int bench_irq_offload(bench_isr_handler_t handler, void *arg)
+{
+	irq_offload((irq_offload_routine_t)handler, arg);
+	return BENCH_SUCCESS;
+}
+#endif
+
+static struct k_timer soft_timers[BENCH_SOFT_TIMER_MAX_NUM];
+static bench_soft_timer_handler_t soft_timer_handlers[BENCH_SOFT_TIMER_MAX_NUM];
+
+static void soft_timer_expiry(struct k_timer *timer)
+{
+	int timer_id = timer - soft_timers;
+
+	soft_timer_handlers[timer_id](k_timer_user_data_get(timer));
+}
+
+int bench_soft_timer_create(int timer_id, bench_soft_timer_handler_t handler,
+			    void *arg)
+{
+	if ((timer_id < 0) || (timer_id >= BENCH_SOFT_TIMER_MAX_NUM)) {
+		return BENCH_ERROR;
+	}
+
+	soft_timer_handlers[timer_id] = handler;
+	k_timer_init(&soft_timers[timer_id], soft_timer_expiry, NULL);
+	k_timer_user_data_set(&soft_timers[timer_id], arg);
+
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_start(int timer_id, uint32_t usec, bool periodic)
+{
+	k_timer_start(&soft_timers[timer_id], K_USEC(usec),
+		      periodic ? K_USEC(usec) : K_NO_WAIT);
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_stop(int timer_id)
+{
+	k_timer_stop(&soft_timers[timer_id]);
+	return BENCH_SUCCESS;
+}
+
+int bench_soft_timer_delete(int timer_id)
+{
+	k_timer_stop(&soft_timers[timer_id]);
+	return BENCH_SUCCESS;
+}
+
+int bench_work_queue_create(int queue_id, int priority)
+{
+	if ((queue_id < 0) || (queue_id >= MAX_WORK_QUEUES)) {
+		return BENCH_ERROR;
+	}
+
+	k_work_queue_init(&work_queues[queue_id]);
+	k_work_queue_start(&work_queues[queue_id], work_queue_stacks[queue_id],
+			   STACK_SIZE, priority, NULL);
+	return BENCH_SUCCESS;
+}
+
+int bench_work_init(bench_work *work, bench_work_handler_t handler)
+{
+	k_work_init(work, handler);
+	return BENCH_SUCCESS;
+}
+
+int bench_work_submit(int queue_id, bench_work *work)
+{
+	int ret;
+
+	if (queue_id == BENCH_WORK_SYSTEM_QUEUE) {
+		ret = k_work_submit(work);
+	} else {
+		ret = k_work_submit_to_queue(&work_queues[queue_id], work);
+	}
+
+	return (ret < 0) ? BENCH_ERROR : BENCH_SUCCESS;
+}
@@ -27,5 +27,7 @@ typedef struct k_work bench_work;
 #define RTOS_HAS_THREAD_CREATE_START  1
 #define RTOS_HAS_SUSPEND_RESUME       1
 #define RTOS_HAS_MAIN_ENTRY_POINT     1
+#define RTOS_HAS_MESSAGE_QUEUE        1
+#define RTOS_HAS_CHANNEL              1
 
 #endif
@@ -60,6 +60,50 @@ bench_time_t bench_timer_isr_expiry_set(uint32_t usec)
 	return (bench_time_t)cycles;
 }
 
+/* Reload value of the periodic mode (0 if not active) */
+static uint32_t periodic_load;
+
+/**
+ * @brief Sets the timer ISR to trigger every @a usec microseconds
+ *
+ * SysTick reloads from its LOAD register each time it reaches zero.
+ */
+int bench_timer_isr_periodic_set(uint32_t usec)
+{
+	uint32_t  cycles_per_usec;
+	uint32_t  cycles;
+
+	cycles_per_usec = (bench_timer_cycles_per_second() + 999999) / 1000000;
+	cycles = cycles_per_usec * usec;
+
+	if ((cycles < 2) || (cycles - 1 > SysTick_LOAD_RELOAD_Msk)) {
+		return BENCH_ERROR;
+	}
+
+	periodic_load = cycles - 1;
+
+	SysTick->LOAD = periodic_load;
+	SysTick->VAL = 0;             /* resets timer to periodic_load */
+	SysTick->CTRL |= (SysTick_CTRL_ENABLE_Msk |
+			  SysTick_CTRL_TICKINT_Msk |
+			  SysTick_CTRL_CLKSOURCE_Msk);
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Restore the reload value of the periodic mode
+ *
+ * A chained system timer ISR may have programmed its own reload value.
+ * LOAD is only used at the next reload, so the current period is kept.
+ */
+void bench_timer_isr_periodic_ack(void)
+{
+	if (periodic_load != 0) {
+		SysTick->LOAD = periodic_load;
+	}
+}
+
 /**
  * @brief Restore both the old timer ISR handler and its tick rate
  */
@@ -67,6 +111,8 @@ void bench_timer_isr_restore(bench_isr_handler_t handler)
 {
 	uint32_t  cycles;
 
+	periodic_load = 0;
+
 	cycles = bench_timer_cycles_per_tick() - 1;
 	SysTick->LOAD = cycles;
 	SysTick->VAL = 0;             /* resets timer to cycles */
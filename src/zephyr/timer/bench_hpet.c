@@ -66,22 +66,36 @@ bench_time_t bench_timer_cycles_get(void)
 	return ((uint64_t)high << 32) | low;
 }
 
-static inline uint64_t hpet_timer_comparator_set(uint32_t cycles)
-{
-	uint64_t  value = bench_timer_cycles_get();
-
-	value += cycles;
+/* Period and next expiry of the periodic mode (0 if not active) */
+static uint64_t periodic_cycles;
+static uint64_t periodic_next;
 
+static inline void hpet_timer_comparator_write(uint64_t value)
+{
 #if CONFIG_X86_64
         sys_write64(value, TIMER0_COMPARATOR_LOW_REG);
 #else
         sys_write32((uint32_t)value, TIMER0_COMPARATOR_LOW_REG);
         sys_write32((uint32_t)(value >> 32), TIMER0_COMPARATOR_HIGH_REG);
 #endif
+}
+
+static inline uint64_t hpet_timer_comparator_set(uint32_t cycles)
+{
+	uint64_t  value = bench_timer_cycles_get();
+
+	value += cycles;
+
+	hpet_timer_comparator_write(value);
 
 	return value;
 }
 
+static inline uint32_t hpet_cycles_per_second(void)
+{
+	return (uint32_t)(HPET_COUNTER_CLK_PERIOD / sys_read32(CLK_PERIOD_REG));
+}
+
 /**
  * @brief Sets the timer ISR to trigger in @a usec microseconds
  *
@@ -91,8 +105,7 @@ bench_time_t bench_timer_isr_expiry_set(uint32_t usec)
 {
 	uint32_t cyc_per_sec;
 	uint32_t cyc_per_tick;
-	cyc_per_sec = (uint32_t)
-		      (HPET_COUNTER_CLK_PERIOD / sys_read32(CLK_PERIOD_REG));
+	cyc_per_sec = hpet_cycles_per_second();
 	cyc_per_tick = (uint32_t)(((uint64_t)cyc_per_sec * usec) / 1000000U);
 
 	if (cyc_per_tick <= HPET_CMP_MIN_DELAY) {
@@ -102,10 +115,55 @@ bench_time_t bench_timer_isr_expiry_set(uint32_t usec)
 	return hpet_timer_comparator_set(cyc_per_tick);
 }
 
+/**
+ * @brief Sets the timer ISR to trigger every @a usec microseconds
+ *
+ * Timer 0 is left in one-shot mode, as the system timer driver expects,
+ * and bench_timer_isr_periodic_ack() advances its comparator by one period
+ * from the ISR.
+ */
+int bench_timer_isr_periodic_set(uint32_t usec)
+{
+	periodic_cycles = ((uint64_t)hpet_cycles_per_second() * usec) /
+			  1000000U;
+
+	if (periodic_cycles <= HPET_CMP_MIN_DELAY) {
+		periodic_cycles = 0;
+		return BENCH_ERROR;
+	}
+
+	periodic_next = hpet_timer_comparator_set((uint32_t)periodic_cycles);
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Program the comparator for the next period
+ *
+ * The comparator only fires when the main counter reaches it, so an
+ * expiry that is already passed (or too close to program reliably) is
+ * skipped.
+ */
+void bench_timer_isr_periodic_ack(void)
+{
+	uint64_t now = bench_timer_cycles_get();
+
+	if (periodic_cycles == 0) {
+		return;
+	}
+
+	do {
+		periodic_next += periodic_cycles;
+	} while ((int64_t)(periodic_next - now) <= HPET_CMP_MIN_DELAY);
+
+	hpet_timer_comparator_write(periodic_next);
+}
+
 /**
  * @brief Restore both the old timer ISR handler and its tick rate
  */
 void bench_timer_isr_restore(bench_isr_handler_t handler)
 {
+	periodic_cycles = 0;
 	bench_timer_isr_set(handler);
 }
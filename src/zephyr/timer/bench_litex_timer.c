@@ -98,11 +98,55 @@ bench_time_t bench_timer_isr_expiry_set(uint32_t usec)
 	return cycles_next;
 }
 
+/* Reload value of the periodic mode (0 if not active) */
+static uint32_t periodic_reload;
+
+/**
+ * @brief Sets the timer ISR to trigger every @a usec microseconds
+ *
+ * The timer reloads from its RELOAD register each time it reaches zero.
+ */
+int bench_timer_isr_periodic_set(uint32_t usec)
+{
+	periodic_reload = k_us_to_cyc_floor32(usec);
+
+	if (periodic_reload == 0) {
+		return BENCH_ERROR;
+	}
+
+	litex_write8(TIMER_DISABLE, TIMER_EN_ADDR);
+
+	litex_write32(periodic_reload, TIMER_RELOAD_ADDR);
+	litex_write32(periodic_reload, TIMER_LOAD_ADDR);
+
+	litex_write8(litex_read8(TIMER_EV_PENDING_ADDR), TIMER_EV_PENDING_ADDR);
+	litex_write8(TIMER_EV, TIMER_EV_ENABLE_ADDR);
+
+	litex_write8(TIMER_ENABLE, TIMER_EN_ADDR);
+
+	return BENCH_SUCCESS;
+}
+
+/**
+ * @brief Restore the reload value of the periodic mode
+ *
+ * A chained system timer ISR may have programmed its own reload value.
+ * RELOAD is only used at the next reload, so the current period is kept.
+ */
+void bench_timer_isr_periodic_ack(void)
+{
+	if (periodic_reload != 0) {
+		litex_write32(periodic_reload, TIMER_RELOAD_ADDR);
+	}
+}
+
 /**
  * @brief Restore both the old timer ISR handler and its tick rate
  */
 void bench_timer_isr_restore(bench_isr_handler_t handler)
 {
+	periodic_reload = 0;
+
 	litex_write8(TIMER_DISABLE, TIMER_EN_ADDR);
 
 	litex_write32(k_ticks_to_cyc_floor32(1), TIMER_RELOAD_ADDR);
@@ -4,4 +4,20 @@
 set(CONF_FILE src/zephyr/prj.${BOARD}.conf)
 set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DZEPHYR")
 
+if (RUNTIME_STATS)
+    list(APPEND OVERLAY_CONFIG src/zephyr/runtime_stats.conf)
+endif()
+
+if (TICK_FILTER OR TICK_REALIGN)
+    list(APPEND OVERLAY_CONFIG src/zephyr/tick_filter.conf)
+endif()
+
+if ("${TEST}" STREQUAL "soft_timer")
+    list(APPEND OVERLAY_CONFIG src/zephyr/soft_timer.conf)
+endif()
+
+if ("${TEST}" STREQUAL "idle_wakeup")
+    list(APPEND OVERLAY_CONFIG src/zephyr/idle_wakeup.conf)
+endif()
+
 find_package(Zephyr 2.7.0 HINTS $ENV{ZEPHYR_BASE})